@@ -11,6 +11,30 @@ template<typename T> T _popRetT (lua_State * L, T (*func)(lua_State *, int))
 	return value;
 }
 
+// @brief Gets an integer argument, validated per the policy
+static inline int CheckInt (lua_State * L, int index)
+{
+#if LUA_CHECKS == LUA_CHECKS_FULL
+	return luaL_checkint(L, index);
+#else
+	LUA_CHECK_ASSERT(lua_isnumber(L, index));
+
+	return int(lua_tointeger(L, index));
+#endif
+}
+
+// @brief Gets a number argument, validated per the policy
+static inline lua_Number CheckNumber (lua_State * L, int index)
+{
+#if LUA_CHECKS == LUA_CHECKS_FULL
+	return luaL_checknumber(L, index);
+#else
+	LUA_CHECK_ASSERT(lua_isnumber(L, index));
+
+	return lua_tonumber(L, index);
+#endif
+}
+
 namespace Lua
 {
 	// @brief Validates and returns a signed char argument
@@ -19,7 +43,7 @@ namespace Lua
 	// @return signed char value
 	sChar sC (lua_State * L, int index)
 	{
-		return sChar(luaL_checkint(L, index));
+		return sChar(CheckInt(L, index));
 	}
 
 	// @brief Validates and returns a signed short argument
@@ -28,7 +52,7 @@ namespace Lua
 	// @return signed short value
 	sShort sS (lua_State * L, int index)
 	{
-		return sShort(luaL_checkint(L, index));
+		return sShort(CheckInt(L, index));
 	}
 
 	// @brief Validates and returns a signed long argument
@@ -37,7 +61,7 @@ namespace Lua
 	// @return signed long value
 	sLong sL (lua_State * L, int index)
 	{
-		return sLong(luaL_checkint(L, index));
+		return sLong(CheckInt(L, index));
 	}
 
 	// @brief Validates and returns a signed int argument
@@ -46,7 +70,7 @@ namespace Lua
 	// @return signed int value
 	sInt sI (lua_State * L, int index)
 	{
-		return sInt(luaL_checkint(L, index));
+		return sInt(CheckInt(L, index));
 	}
 
 	// @brief Validates, pops, and returns a signed char argument at the stack top
@@ -87,7 +111,7 @@ namespace Lua
 	// @return unsigned char value
 	uChar uC (lua_State * L, int index)
 	{
-		return uChar(luaL_checkint(L, index));
+		return uChar(CheckInt(L, index));
 	}
 
 	// @brief Validates and returns an unsigned short argument
@@ -96,7 +120,7 @@ namespace Lua
 	// @return unsigned short value
 	uShort uS (lua_State * L, int index)
 	{
-		return uShort(luaL_checkint(L, index));
+		return uShort(CheckInt(L, index));
 	}
 
 	// @brief Validates and returns an unsigned long argument
@@ -105,7 +129,7 @@ namespace Lua
 	// @return unsigned long value
 	uLong uL (lua_State * L, int index)
 	{
-		return uLong(luaL_checkint(L, index));
+		return uLong(CheckInt(L, index));
 	}
 
 	// @brief Validates and returns a signed int argument
@@ -114,7 +138,7 @@ namespace Lua
 	// @return unsigned int value
 	uInt uI (lua_State * L, int index)
 	{
-		return uInt(luaL_checkint(L, index));
+		return uInt(CheckInt(L, index));
 	}
 
 	// @brief Validates, pops, and returns an unsigned char argument at the stack top
@@ -155,7 +179,7 @@ namespace Lua
 	// @return float value
 	float F (lua_State * L, int index)
 	{
-		return float(luaL_checknumber(L, index));
+		return float(CheckNumber(L, index));
 	}
 
 	// @brief Validates and return a double argument
@@ -164,7 +188,7 @@ namespace Lua
 	// @return double value
 	double D (lua_State * L, int index)
 	{
-		return double(luaL_checknumber(L, index));
+		return double(CheckNumber(L, index));
 	}
 
 	// @brief Validates, pops, and returns a float argument at the stack top
@@ -189,7 +213,11 @@ namespace Lua
 	// @return bool value
 	bool B (lua_State * L, int index)
 	{
+#if LUA_CHECKS == LUA_CHECKS_FULL
 		luaL_checktype(L, index, LUA_TBOOLEAN);
+#else
+		LUA_CHECK_ASSERT(lua_isboolean(L, index));
+#endif
 
 		return lua_toboolean(L, index) != 0;
 	}
@@ -208,7 +236,11 @@ namespace Lua
 	// @return void * value
 	void * UD (lua_State * L, int index)
 	{
+#if LUA_CHECKS == LUA_CHECKS_FULL
 		if (!lua_isuserdata(L, index)) luaL_error(L, "Argument %d is not a userdata", index);
+#else
+		LUA_CHECK_ASSERT(lua_isuserdata(L, index));
+#endif
 
 		return lua_touserdata(L, index);
 	}
@@ -219,6 +251,12 @@ namespace Lua
 	// @return char const * value
 	char const * S (lua_State * L, int index)
 	{
+#if LUA_CHECKS == LUA_CHECKS_FULL
 		return luaL_checkstring(L, index);
+#else
+		LUA_CHECK_ASSERT(lua_isstring(L, index));
+
+		return lua_tostring(L, index);
+#endif
 	}
 }
\ No newline at end of file
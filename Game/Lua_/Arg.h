@@ -3,6 +3,27 @@
 
 #include "AppTypes.h"
 #include "Lua_/Lua.h"
+#include <cassert>
+
+/*%%%%%%%%%%%%%%%% VALIDATION POLICY %%%%%%%%%%%%%%%%*/
+
+// Argument validation, chosen build-wide by defining LUA_CHECKS:
+//	LUA_CHECKS_FULL: bad arguments raise Lua errors (default)
+//	LUA_CHECKS_DEBUG: bad arguments fail asserts, i.e. unchecked under NDEBUG
+//	LUA_CHECKS_NONE: arguments are trusted (e.g. frozen, tested script trees)
+#define LUA_CHECKS_NONE 0
+#define LUA_CHECKS_DEBUG 1
+#define LUA_CHECKS_FULL 2
+
+#ifndef LUA_CHECKS
+	#define LUA_CHECKS LUA_CHECKS_FULL
+#endif
+
+#if LUA_CHECKS == LUA_CHECKS_DEBUG
+	#define LUA_CHECK_ASSERT(cond) assert(cond)
+#else
+	#define LUA_CHECK_ASSERT(cond) ((void)0)
+#endif
 
 namespace Lua
 {
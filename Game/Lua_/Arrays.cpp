@@ -0,0 +1,562 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Arrays.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include <cstdlib>
+
+namespace Lua
+{
+	// @brief Per-type names
+	template<> char const * _arraynameT<float> (void) { return "Float32Array"; }
+	template<> char const * _arraynameT<double> (void) { return "Float64Array"; }
+	template<> char const * _arraynameT<sInt> (void) { return "Int32Array"; }
+}
+
+using namespace Lua;
+
+// @brief Per-type element reads
+template<typename T> T _valueT (lua_State * L, int index)
+{
+	return T(luaL_checknumber(L, index));
+}
+
+template<> sInt _valueT<sInt> (lua_State * L, int index)
+{
+	return sInt(luaL_checkinteger(L, index));
+}
+
+/*%%%%%%%%%%%%%%%% KERNELS %%%%%%%%%%%%%%%%*/
+
+// @brief Scalar kernels, in plain loops the compiler is free to vectorize
+template<typename T> struct Scalar {
+	static void Fill (T * a, uInt n, T value)
+	{
+		for (uInt i = 0; i < n; ++i) a[i] = value;
+	}
+
+	static void Scale (T * a, uInt n, double s)
+	{
+		for (uInt i = 0; i < n; ++i) a[i] = T(a[i] * s);
+	}
+
+	static void Axpy (T * a, T const * x, uInt n, double s)
+	{
+		for (uInt i = 0; i < n; ++i) a[i] = T(a[i] + x[i] * s);
+	}
+
+	static void Lerp (T * a, T const * x, uInt n, double t)
+	{
+		for (uInt i = 0; i < n; ++i) a[i] = T(a[i] + (x[i] - a[i]) * t);
+	}
+
+	static void Clamp (T * a, uInt n, T lo, T hi)
+	{
+		for (uInt i = 0; i < n; ++i) a[i] = a[i] < lo ? lo : (a[i] > hi ? hi : a[i]);
+	}
+
+	static T Min (T const * a, uInt n)
+	{
+		T m = a[0];
+
+		for (uInt i = 1; i < n; ++i) if (a[i] < m) m = a[i];
+
+		return m;
+	}
+
+	static T Max (T const * a, uInt n)
+	{
+		T m = a[0];
+
+		for (uInt i = 1; i < n; ++i) if (a[i] > m) m = a[i];
+
+		return m;
+	}
+
+	static double Sum (T const * a, uInt n)
+	{
+		double sum = 0.0;
+
+		for (uInt i = 0; i < n; ++i) sum += a[i];
+
+		return sum;
+	}
+};
+
+// @brief Kernels used by the bindings
+template<typename T> struct Kernels : Scalar<T> {};
+
+#ifdef ARRAYS_SSE
+	// @brief Single-precision kernels, four lanes at a time; tails fall back to the scalar loops
+	template<> struct Kernels<float> : Scalar<float> {
+		static void Fill (float * a, uInt n, float value)
+		{
+			__m128 v = _mm_set1_ps(value);
+			uInt i = 0;
+
+			for (; i + 4 <= n; i += 4) _mm_store_ps(a + i, v);
+
+			Scalar<float>::Fill(a + i, n - i, value);
+		}
+
+		static void Scale (float * a, uInt n, double s)
+		{
+			__m128 vs = _mm_set1_ps(float(s));
+			uInt i = 0;
+
+			for (; i + 4 <= n; i += 4) _mm_store_ps(a + i, _mm_mul_ps(_mm_load_ps(a + i), vs));
+
+			Scalar<float>::Scale(a + i, n - i, s);
+		}
+
+		static void Axpy (float * a, float const * x, uInt n, double s)
+		{
+			__m128 vs = _mm_set1_ps(float(s));
+			uInt i = 0;
+
+			for (; i + 4 <= n; i += 4) _mm_store_ps(a + i, _mm_add_ps(_mm_load_ps(a + i), _mm_mul_ps(_mm_load_ps(x + i), vs)));
+
+			Scalar<float>::Axpy(a + i, x + i, n - i, s);
+		}
+
+		static void Lerp (float * a, float const * x, uInt n, double t)
+		{
+			__m128 vt = _mm_set1_ps(float(t));
+			uInt i = 0;
+
+			for (; i + 4 <= n; i += 4)
+			{
+				__m128 va = _mm_load_ps(a + i);
+
+				_mm_store_ps(a + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(x + i), va), vt)));
+			}
+
+			Scalar<float>::Lerp(a + i, x + i, n - i, t);
+		}
+
+		static void Clamp (float * a, uInt n, float lo, float hi)
+		{
+			__m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+			uInt i = 0;
+
+			for (; i + 4 <= n; i += 4) _mm_store_ps(a + i, _mm_min_ps(_mm_max_ps(_mm_load_ps(a + i), vlo), vhi));
+
+			Scalar<float>::Clamp(a + i, n - i, lo, hi);
+		}
+
+		static float Min (float const * a, uInt n)
+		{
+			if (n < 8) return Scalar<float>::Min(a, n);
+
+			__m128 vm = _mm_load_ps(a);
+			uInt i = 4;
+
+			for (; i + 4 <= n; i += 4) vm = _mm_min_ps(vm, _mm_load_ps(a + i));
+
+			// Reduce the lanes, then fold in the tail.
+			float lanes[4];
+
+			_mm_storeu_ps(lanes, vm);
+
+			float m = Scalar<float>::Min(lanes, 4);
+
+			for (; i < n; ++i) if (a[i] < m) m = a[i];
+
+			return m;
+		}
+
+		static float Max (float const * a, uInt n)
+		{
+			if (n < 8) return Scalar<float>::Max(a, n);
+
+			__m128 vm = _mm_load_ps(a);
+			uInt i = 4;
+
+			for (; i + 4 <= n; i += 4) vm = _mm_max_ps(vm, _mm_load_ps(a + i));
+
+			// Reduce the lanes, then fold in the tail.
+			float lanes[4];
+
+			_mm_storeu_ps(lanes, vm);
+
+			float m = Scalar<float>::Max(lanes, 4);
+
+			for (; i < n; ++i) if (a[i] > m) m = a[i];
+
+			return m;
+		}
+	};
+#endif
+
+/*%%%%%%%%%%%%%%%% BINDINGS %%%%%%%%%%%%%%%%*/
+
+// @brief Gets an element slot, given a 1-based index
+// @param index Stack index of element index
+// @return Element
+template<typename T> T & _elementT (lua_State * L, Array<T> * A, int index)
+{
+	uInt slot = uI(L, index) - 1;
+
+	if (slot >= A->mCount) luaL_error(L, "Index %d out of range (count = %d)", slot + 1, A->mCount);
+
+	return A->mData[slot];
+}
+
+// @brief Allocates array storage
+// @param L Lua state
+// @param A Array
+// @param count Element count
+template<typename T> void _allocT (lua_State * L, Array<T> * A, uInt count)
+{
+	// Over-allocate, then align the elements for the vector kernels.
+	if (count > (~size_t(0) - 16) / sizeof(T)) luaL_error(L, "%s: out of memory", _arraynameT<T>());
+
+	A->mBlock = std::malloc(count * sizeof(T) + 16);
+
+	if (0 == A->mBlock) luaL_error(L, "%s: out of memory", _arraynameT<T>());
+
+	A->mData = (T *)(((size_t)A->mBlock + 15) & ~size_t(15));
+	A->mCount = count;
+}
+
+// @brief Constructs an array
+// @note count_or_table: Element count (elements are zeroed), or table of elements to load
+template<typename T> int _consT (lua_State * L)
+{
+	Array<T> * A = (Array<T> *)UD(L, 1);
+
+	A->mBlock = 0;
+	A->mCount = 0;
+
+	if (lua_istable(L, 2))
+	{
+		uInt count = uInt(lua_objlen(L, 2));
+
+		_allocT(L, A, count);
+
+		for (uInt i = 0; i < count; ++i)
+		{
+			lua_rawgeti(L, 2, i + 1);	// A, t, t[i + 1]
+
+			A->mData[i] = _valueT<T>(L, 3);
+
+			lua_pop(L, 1);	// A, t
+		}
+	}
+
+	else
+	{
+		_allocT(L, A, uI(L, 2));
+
+		Scalar<T>::Fill(A->mData, A->mCount, T(0));
+	}
+
+	return 0;
+}
+
+// @brief Frees array storage
+template<typename T> int _gcT (lua_State * L)
+{
+	std::free(((Array<T> *)UD(L, 1))->mBlock);
+
+	return 0;
+}
+
+// @brief Indexes an element; non-numeric keys fall through to the members
+template<typename T> int _indexT (lua_State * L)
+{
+	if (lua_type(L, 2) != LUA_TNUMBER) return 0;
+
+	Array<T> * A = (Array<T> *)UD(L, 1);
+	lua_Integer slot = lua_tointeger(L, 2) - 1;
+
+	if (slot >= 0 && lua_Integer(A->mCount) > slot) lua_pushnumber(L, A->mData[slot]);	// A, i, A[i]
+
+	else lua_pushnil(L);// A, i, nil
+
+	return 1;
+}
+
+// @brief Assigns an element
+template<typename T> int _newindexT (lua_State * L)
+{
+	if (lua_type(L, 2) != LUA_TNUMBER) luaL_error(L, "%s only accepts numeric keys", _arraynameT<T>());
+
+	_elementT(L, (Array<T> *)UD(L, 1), 2) = _valueT<T>(L, 3);
+
+	return 0;
+}
+
+// @brief Gets the element count
+template<typename T> int _lenT (lua_State * L)
+{
+	lua_pushinteger(L, _arrayT<T>(L, 1)->mCount);	// A, count
+
+	return 1;
+}
+
+// @brief Gets an element
+// @note index: 1-based element index
+template<typename T> int _getT (lua_State * L)
+{
+	lua_pushnumber(L, _elementT(L, _arrayT<T>(L, 1), 2));	// A, index, A[index]
+
+	return 1;
+}
+
+// @brief Sets an element
+// @note index: 1-based element index
+// @note value: Value to assign
+template<typename T> int _setT (lua_State * L)
+{
+	_elementT(L, _arrayT<T>(L, 1), 2) = _valueT<T>(L, 3);
+
+	return 0;
+}
+
+// @brief Copies the elements into a table
+// @note t: Optional table to fill; if absent, a new one is created
+// @return Table
+template<typename T> int _totableT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+
+	if (!lua_istable(L, 2))
+	{
+		lua_settop(L, 1);	// A
+		lua_createtable(L, int(A->mCount), 0);	// A, t
+	}
+
+	for (uInt i = 0; i < A->mCount; ++i)
+	{
+		lua_pushnumber(L, A->mData[i]);	// A, t, A[i + 1]
+		lua_rawseti(L, 2, i + 1);	// A, t = { ..., A[i + 1] }
+	}
+
+	lua_settop(L, 2);
+
+	return 1;
+}
+
+// @brief Loads elements from a table, up to the array count
+// @note t: Table of elements
+template<typename T> int _fromtableT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	uInt count = uInt(lua_objlen(L, 2));
+
+	if (count > A->mCount) count = A->mCount;
+
+	for (uInt i = 0; i < count; ++i)
+	{
+		lua_rawgeti(L, 2, i + 1);	// A, t, t[i + 1]
+
+		A->mData[i] = _valueT<T>(L, 3);
+
+		lua_pop(L, 1);	// A, t
+	}
+
+	return 0;
+}
+
+// @brief Fills the array with a value
+// @note value: Value to assign
+template<typename T> int _fillT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+
+	Kernels<T>::Fill(A->mData, A->mCount, _valueT<T>(L, 2));
+
+	return 0;
+}
+
+// @brief Scales the array: A[i] = A[i] * s
+// @note s: Scale factor
+template<typename T> int _scaleT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+
+	Kernels<T>::Scale(A->mData, A->mCount, luaL_checknumber(L, 2));
+
+	return 0;
+}
+
+// @brief Gets the source array of a binary operation, validating its count
+// @return Source array
+template<typename T> Array<T> * _sourceT (lua_State * L, Array<T> * A, int index)
+{
+	Array<T> * X = _arrayT<T>(L, index);
+
+	if (X->mCount != A->mCount) luaL_error(L, "Count mismatch: %d vs. %d", A->mCount, X->mCount);
+
+	return X;
+}
+
+// @brief Accumulates a scaled array: A[i] = A[i] + a * X[i]
+// @note a: Scale factor
+// @note X: Array of same type and count
+template<typename T> int _axpyT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+
+	Kernels<T>::Axpy(A->mData, _sourceT(L, A, 3)->mData, A->mCount, luaL_checknumber(L, 2));
+
+	return 0;
+}
+
+// @brief Interpolates toward an array: A[i] = A[i] + (X[i] - A[i]) * t
+// @note X: Array of same type and count
+// @note t: Interpolation time
+template<typename T> int _lerpT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+
+	Kernels<T>::Lerp(A->mData, _sourceT(L, A, 2)->mData, A->mCount, luaL_checknumber(L, 3));
+
+	return 0;
+}
+
+// @brief Clamps the elements to a range
+// @note lo: Lower bound
+// @note hi: Upper bound
+template<typename T> int _clampT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+	T lo = _valueT<T>(L, 2), hi = _valueT<T>(L, 3);
+
+	if (hi < lo) luaL_error(L, "Invalid range");
+
+	Kernels<T>::Clamp(A->mData, A->mCount, lo, hi);
+
+	return 0;
+}
+
+// @brief Gets a non-empty array
+template<typename T> Array<T> * _nonemptyT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+
+	if (0 == A->mCount) luaL_error(L, "Empty %s", _arraynameT<T>());
+
+	return A;
+}
+
+// @brief Gets the least element
+template<typename T> int _minT (lua_State * L)
+{
+	Array<T> * A = _nonemptyT<T>(L);
+
+	lua_pushnumber(L, Kernels<T>::Min(A->mData, A->mCount));// A, min
+
+	return 1;
+}
+
+// @brief Gets the greatest element
+template<typename T> int _maxT (lua_State * L)
+{
+	Array<T> * A = _nonemptyT<T>(L);
+
+	lua_pushnumber(L, Kernels<T>::Max(A->mData, A->mCount));// A, max
+
+	return 1;
+}
+
+// @brief Sums the elements (accumulated in double precision)
+template<typename T> int _sumT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+
+	lua_pushnumber(L, Kernels<T>::Sum(A->mData, A->mCount));	// A, sum
+
+	return 1;
+}
+
+// @brief Validates an index array against a target count
+// @return Index array
+template<typename T> Array<sInt> * _indicesT (lua_State * L, int index, Array<T> * target)
+{
+	Array<sInt> * I = _arrayT<sInt>(L, index);
+
+	for (uInt i = 0; i < I->mCount; ++i)
+	{
+		if (uInt(I->mData[i] - 1) >= target->mCount) luaL_error(L, "Index %d out of range (count = %d)", I->mData[i], target->mCount);
+	}
+
+	return I;
+}
+
+// @brief Gathers indexed elements: A[i] = X[I[i]]
+// @note X: Source array of same type
+// @note I: Int32Array of 1-based indices into X; only the first #I elements of A are assigned
+template<typename T> int _gatherT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+	Array<T> * X = _arrayT<T>(L, 2);
+	Array<sInt> * I = _indicesT(L, 3, X);
+
+	if (I->mCount > A->mCount) luaL_error(L, "Too many indices");
+
+	for (uInt i = 0; i < I->mCount; ++i) A->mData[i] = X->mData[I->mData[i] - 1];
+
+	return 0;
+}
+
+// @brief Scatters elements to indexed slots: X[I[i]] = A[i]
+// @note X: Target array of same type
+// @note I: Int32Array of 1-based indices into X; only the first #I elements of A are read
+template<typename T> int _scatterT (lua_State * L)
+{
+	Array<T> * A = _arrayT<T>(L, 1);
+	Array<T> * X = _arrayT<T>(L, 2);
+	Array<sInt> * I = _indicesT(L, 3, X);
+
+	if (I->mCount > A->mCount) luaL_error(L, "Too many indices");
+
+	for (uInt i = 0; i < I->mCount; ++i) X->mData[I->mData[i] - 1] = A->mData[i];
+
+	return 0;
+}
+
+// @brief Defines a typed array class
+template<typename T> void _defineT (lua_State * L)
+{
+	luaL_reg methods[] = {
+		{ "Axpy", _axpyT<T> },
+		{ "Clamp", _clampT<T> },
+		{ "Fill", _fillT<T> },
+		{ "FromTable", _fromtableT<T> },
+		{ "Gather", _gatherT<T> },
+		{ "Get", _getT<T> },
+		{ "Lerp", _lerpT<T> },
+		{ "Max", _maxT<T> },
+		{ "Min", _minT<T> },
+		{ "Scale", _scaleT<T> },
+		{ "Scatter", _scatterT<T> },
+		{ "Set", _setT<T> },
+		{ "Sum", _sumT<T> },
+		{ "ToTable", _totableT<T> },
+		{ "__gc", _gcT<T> },
+		{ "__index", _indexT<T> },
+		{ "__len", _lenT<T> },
+		{ "__newindex", _newindexT<T> },
+		{ 0, 0 }
+	};
+
+	Class::Define(L, _arraynameT<T>(), methods, _consT<T>, Class::Def(sizeof(Array<T>), 0, true));
+}
+
+// @brief Defines the typed numeric array classes
+// @param L Lua state
+// @return 0
+// @note Must be called once the class module is loaded
+int Bindings::open_arrays (lua_State * L)
+{
+	_defineT<float>(L);
+	_defineT<double>(L);
+	_defineT<sInt>(L);
+
+	return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef LUA_ARRAYS_H
+#define LUA_ARRAYS_H
+
+#include "AppTypes.h"
+#include "Lua_/Arg.h"
+#include "Lua_/LibEx.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+	#include <xmmintrin.h>
+
+	#define ARRAYS_SSE
+#endif
+
+namespace Lua
+{
+	// @brief Typed numeric array instance data (q.v. Bindings::open_arrays)
+	template<typename T> struct Array {
+		T * mData;	// Elements, 16-byte aligned
+		void * mBlock;	// Allocated block
+		uInt mCount;// Element count
+	};
+
+	// @brief Per-type array class names
+	template<typename T> char const * _arraynameT (void);
+
+	template<> char const * _arraynameT<float> (void);
+	template<> char const * _arraynameT<double> (void);
+	template<> char const * _arraynameT<sInt> (void);
+
+	// @brief Validates and gets a typed array argument
+	// @param index Argument stack index
+	// @return Array data
+	template<typename T> Array<T> * _arrayT (lua_State * L, int index)
+	{
+#if LUA_CHECKS == LUA_CHECKS_FULL
+		if (!Class::IsType(L, index, _arraynameT<T>())) luaL_error(L, "Arg #%d: non-%s", index, _arraynameT<T>());
+#else
+		LUA_CHECK_ASSERT(Class::IsType(L, index, _arraynameT<T>()));
+#endif
+
+		return (Array<T> *)UD(L, index);
+	}
+}
+
+#endif // LUA_ARRAYS_H
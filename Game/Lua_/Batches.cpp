@@ -0,0 +1,1009 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Arrays.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include "Lua_/Types.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Lua;
+
+/*%%%%%%%%%%%%%%%% LANES %%%%%%%%%%%%%%%%*/
+
+// Four-wide float lanes: kernels are written once against these, as SSE or as plain loops
+#ifdef ARRAYS_SSE
+	struct F4 {
+		__m128 m;
+
+		F4 (__m128 v) : m(v) {}
+		F4 (float s) : m(_mm_set1_ps(s)) {}
+	};
+
+	inline F4 Load (float const * p) { return _mm_load_ps(p); }
+	inline void Store (float * p, F4 v) { _mm_store_ps(p, v.m); }
+	inline F4 operator + (F4 a, F4 b) { return _mm_add_ps(a.m, b.m); }
+	inline F4 operator - (F4 a, F4 b) { return _mm_sub_ps(a.m, b.m); }
+	inline F4 operator * (F4 a, F4 b) { return _mm_mul_ps(a.m, b.m); }
+	inline F4 Sqrt (F4 a) { return _mm_sqrt_ps(a.m); }
+
+	// @brief 1 / a where a > 0, else 0
+	inline F4 SafeInverse (F4 a)
+	{
+		return _mm_and_ps(_mm_cmpgt_ps(a.m, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(1.0f), a.m));
+	}
+
+	// @brief Bit i set if a[i] > b[i]
+	inline int GreaterMask (F4 a, F4 b) { return _mm_movemask_ps(_mm_cmpgt_ps(a.m, b.m)); }
+#else
+	struct F4 {
+		float m[4];
+
+		F4 (void) {}
+		F4 (float s) { m[0] = m[1] = m[2] = m[3] = s; }
+	};
+
+	inline F4 Load (float const * p) { F4 v; std::memcpy(v.m, p, sizeof(v.m)); return v; }
+	inline void Store (float * p, F4 v) { std::memcpy(p, v.m, sizeof(v.m)); }
+
+	#define F4_OP(op)	inline F4 operator op (F4 a, F4 b) { for (int i = 0; i < 4; ++i) a.m[i] = a.m[i] op b.m[i]; return a; }
+
+	F4_OP(+)
+	F4_OP(-)
+	F4_OP(*)
+
+	#undef F4_OP
+
+	inline F4 Sqrt (F4 a) { for (int i = 0; i < 4; ++i) a.m[i] = std::sqrt(a.m[i]); return a; }
+
+	// @brief 1 / a where a > 0, else 0
+	inline F4 SafeInverse (F4 a)
+	{
+		for (int i = 0; i < 4; ++i) a.m[i] = a.m[i] > 0.0f ? 1.0f / a.m[i] : 0.0f;
+
+		return a;
+	}
+
+	// @brief Bit i set if a[i] > b[i]
+	inline int GreaterMask (F4 a, F4 b)
+	{
+		int mask = 0;
+
+		for (int i = 0; i < 4; ++i) mask |= a.m[i] > b.m[i] ? 1 << i : 0;
+
+		return mask;
+	}
+#endif
+
+// @brief Stores the first n (<= 4) lanes, e.g. for the tail of an unpadded array
+inline void StoreN (float * p, F4 v, uInt n)
+{
+	float lanes[4];
+
+	Store(lanes, v);
+
+	for (uInt i = 0; i < n; ++i) p[i] = lanes[i];
+}
+
+/*%%%%%%%%%%%%%%%% BATCHES %%%%%%%%%%%%%%%%*/
+
+// @brief Batch of structures, stored as one lane per component
+// @note Lane capacity is padded to a multiple of 4, so kernels run whole blocks; results written
+// into the padding past the count are discarded, and Resize puts defaults back before reusing it.
+// Slots past the last whole block are never touched by kernels, so they keep their defaults
+struct Batch {
+	float * mLanes[4];	// Component lanes, each 16-byte aligned
+	void * mBlock;	// Allocated block
+	uInt mCount;// Element count
+	uInt mCapacity;	// Lane capacity
+	uInt mWidth;// Components per element
+	float mDefaults[4];	// Per-component values of new elements
+};
+
+// @brief Class names
+static char const * _Vec3DBatch = "Vec3DBatch";
+static char const * _QuaternionBatch = "QuaternionBatch";
+static char const * _BoxBatch = "BoxBatch";
+static char const * _ComplexBatch = "ComplexBatch";
+
+// @brief Validates and gets a batch argument
+// @param index Argument stack index
+// @param name Batch class name
+// @return Batch data
+static Batch * GetBatch (lua_State * L, int index, char const * name)
+{
+#if LUA_CHECKS == LUA_CHECKS_FULL
+	if (!Class::IsType(L, index, name)) luaL_error(L, "Arg #%d: non-%s", index, name);
+#else
+	LUA_CHECK_ASSERT(Class::IsType(L, index, name));
+#endif
+
+	return (Batch *)UD(L, index);
+}
+
+// @brief Gets a batch argument whose count matches another batch
+static Batch * GetMatchingBatch (lua_State * L, int index, char const * name, Batch * B)
+{
+	Batch * other = GetBatch(L, index, name);
+
+	if (other->mCount != B->mCount) luaL_error(L, "Count mismatch: %d vs. %d", B->mCount, other->mCount);
+
+	return other;
+}
+
+// @brief Gets the number of whole 4-element blocks covering a batch
+static uInt Blocks (Batch * B)
+{
+	return (B->mCount + 3) / 4;
+}
+
+// @brief Resizes a batch, keeping its current elements
+// @param L Lua state
+// @param B Batch
+// @param count New element count; new elements take the default values
+// @note If storage cannot be allocated, the batch is left as it was and an error is raised
+static void Resize (lua_State * L, Batch * B, uInt count)
+{
+	// Only the dropped or new elements, and the old padding that kernels may have written, need resetting.
+	uInt first = count < B->mCount ? count : B->mCount, last = Blocks(B) * 4;
+
+	if (count > B->mCapacity)
+	{
+		// Grow by doubling, keeping the capacity a multiple of 4 within a uInt, and the byte size within a size_t.
+		size_t limit = size_t(~0U) & ~size_t(3), capacity = B->mCapacity;
+
+		capacity = capacity < limit / 2 ? capacity * 2 : limit;
+
+		if (capacity < count) capacity = (size_t(count) + 3) & ~size_t(3);
+
+		void * block = 0;
+
+		if (count <= limit && capacity <= (~size_t(0) - 16) / (B->mWidth * sizeof(float))) block = std::malloc(B->mWidth * capacity * sizeof(float) + 16);
+
+		if (0 == block) luaL_error(L, "Batch resize to %f elements: out of memory", lua_Number(count));
+
+		float * base = (float *)(((size_t)block + 15) & ~size_t(15));
+
+		for (uInt i = 0; i < B->mWidth; ++i)
+		{
+			if (B->mCount > 0) std::memcpy(base + i * capacity, B->mLanes[i], B->mCount * sizeof(float));
+
+			B->mLanes[i] = base + i * capacity;
+		}
+
+		std::free(B->mBlock);
+
+		B->mBlock = block;
+		B->mCapacity = uInt(capacity);
+
+		// Nothing past the copied elements has been initialized.
+		last = B->mCapacity;
+	}
+
+	for (uInt i = 0; i < B->mWidth; ++i)
+	{
+		for (uInt j = first; j < last; ++j) B->mLanes[i][j] = B->mDefaults[i];
+	}
+
+	B->mCount = count;
+}
+
+// @brief Gets an element slot, given a 1-based index
+// @param index Stack index of element index
+// @return Slot
+static uInt GetSlot (lua_State * L, Batch * B, int index)
+{
+	uInt slot = uI(L, index) - 1;
+
+	if (slot >= B->mCount) luaL_error(L, "Index %d out of range (count = %d)", slot + 1, B->mCount);
+
+	return slot;
+}
+
+// @brief Initializes a batch
+// @note count: Optional element count (default 0)
+static void Init (lua_State * L, uInt width, float const * defaults)
+{
+	Batch * B = (Batch *)UD(L, 1);
+
+	B->mBlock = 0;
+	B->mCount = B->mCapacity = 0;
+	B->mWidth = width;
+
+	for (uInt i = 0; i < width; ++i) B->mDefaults[i] = defaults[i];
+
+	Resize(L, B, !lua_isnoneornil(L, 2) ? uI(L, 2) : 0);
+}
+
+// @brief Frees batch storage
+static int GC (lua_State * L)
+{
+	std::free(((Batch *)UD(L, 1))->mBlock);
+
+	return 0;
+}
+
+// @brief Gets the element count
+static int Len (lua_State * L)
+{
+	lua_pushinteger(L, ((Batch *)UD(L, 1))->mCount);	// B, count
+
+	return 1;
+}
+
+// @brief Resizes the batch, keeping current elements
+// @note count: New element count
+static int ResizeBatch (lua_State * L)
+{
+	Resize(L, (Batch *)UD(L, 1), uI(L, 2));
+
+	return 0;
+}
+
+// @brief Sets an element from components, or from an object
+// @param slot Element slot
+// @param index Stack index of first component, or of object
+// @param object Object components, if object was passed
+static void SetElement (lua_State * L, Batch * B, uInt slot, int index, float const * object)
+{
+	for (uInt i = 0; i < B->mWidth; ++i) B->mLanes[i][slot] = object != 0 ? object[i] : F(L, index + i);
+}
+
+/*%%%%%%%%%%%%%%%% Vec3DBatch %%%%%%%%%%%%%%%%*/
+
+// @brief Reads a vector argument, given as a Vec3D or as components
+// @param index Stack index of Vec3D or x-component
+// @param v [out] Components
+static void ReadVec (lua_State * L, int index, float v[3])
+{
+	if (lua_isnumber(L, index))
+	{
+		for (int i = 0; i < 3; ++i) v[i] = F(L, index + i);
+	}
+
+	else
+	{
+		Types::Vec3D & vec = Types::Vec3D_r(L, index);
+
+		v[0] = vec.x;
+		v[1] = vec.y;
+		v[2] = vec.z;
+	}
+}
+
+// @brief Reads a quaternion argument, given as a Quaternion or as components
+// @param index Stack index of Quaternion or x-component
+// @param q [out] Components, as x, y, z, w
+static void ReadQuat (lua_State * L, int index, float q[4])
+{
+	if (lua_isnumber(L, index))
+	{
+		for (int i = 0; i < 4; ++i) q[i] = F(L, index + i);
+	}
+
+	else
+	{
+		Types::Quaternion & quat = Types::Quaternion_r(L, index);
+
+		q[0] = quat.x;
+		q[1] = quat.y;
+		q[2] = quat.z;
+		q[3] = quat.w;
+	}
+}
+
+// @brief Constructs a vector batch
+static int Vec3DBatchCons (lua_State * L)
+{
+	float const defaults[] = { 0.0f, 0.0f, 0.0f };
+
+	Init(L, 3, defaults);
+
+	return 0;
+}
+
+// @brief Gets a vector
+// @note index: 1-based element index
+// @note vec: Optional Vec3D to fill
+// @return If vec was passed, vec; otherwise, the x, y, z components
+static int Vec3DGet (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _Vec3DBatch);
+	uInt slot = GetSlot(L, B, 2);
+
+	if (!lua_isnoneornil(L, 3))
+	{
+		Types::Vec3D & vec = Types::Vec3D_r(L, 3);
+
+		vec.x = B->mLanes[0][slot];
+		vec.y = B->mLanes[1][slot];
+		vec.z = B->mLanes[2][slot];
+
+		lua_settop(L, 3);
+
+		return 1;
+	}
+
+	for (int i = 0; i < 3; ++i) lua_pushnumber(L, B->mLanes[i][slot]);	// B, index, x, y, z
+
+	return 3;
+}
+
+// @brief Sets a vector
+// @note index: 1-based element index
+// @note vec: Vec3D, or x, y, z components
+static int Vec3DSet (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _Vec3DBatch);
+	float v[3];
+
+	ReadVec(L, 3, v);
+	SetElement(L, B, GetSlot(L, B, 2), 3, v);
+
+	return 0;
+}
+
+// @brief Appends a vector
+// @note vec: Vec3D, or x, y, z components
+// @return New element count
+static int Vec3DPush (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _Vec3DBatch);
+	float v[3];
+
+	ReadVec(L, 2, v);
+	Resize(L, B, B->mCount + 1);
+	SetElement(L, B, B->mCount - 1, 2, v);
+
+	lua_pushinteger(L, B->mCount);	// B, vec, count
+
+	return 1;
+}
+
+// @brief Adds vectors: V[i] = V[i] + W[i], or V[i] = V[i] + w
+// @note W / w: Vec3DBatch of same count; or single Vec3D, or x, y, z components
+static int Vec3DAdd (lua_State * L)
+{
+	Batch * V = GetBatch(L, 1, _Vec3DBatch);
+
+	if (Class::IsType(L, 2, _Vec3DBatch))
+	{
+		Batch * W = GetMatchingBatch(L, 2, _Vec3DBatch, V);
+
+		for (uInt i = 0; i < V->mWidth; ++i)
+		{
+			for (uInt j = 0, n = Blocks(V) * 4; j < n; j += 4) Store(V->mLanes[i] + j, Load(V->mLanes[i] + j) + Load(W->mLanes[i] + j));
+		}
+	}
+
+	else
+	{
+		float w[3];
+
+		ReadVec(L, 2, w);
+
+		for (uInt i = 0; i < V->mWidth; ++i)
+		{
+			F4 c(w[i]);
+
+			for (uInt j = 0, n = Blocks(V) * 4; j < n; j += 4) Store(V->mLanes[i] + j, Load(V->mLanes[i] + j) + c);
+		}
+	}
+
+	return 0;
+}
+
+// @brief Transforms each vector by a matrix, given as its three rows: V[i] = (r1 . V[i], r2 . V[i], r3 . V[i])
+// @note r1, r2, r3: Row vectors, as Vec3D
+static int Vec3DTransform (lua_State * L)
+{
+	Batch * V = GetBatch(L, 1, _Vec3DBatch);
+	float r[3][3];
+
+	for (int i = 0; i < 3; ++i) ReadVec(L, i + 2, r[i]);
+
+	F4 m00(r[0][0]), m01(r[0][1]), m02(r[0][2]);
+	F4 m10(r[1][0]), m11(r[1][1]), m12(r[1][2]);
+	F4 m20(r[2][0]), m21(r[2][1]), m22(r[2][2]);
+
+	float * px = V->mLanes[0], * py = V->mLanes[1], * pz = V->mLanes[2];
+
+	for (uInt j = 0, n = Blocks(V) * 4; j < n; j += 4)
+	{
+		F4 x = Load(px + j), y = Load(py + j), z = Load(pz + j);
+
+		Store(px + j, m00 * x + m01 * y + m02 * z);
+		Store(py + j, m10 * x + m11 * y + m12 * z);
+		Store(pz + j, m20 * x + m21 * y + m22 * z);
+	}
+
+	return 0;
+}
+
+// @brief Normalizes each vector; zero vectors are left as is
+static int Vec3DNormalize (lua_State * L)
+{
+	Batch * V = GetBatch(L, 1, _Vec3DBatch);
+	float * px = V->mLanes[0], * py = V->mLanes[1], * pz = V->mLanes[2];
+
+	for (uInt j = 0, n = Blocks(V) * 4; j < n; j += 4)
+	{
+		F4 x = Load(px + j), y = Load(py + j), z = Load(pz + j);
+		F4 inv = SafeInverse(Sqrt(x * x + y * y + z * z));
+
+		Store(px + j, x * inv);
+		Store(py + j, y * inv);
+		Store(pz + j, z * inv);
+	}
+
+	return 0;
+}
+
+// @brief Computes dot products: out[i] = V[i] . W[i], or out[i] = V[i] . w
+// @note W / w: Vec3DBatch of same count; or single Vec3D, or x, y, z components
+// @note out: Float32Array, of at least the batch's count (last argument)
+static int Vec3DDot (lua_State * L)
+{
+	Batch * V = GetBatch(L, 1, _Vec3DBatch);
+	Array<float> * out = _arrayT<float>(L, lua_gettop(L));
+
+	if (out->mCount < V->mCount) luaL_error(L, "Output too small");
+
+	float * px = V->mLanes[0], * py = V->mLanes[1], * pz = V->mLanes[2];
+
+	if (Class::IsType(L, 2, _Vec3DBatch))
+	{
+		Batch * W = GetMatchingBatch(L, 2, _Vec3DBatch, V);
+		float * qx = W->mLanes[0], * qy = W->mLanes[1], * qz = W->mLanes[2];
+
+		for (uInt j = 0; j < V->mCount; j += 4)
+		{
+			F4 dot = Load(px + j) * Load(qx + j) + Load(py + j) * Load(qy + j) + Load(pz + j) * Load(qz + j);
+
+			StoreN(out->mData + j, dot, V->mCount - j < 4 ? V->mCount - j : 4);
+		}
+	}
+
+	else
+	{
+		float w[3];
+
+		ReadVec(L, 2, w);
+
+		F4 wx(w[0]), wy(w[1]), wz(w[2]);
+
+		for (uInt j = 0; j < V->mCount; j += 4)
+		{
+			F4 dot = Load(px + j) * wx + Load(py + j) * wy + Load(pz + j) * wz;
+
+			StoreN(out->mData + j, dot, V->mCount - j < 4 ? V->mCount - j : 4);
+		}
+	}
+
+	return 0;
+}
+
+// @brief Computes cross products: V[i] = A[i] x B[i]
+// @note A, B: Vec3DBatch of same count (either may be the target itself)
+static int Vec3DCross (lua_State * L)
+{
+	Batch * V = GetBatch(L, 1, _Vec3DBatch);
+	Batch * A = GetMatchingBatch(L, 2, _Vec3DBatch, V);
+	Batch * B = GetMatchingBatch(L, 3, _Vec3DBatch, V);
+
+	for (uInt j = 0, n = Blocks(V) * 4; j < n; j += 4)
+	{
+		F4 ax = Load(A->mLanes[0] + j), ay = Load(A->mLanes[1] + j), az = Load(A->mLanes[2] + j);
+		F4 bx = Load(B->mLanes[0] + j), by = Load(B->mLanes[1] + j), bz = Load(B->mLanes[2] + j);
+
+		Store(V->mLanes[0] + j, ay * bz - az * by);
+		Store(V->mLanes[1] + j, az * bx - ax * bz);
+		Store(V->mLanes[2] + j, ax * by - ay * bx);
+	}
+
+	return 0;
+}
+
+// @brief Rotates each vector by a unit quaternion: per element, or one for all
+// @note Q / q: QuaternionBatch of same count; or single Quaternion, or x, y, z, w components
+static int Vec3DRotate (lua_State * L)
+{
+	Batch * V = GetBatch(L, 1, _Vec3DBatch);
+	Batch * Q = 0;
+	float q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+	if (Class::IsType(L, 2, _QuaternionBatch)) Q = GetMatchingBatch(L, 2, _QuaternionBatch, V);
+
+	else ReadQuat(L, 2, q);
+
+	// v' = v + w * t + u x t, where u = (x, y, z) and t = 2 * (u x v).
+	F4 ux(q[0]), uy(q[1]), uz(q[2]), uw(q[3]);
+
+	for (uInt j = 0, n = Blocks(V) * 4; j < n; j += 4)
+	{
+		if (Q != 0)
+		{
+			ux = Load(Q->mLanes[0] + j);
+			uy = Load(Q->mLanes[1] + j);
+			uz = Load(Q->mLanes[2] + j);
+			uw = Load(Q->mLanes[3] + j);
+		}
+
+		F4 x = Load(V->mLanes[0] + j), y = Load(V->mLanes[1] + j), z = Load(V->mLanes[2] + j);
+		F4 tx = (uy * z - uz * y) * 2.0f, ty = (uz * x - ux * z) * 2.0f, tz = (ux * y - uy * x) * 2.0f;
+
+		Store(V->mLanes[0] + j, x + uw * tx + (uy * tz - uz * ty));
+		Store(V->mLanes[1] + j, y + uw * ty + (uz * tx - ux * tz));
+		Store(V->mLanes[2] + j, z + uw * tz + (ux * ty - uy * tx));
+	}
+
+	return 0;
+}
+
+/*%%%%%%%%%%%%%%%% QuaternionBatch %%%%%%%%%%%%%%%%*/
+
+// @brief Constructs a quaternion batch; new elements are identities
+static int QuaternionBatchCons (lua_State * L)
+{
+	float const defaults[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+	Init(L, 4, defaults);
+
+	return 0;
+}
+
+// @brief Gets a quaternion
+// @note index: 1-based element index
+// @note quat: Optional Quaternion to fill
+// @return If quat was passed, quat; otherwise, the x, y, z, w components
+static int QuaternionGet (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _QuaternionBatch);
+	uInt slot = GetSlot(L, B, 2);
+
+	if (!lua_isnoneornil(L, 3))
+	{
+		Types::Quaternion & quat = Types::Quaternion_r(L, 3);
+
+		quat.x = B->mLanes[0][slot];
+		quat.y = B->mLanes[1][slot];
+		quat.z = B->mLanes[2][slot];
+		quat.w = B->mLanes[3][slot];
+
+		lua_settop(L, 3);
+
+		return 1;
+	}
+
+	for (int i = 0; i < 4; ++i) lua_pushnumber(L, B->mLanes[i][slot]);	// B, index, x, y, z, w
+
+	return 4;
+}
+
+// @brief Sets a quaternion
+// @note index: 1-based element index
+// @note quat: Quaternion, or x, y, z, w components
+static int QuaternionSet (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _QuaternionBatch);
+	float q[4];
+
+	ReadQuat(L, 3, q);
+	SetElement(L, B, GetSlot(L, B, 2), 3, q);
+
+	return 0;
+}
+
+// @brief Appends a quaternion
+// @note quat: Quaternion, or x, y, z, w components
+// @return New element count
+static int QuaternionPush (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _QuaternionBatch);
+	float q[4];
+
+	ReadQuat(L, 2, q);
+	Resize(L, B, B->mCount + 1);
+	SetElement(L, B, B->mCount - 1, 2, q);
+
+	lua_pushinteger(L, B->mCount);	// B, quat, count
+
+	return 1;
+}
+
+// @brief Normalizes each quaternion; zero quaternions are left as is
+static int QuaternionNormalize (lua_State * L)
+{
+	Batch * Q = GetBatch(L, 1, _QuaternionBatch);
+
+	for (uInt j = 0, n = Blocks(Q) * 4; j < n; j += 4)
+	{
+		F4 x = Load(Q->mLanes[0] + j), y = Load(Q->mLanes[1] + j), z = Load(Q->mLanes[2] + j), w = Load(Q->mLanes[3] + j);
+		F4 inv = SafeInverse(Sqrt(x * x + y * y + z * z + w * w));
+
+		Store(Q->mLanes[0] + j, x * inv);
+		Store(Q->mLanes[1] + j, y * inv);
+		Store(Q->mLanes[2] + j, z * inv);
+		Store(Q->mLanes[3] + j, w * inv);
+	}
+
+	return 0;
+}
+
+// @brief Spherically interpolates unit quaternions: Q[i] = slerp(A[i], B[i], t), along the shorter arc
+// @note A, B: QuaternionBatch of same count (either may be the target itself)
+// @note t: Interpolation time
+static int QuaternionSlerp (lua_State * L)
+{
+	Batch * Q = GetBatch(L, 1, _QuaternionBatch);
+	Batch * A = GetMatchingBatch(L, 2, _QuaternionBatch, Q);
+	Batch * B = GetMatchingBatch(L, 3, _QuaternionBatch, Q);
+	float t = F(L, 4);
+
+	// The weights depend on per-element angles, so this runs one element at a time.
+	for (uInt j = 0; j < Q->mCount; ++j)
+	{
+		float a[4], b[4], cosom = 0.0f;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			a[i] = A->mLanes[i][j];
+			b[i] = B->mLanes[i][j];
+
+			cosom += a[i] * b[i];
+		}
+
+		float sign = cosom < 0.0f ? -1.0f : 1.0f;
+
+		cosom *= sign;
+
+		// Nearly parallel quaternions are lerped, to avoid dividing by a tiny sine.
+		float wa = 1.0f - t, wb = t * sign;
+
+		if (cosom < 0.9995f)
+		{
+			float omega = std::acos(cosom), sinom = std::sin(omega);
+
+			wa = std::sin(wa * omega) / sinom;
+			wb = std::sin(t * omega) / sinom * sign;
+		}
+
+		for (int i = 0; i < 4; ++i) Q->mLanes[i][j] = wa * a[i] + wb * b[i];
+	}
+
+	return 0;
+}
+
+/*%%%%%%%%%%%%%%%% ComplexBatch %%%%%%%%%%%%%%%%*/
+
+// @brief Reads a complex argument, given as a Complex or as components
+// @param index Stack index of Complex or real part
+// @param c [out] Components, as real, imaginary
+static void ReadComplex (lua_State * L, int index, float c[2])
+{
+	if (lua_isnumber(L, index))
+	{
+		for (int i = 0; i < 2; ++i) c[i] = F(L, index + i);
+	}
+
+	else
+	{
+		Types::Complex & value = Types::Complex_r(L, index);
+
+		c[0] = value.real();
+		c[1] = value.imag();
+	}
+}
+
+// @brief Constructs a complex number batch
+static int ComplexBatchCons (lua_State * L)
+{
+	float const defaults[] = { 0.0f, 0.0f };
+
+	Init(L, 2, defaults);
+
+	return 0;
+}
+
+// @brief Gets a complex number
+// @note index: 1-based element index
+// @note c: Optional Complex to fill
+// @return If c was passed, c; otherwise, the real and imaginary parts
+static int ComplexGet (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _ComplexBatch);
+	uInt slot = GetSlot(L, B, 2);
+
+	if (!lua_isnoneornil(L, 3))
+	{
+		Types::Complex_r(L, 3) = Types::Complex(B->mLanes[0][slot], B->mLanes[1][slot]);
+
+		lua_settop(L, 3);
+
+		return 1;
+	}
+
+	for (int i = 0; i < 2; ++i) lua_pushnumber(L, B->mLanes[i][slot]);	// B, index, re, im
+
+	return 2;
+}
+
+// @brief Sets a complex number
+// @note index: 1-based element index
+// @note c: Complex, or real and imaginary parts
+static int ComplexSet (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _ComplexBatch);
+	float c[2];
+
+	ReadComplex(L, 3, c);
+	SetElement(L, B, GetSlot(L, B, 2), 3, c);
+
+	return 0;
+}
+
+// @brief Appends a complex number
+// @note c: Complex, or real and imaginary parts
+// @return New element count
+static int ComplexPush (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _ComplexBatch);
+	float c[2];
+
+	ReadComplex(L, 2, c);
+	Resize(L, B, B->mCount + 1);
+	SetElement(L, B, B->mCount - 1, 2, c);
+
+	lua_pushinteger(L, B->mCount);	// B, c, count
+
+	return 1;
+}
+
+// @brief Adds complex numbers: C[i] = C[i] + D[i], or C[i] = C[i] + d
+// @note D / d: ComplexBatch of same count; or single Complex, or real and imaginary parts
+static int ComplexAdd (lua_State * L)
+{
+	Batch * C = GetBatch(L, 1, _ComplexBatch);
+	Batch * D = 0;
+	float d[2];
+
+	if (Class::IsType(L, 2, _ComplexBatch)) D = GetMatchingBatch(L, 2, _ComplexBatch, C);
+
+	else ReadComplex(L, 2, d);
+
+	for (uInt i = 0; i < 2; ++i)
+	{
+		F4 c(D == 0 ? d[i] : 0.0f);
+
+		for (uInt j = 0, n = Blocks(C) * 4; j < n; j += 4) Store(C->mLanes[i] + j, Load(C->mLanes[i] + j) + (D != 0 ? Load(D->mLanes[i] + j) : c));
+	}
+
+	return 0;
+}
+
+// @brief Multiplies complex numbers: C[i] = A[i] * B[i], or C[i] = C[i] * b
+// @note A, B: ComplexBatch of same count (either may be the target itself); or b, as a single
+// Complex, or real and imaginary parts
+static int ComplexMul (lua_State * L)
+{
+	Batch * C = GetBatch(L, 1, _ComplexBatch);
+	Batch * A = C, * B = 0;
+	float b[2];
+
+	if (Class::IsType(L, 2, _ComplexBatch))
+	{
+		A = GetMatchingBatch(L, 2, _ComplexBatch, C);
+		B = GetMatchingBatch(L, 3, _ComplexBatch, C);
+	}
+
+	else ReadComplex(L, 2, b);
+
+	F4 bre(B == 0 ? b[0] : 0.0f), bim(B == 0 ? b[1] : 0.0f);
+
+	for (uInt j = 0, n = Blocks(C) * 4; j < n; j += 4)
+	{
+		F4 are = Load(A->mLanes[0] + j), aim = Load(A->mLanes[1] + j);
+
+		if (B != 0)
+		{
+			bre = Load(B->mLanes[0] + j);
+			bim = Load(B->mLanes[1] + j);
+		}
+
+		Store(C->mLanes[0] + j, are * bre - aim * bim);
+		Store(C->mLanes[1] + j, are * bim + aim * bre);
+	}
+
+	return 0;
+}
+
+// @brief Computes magnitudes: out[i] = |C[i]|
+// @note out: Float32Array, of at least the batch's count
+static int ComplexAbs (lua_State * L)
+{
+	Batch * C = GetBatch(L, 1, _ComplexBatch);
+	Array<float> * out = _arrayT<float>(L, 2);
+
+	if (out->mCount < C->mCount) luaL_error(L, "Output too small");
+
+	for (uInt j = 0; j < C->mCount; j += 4)
+	{
+		F4 re = Load(C->mLanes[0] + j), im = Load(C->mLanes[1] + j);
+
+		StoreN(out->mData + j, Sqrt(re * re + im * im), C->mCount - j < 4 ? C->mCount - j : 4);
+	}
+
+	return 0;
+}
+
+// @brief Normalizes each complex number; zeroes are left as is
+static int ComplexNormalize (lua_State * L)
+{
+	Batch * C = GetBatch(L, 1, _ComplexBatch);
+
+	for (uInt j = 0, n = Blocks(C) * 4; j < n; j += 4)
+	{
+		F4 re = Load(C->mLanes[0] + j), im = Load(C->mLanes[1] + j);
+		F4 inv = SafeInverse(Sqrt(re * re + im * im));
+
+		Store(C->mLanes[0] + j, re * inv);
+		Store(C->mLanes[1] + j, im * inv);
+	}
+
+	return 0;
+}
+
+/*%%%%%%%%%%%%%%%% BoxBatch %%%%%%%%%%%%%%%%*/
+
+// @brief Constructs a batch of axis-aligned boxes, as x, y, w, h (cf. numericops.BoxesIntersect)
+static int BoxBatchCons (lua_State * L)
+{
+	float const defaults[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	Init(L, 4, defaults);
+
+	return 0;
+}
+
+// @brief Gets a box
+// @note index: 1-based element index
+// @return x, y, w, h
+static int BoxGet (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _BoxBatch);
+	uInt slot = GetSlot(L, B, 2);
+
+	for (int i = 0; i < 4; ++i) lua_pushnumber(L, B->mLanes[i][slot]);	// B, index, x, y, w, h
+
+	return 4;
+}
+
+// @brief Sets a box
+// @note index: 1-based element index
+// @note x, y, w, h: Box
+static int BoxSet (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _BoxBatch);
+
+	SetElement(L, B, GetSlot(L, B, 2), 3, 0);
+
+	return 0;
+}
+
+// @brief Appends a box
+// @note x, y, w, h: Box
+// @return New element count
+static int BoxPush (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _BoxBatch);
+
+	for (int i = 2; i <= 5; ++i) luaL_checknumber(L, i);
+
+	Resize(L, B, B->mCount + 1);
+	SetElement(L, B, B->mCount - 1, 2, 0);
+
+	lua_pushinteger(L, B->mCount);	// B, x, y, w, h, count
+
+	return 1;
+}
+
+// @brief Finds the boxes that intersect a given box, with the same test as numericops.BoxesIntersect
+// @note x, y, w, h: Box to test
+// @note out: Optional Int32Array to receive 1-based indices of intersecting boxes, as room allows
+// @return Number of intersecting boxes
+static int BoxIntersect (lua_State * L)
+{
+	Batch * B = GetBatch(L, 1, _BoxBatch);
+	F4 x2(F(L, 2)), y2(F(L, 3)), w2(F(L, 4)), h2(F(L, 5));
+	F4 r2 = x2 + w2, t2 = y2 + h2;
+	Array<sInt> * out = !lua_isnoneornil(L, 6) ? _arrayT<sInt>(L, 6) : 0;
+	uInt count = 0;
+
+	for (uInt j = 0; j < B->mCount; j += 4)
+	{
+		F4 x1 = Load(B->mLanes[0] + j), y1 = Load(B->mLanes[1] + j);
+		int miss = GreaterMask(x1, r2) | GreaterMask(x2, x1 + Load(B->mLanes[2] + j)) | GreaterMask(y1, t2) | GreaterMask(y2, y1 + Load(B->mLanes[3] + j));
+		int hits = ~miss & (B->mCount - j < 4 ? (1 << (B->mCount - j)) - 1 : 0xF);
+
+		for (uInt i = 0; hits != 0; ++i, hits >>= 1)
+		{
+			if (!(hits & 1)) continue;
+
+			if (out != 0 && count < out->mCount) out->mData[count] = sInt(j + i + 1);
+
+			++count;
+		}
+	}
+
+	lua_pushinteger(L, count);	// B, x, y, w, h[, out], count
+
+	return 1;
+}
+
+// @brief Defines the batch classes
+// @param L Lua state
+// @return 0
+// @note Must be called once the class module and typed arrays are loaded
+int Bindings::open_batches (lua_State * L)
+{
+	luaL_reg vec3d_methods[] = {
+		{ "Add", Vec3DAdd },
+		{ "Cross", Vec3DCross },
+		{ "Dot", Vec3DDot },
+		{ "Get", Vec3DGet },
+		{ "Normalize", Vec3DNormalize },
+		{ "Push", Vec3DPush },
+		{ "Resize", ResizeBatch },
+		{ "Rotate", Vec3DRotate },
+		{ "Set", Vec3DSet },
+		{ "Transform", Vec3DTransform },
+		{ "__gc", GC },
+		{ "__len", Len },
+		{ 0, 0 }
+	};
+
+	luaL_reg quaternion_methods[] = {
+		{ "Get", QuaternionGet },
+		{ "Normalize", QuaternionNormalize },
+		{ "Push", QuaternionPush },
+		{ "Resize", ResizeBatch },
+		{ "Set", QuaternionSet },
+		{ "Slerp", QuaternionSlerp },
+		{ "__gc", GC },
+		{ "__len", Len },
+		{ 0, 0 }
+	};
+
+	luaL_reg box_methods[] = {
+		{ "Get", BoxGet },
+		{ "Intersect", BoxIntersect },
+		{ "Push", BoxPush },
+		{ "Resize", ResizeBatch },
+		{ "Set", BoxSet },
+		{ "__gc", GC },
+		{ "__len", Len },
+		{ 0, 0 }
+	};
+
+	luaL_reg complex_methods[] = {
+		{ "Abs", ComplexAbs },
+		{ "Add", ComplexAdd },
+		{ "Get", ComplexGet },
+		{ "Mul", ComplexMul },
+		{ "Normalize", ComplexNormalize },
+		{ "Push", ComplexPush },
+		{ "Resize", ResizeBatch },
+		{ "Set", ComplexSet },
+		{ "__gc", GC },
+		{ "__len", Len },
+		{ 0, 0 }
+	};
+
+	Class::Define(L, _Vec3DBatch, vec3d_methods, Vec3DBatchCons, Class::Def(sizeof(Batch)));
+	Class::Define(L, _QuaternionBatch, quaternion_methods, QuaternionBatchCons, Class::Def(sizeof(Batch)));
+	Class::Define(L, _BoxBatch, box_methods, BoxBatchCons, Class::Def(sizeof(Batch)));
+	Class::Define(L, _ComplexBatch, complex_methods, ComplexBatchCons, Class::Def(sizeof(Batch)));
+
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include "Lua_/Peer.h"
+#include "Lua_/Templates.h"
+#include <cmath>
+
+// @brief Plain datum, bound as a class and as a peer for the bound-call benchmarks
+struct BenchPoint {
+	float mX;	// Coordinates
+	float mY;
+	sInt mN;// Counter
+	bool mFlag;	// Flag
+};
+
+namespace Lua
+{
+	// @brief Type names
+	template<> char const * _typeT<BenchPoint> (void) { return "BenchPoint"; }
+	template<> char const * _rtypeT<BenchPoint> (void) { return "BenchPointRef"; }
+}
+
+using namespace Lua;
+
+/*%%%%%%%%%%%%%%%% ARGUMENTS %%%%%%%%%%%%%%%%*/
+
+// @brief Reads one argument of each common kind, through the Arg accessors
+// @note f: Number
+// @note i: Integer
+// @note b: Boolean
+// @note ud: Userdata
+static int Args (lua_State * L)
+{
+	float f = F(L, 1);
+	sInt i = sI(L, 2);
+	bool b = B(L, 3);
+	void * ud = UD(L, 4);
+
+	lua_pushboolean(L, b && ud != 0 && f > i);	// f, i, b, ud, result
+
+	return 1;
+}
+
+/*%%%%%%%%%%%%%%%% BenchPoint %%%%%%%%%%%%%%%%*/
+
+// @brief Constructs a point
+// @note [x, y]: Coordinates; if absent, 0
+static int BenchPointCons (lua_State * L)
+{
+	BenchPoint * point = (BenchPoint *)UD(L, 1);
+
+	point->mX = !lua_isnoneornil(L, 2) ? F(L, 2) : 0.0f;
+	point->mY = !lua_isnoneornil(L, 3) ? F(L, 3) : 0.0f;
+	point->mN = 0;
+	point->mFlag = false;
+
+	return 0;
+}
+
+// @brief Adds another point into this one
+// @note other: Point
+static int BenchPointAdd (lua_State * L)
+{
+	BenchPoint * point = _pT<BenchPoint>(L, 1);
+	BenchPoint * other = _pT<BenchPoint>(L, 2);
+
+	point->mX += other->mX;
+	point->mY += other->mY;
+
+	return 0;
+}
+
+// @brief Gets the point's length
+// @return Length
+static int BenchPointLength (lua_State * L)
+{
+	BenchPoint * point = _pT<BenchPoint>(L, 1);
+
+	lua_pushnumber(L, std::sqrt(point->mX * point->mX + point->mY * point->mY));// P, length
+
+	return 1;
+}
+
+/*%%%%%%%%%%%%%%%% PEERS %%%%%%%%%%%%%%%%*/
+
+// @brief Builds a userdata whose members are reached through peer accessors
+// @note _U1: Peer metatable
+// @return Peer
+static int NewPeer (lua_State * L)
+{
+	BenchPoint * point = (BenchPoint *)lua_newuserdata(L, sizeof(BenchPoint));	// peer
+
+	point->mX = point->mY = 0.0f;
+	point->mN = 0;
+	point->mFlag = false;
+
+	lua_pushvalue(L, lua_upvalueindex(1));	// peer, meta
+	lua_setmetatable(L, -2);// peer
+
+	return 1;
+}
+
+// @brief Opens the bench_core library, which the Bench scripts time bound calls against
+// @param L Lua state
+// @return 0
+// @note Must be called once the class module is loaded
+int Bindings::open_bench (lua_State * L)
+{
+	luaL_reg methods[] = {
+		{ "Add", BenchPointAdd },
+		{ "Length", BenchPointLength },
+		{ 0, 0 }
+	};
+
+	Class::Define(L, _typeT<BenchPoint>(), methods, BenchPointCons, Class::Def(sizeof(BenchPoint)));
+
+	// Bind the point's members onto a peer metatable.
+	Member_Reg members[4];
+
+	members[0].Bind(&BenchPoint::mX, "x");
+	members[1].Bind(&BenchPoint::mY, "y");
+	members[2].Bind(&BenchPoint::mN, "n");
+	members[3].Bind(&BenchPoint::mFlag, "flag");
+
+	luaL_reg funcs[] = {
+		{ "Args", Args },
+		{ 0, 0 }
+	};
+
+	luaL_register(L, "bench_core", funcs);	// bench_core
+
+	lua_createtable(L, 0, 2);	// bench_core, meta
+
+	BindPeer(L, 0, 0, members, false);	// bench_core, meta, __index, __newindex
+
+	lua_setfield(L, -3, "__newindex");	// bench_core, meta = { __newindex }, __index
+	lua_setfield(L, -2, "__index");	// bench_core, meta = { __index, __newindex }
+	lua_pushcclosure(L, NewPeer, 1);// bench_core, NewPeer
+	lua_setfield(L, -2, "NewPeer");	// bench_core = { ..., NewPeer }
+	lua_pop(L, 1);	//
+
+	return 0;
+}
@@ -0,0 +1,278 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef _MSC_VER
+	typedef unsigned __int64 uInt64;
+#else
+	typedef unsigned long long uInt64;
+#endif
+
+// @brief Cache entry layout: magic, then source length, source hash (low, high), and bytecode
+// length as little-endian 32-bit words, then the lua_dump output
+// @note Entries are read and written with stdio: the cache is a plain directory on disk, never
+// inside a pack, and must be writable, which the file manager streams do not provide
+static char const sMagic[4] = { 'L', 'B', 'C', '\1' };
+
+static size_t const sHeaderSize = sizeof(sMagic) + 4 * 4;
+
+// @brief Cache directory (if empty, the cache is off) and write permission
+static std::string s_dir;
+static bool s_bWrite;
+
+// @brief Hashes a chunk: FNV-1a over the Lua version, the chunk name, and the source
+// @note The name is included since lua_dump records it for debug info
+static uInt64 ChunkHash (char const * text, size_t len, char const * name)
+{
+	uInt64 hash = 0xCBF29CE484222325ULL;
+
+	for (char const * str = LUA_VERSION; *str; ++str) hash = (hash ^ uChar(*str)) * 0x100000001B3ULL;
+
+	for (char const * str = name; *str; ++str) hash = (hash ^ uChar(*str)) * 0x100000001B3ULL;
+
+	hash = (hash ^ 0xFF) * 0x100000001B3ULL;
+
+	for (size_t i = 0; i < len; ++i) hash = (hash ^ uChar(text[i])) * 0x100000001B3ULL;
+
+	return hash;
+}
+
+// @brief Gets the path of a chunk's cache entry
+static std::string EntryPath (uInt64 hash)
+{
+	char name[24];
+
+	sprintf(name, "%08x%08x.luac", uInt(hash >> 32), uInt(hash));
+
+	return s_dir + name;
+}
+
+static void PutU32 (std::string & out, uInt value)
+{
+	for (int i = 0; i < 4; ++i, value >>= 8) out += char(value & 0xFF);
+}
+
+static uInt GetU32 (char const * data)
+{
+	uChar const * bytes = (uChar const *)data;
+
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (uInt(bytes[3]) << 24);
+}
+
+// @brief lua_dump writer: appends to a string
+static int DumpWriter (lua_State *, void const * p, size_t size, void * ud)
+{
+	((std::string *)ud)->append((char const *)p, size);
+
+	return 0;
+}
+
+// @brief Reads a cache entry, or only its header
+// @param entry [out] If non-0, the entry
+// @return If true, the entry belongs to the source and is complete
+static bool ReadEntry (std::string const & path, uInt64 hash, size_t len, std::string * entry)
+{
+	FILE * file = fopen(path.c_str(), "rb");
+
+	if (0 == file) return false;
+
+	char header[sHeaderSize];
+	long end = 0;
+	bool bRead = fseek(file, 0, SEEK_END) == 0 && (end = ftell(file)) >= long(sHeaderSize) && fseek(file, 0, SEEK_SET) == 0;
+
+	if (bRead && entry != 0)
+	{
+		entry->resize(size_t(end));
+
+		bRead = fread(&(*entry)[0], 1, entry->size(), file) == entry->size();
+
+		if (bRead) memcpy(header, entry->data(), sHeaderSize);
+	}
+
+	else if (bRead) bRead = fread(header, 1, sHeaderSize, file) == sHeaderSize;
+
+	fclose(file);
+
+	// Reject entries with a foreign header, or that are truncated or collide with another source.
+	if (!bRead || memcmp(header, sMagic, sizeof(sMagic)) != 0) return false;
+
+	char const * words = header + sizeof(sMagic);
+
+	if (GetU32(words) != len || GetU32(words + 4) != uInt(hash) || GetU32(words + 8) != uInt(hash >> 32)) return false;
+
+	return GetU32(words + 12) == size_t(end) - sHeaderSize;
+}
+
+// @brief Tries to load a chunk from its cache entry
+// @return If true, the chunk was loaded
+// @note On success, the chunk is pushed
+static bool LoadEntry (lua_State * L, std::string const & path, uInt64 hash, size_t len, char const * name)
+{
+	std::string entry;
+
+	if (!ReadEntry(path, hash, len, &entry)) return false;
+
+	// Lua checks the bytecode's own header (version, number format) while undumping.
+	if (luaL_loadbuffer(L, entry.data() + sHeaderSize, entry.size() - sHeaderSize, name) == 0) return true;	// ..., chunk
+
+	lua_pop(L, 1);	// ...
+
+	return false;
+}
+
+// @brief Begins a chunk's cache entry: the header, with the bytecode length left 0
+static std::string EntryHeader (uInt64 hash, size_t len)
+{
+	std::string entry(sMagic, sizeof(sMagic));
+
+	PutU32(entry, uInt(len));
+	PutU32(entry, uInt(hash));
+	PutU32(entry, uInt(hash >> 32));
+	PutU32(entry, 0);
+
+	return entry;
+}
+
+// @brief Writes a cache entry, once its bytecode follows the header
+static void WriteEntry (std::string & entry)
+{
+	// Patch in the bytecode length. A partly written entry fails this check on the next load.
+	std::string length;
+
+	PutU32(length, uInt(entry.size() - sHeaderSize));
+
+	entry.replace(sHeaderSize - 4, 4, length);
+
+	// The path follows from the hash in the header.
+	char const * words = entry.data() + sizeof(sMagic);
+	FILE * file = fopen(EntryPath(GetU32(words + 4) | (uInt64(GetU32(words + 8)) << 32)).c_str(), "wb");
+
+	if (file != 0)
+	{
+		fwrite(entry.data(), 1, entry.size(), file);
+		fclose(file);
+	}
+}
+
+// @brief Writes a chunk's cache entry
+// @note chunk: Compiled chunk
+static void StoreEntry (lua_State * L, uInt64 hash, size_t len)
+{
+	std::string entry = EntryHeader(hash, len);
+
+	if (lua_dump(L, DumpWriter, &entry) == 0) WriteEntry(entry);
+}
+
+namespace Lua
+{
+	// @brief Configures the bytecode cache
+	// @param dir Cache directory; if null or empty, the cache is disabled
+	// @param bWrite If true, misses are compiled into the cache; otherwise, it is read-only (e.g. as shipped)
+	// @note Entries are keyed by the source's content hash, chunk name, and Lua version, so an edited
+	// script simply misses the cache; stale entries can be cleared out by emptying the directory
+	void SetBytecodeCache (char const * dir, bool bWrite)
+	{
+		s_dir = dir != 0 ? dir : "";
+		s_bWrite = bWrite;
+
+		if (!s_dir.empty() && s_dir[s_dir.size() - 1] != '/' && s_dir[s_dir.size() - 1] != '\\') s_dir += '/';
+	}
+
+	// @brief Loads a chunk from source, going through the bytecode cache when enabled
+	// @param L Lua state
+	// @param text Source text
+	// @param len Source length
+	// @param name Chunk name
+	// @return luaL_loadbuffer result
+	// @note On success, the chunk is pushed; otherwise, the error message
+	int LoadChunk (lua_State * L, char const * text, size_t len, char const * name)
+	{
+		if (s_dir.empty()) return luaL_loadbuffer(L, text, len, name);
+
+		uInt64 hash = ChunkHash(text, len, name);
+		std::string path = EntryPath(hash);
+
+		if (LoadEntry(L, path, hash, len, name)) return 0;	// ..., chunk
+
+		int result = luaL_loadbuffer(L, text, len, name);	// ..., chunk_or_error
+
+		if (0 == result && s_bWrite) StoreEntry(L, hash, len);
+
+		return result;
+	}
+
+	// @brief Looks up a chunk's bytecode cache entry, without loading it
+	// @param text Source text
+	// @param len Source length
+	// @param name Chunk name
+	// @param header [out] If the entry is missing and the cache is writable, the header for
+	// StoreBytecode; otherwise, empty
+	// @return If true, a valid entry exists
+	// @note Lets the compiler workers skip scripts the cache already holds, and fill it with the rest
+	bool FindBytecode (char const * text, size_t len, char const * name, std::string & header)
+	{
+		header.clear();
+
+		if (s_dir.empty()) return false;
+
+		uInt64 hash = ChunkHash(text, len, name);
+
+		if (ReadEntry(EntryPath(hash), hash, len, 0)) return true;
+
+		if (s_bWrite) header = EntryHeader(hash, len);
+
+		return false;
+	}
+
+	// @brief Stores bytecode compiled elsewhere into the bytecode cache
+	// @param header Header from FindBytecode; if empty, nothing is stored
+	// @param bytecode lua_dump output
+	void StoreBytecode (std::string const & header, std::string const & bytecode)
+	{
+		if (header.empty()) return;
+
+		std::string entry = header + bytecode;
+
+		WriteEntry(entry);
+	}
+
+	// @brief Compiles a script into the bytecode cache, without running it
+	// @param L Lua state
+	// @param name Script name
+	// @return 0 on success; otherwise, an error message is pushed
+	// @note Used to prebuild the cache for shipping. The script is found as FM_Loader finds it: from
+	// the mounted packs, or from a loose file when overrides are on or no pack holds it. Entries are
+	// keyed by the source text, so prebuild with the same packs mounted as will ship, or the entries
+	// for packed scripts will not match. The cache must be enabled for writing.
+	int CacheFile (lua_State * L, char const * name)
+	{
+		if (s_dir.empty() || !s_bWrite)
+		{
+			lua_pushfstring(L, "Could not cache file: %s (bytecode cache is not writable)", name);	// ..., error
+
+			return LUA_ERRFILE;
+		}
+
+		CacheAndGet(L, Lua::FM_Loader);	// ..., loader
+
+		lua_pushstring(L, name);// ..., loader, name
+
+		int result = PCall_EF(L, 1, 2);	// ..., chunk_or_nil[, error]
+
+		if (result != 0) return result;
+
+		if (lua_isnil(L, -2))
+		{
+			lua_remove(L, -2);	// ..., error
+
+			return LUA_ERRFILE;
+		}
+
+		lua_pop(L, 2);	// ...
+
+		return 0;
+	}
+}
@@ -0,0 +1,776 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include <cassert>
+
+using namespace Lua;
+
+// @brief Environment indices
+enum {
+	_not_envi,
+	eInstances,	// Instance -> type name map (weak keys)
+	eClasses,	// Type name -> class info map
+	eConsStack,	// Stack of instances under construction
+	eHidden,// Hidden type value
+	eTraceback,	// Traceback store routine
+	eBuiltIn// Built-in type name set
+};
+
+// @brief Class info indices
+enum {
+	_not_infoi,
+	eIMeta,	// Instance metatable
+	eICons,	// Constructor
+	eIAlloc,// Allocator
+	eIType,	// Type name
+	eIBase,	// Base type name
+	eIHidden,	// Hidden boolean
+	eIAncestors,// Set of type names, including own
+	eIMembers,	// Flattened members
+	eIPool,	// Instance pool, if pooled
+	eIReset	// Pool reset routine
+};
+
+// @brief Instance pool; free instances are kept in its environment
+struct Pool {
+	uInt mHits;	// Number of instances drawn from the pool
+	uInt mMisses;	// Number of instances allocated while pooled
+	uInt mMax;	// Maximum number of free instances
+	uInt mCount;// Current number of free instances
+};
+
+// @brief Upvalue indices of per-class __index / __newindex closures
+enum {
+	_not_upi,
+	eUKind,	// Lookup kind
+	eUTarget,	// Lookup target
+	eUMembers	// Flattened members
+};
+
+// @brief Lookup kinds
+enum {
+	eEnv,	// Raw access into instance environment
+	eCall,	// Call target with instance, key[, value]
+	eTable	// Index target table
+};
+
+// @brief Pushes an environment field
+static void Env (lua_State * L, int slot)
+{
+	lua_rawgeti(L, LUA_ENVIRONINDEX, slot);	// ..., field
+}
+
+// @brief Pushes the class info for a type, erroring if absent
+// @param L Lua state
+// @param index Stack index of type name
+// @param what Name of calling routine
+static void GetInfo (lua_State * L, int index, char const * what)
+{
+	if (lua_isnil(L, index)) luaL_error(L, "%s: ctype == nil", what);
+
+	Env(L, eClasses);	// ..., classes
+	lua_pushvalue(L, index);// ..., classes, ctype
+	lua_rawget(L, -2);	// ..., classes, info
+
+	if (lua_isnil(L, -1)) luaL_error(L, "%s: Type \"%s\" not found", what, luaL_optstring(L, index, "?"));
+
+	lua_replace(L, -2);	// ..., info
+}
+
+// @brief Pushes the type of an instance, or nil if the item is not one
+static void GetInstanceType (lua_State * L, int index)
+{
+	if (lua_toboolean(L, index))
+	{
+		Env(L, eInstances);	// ..., instances
+		lua_pushvalue(L, index);// ..., instances, item
+		lua_rawget(L, -2);	// ..., instances, ctype
+		lua_replace(L, -2);	// ..., ctype
+	}
+
+	else lua_pushnil(L);// ..., nil
+}
+
+// @brief Gets the lookup kind of an __index / __newindex target
+static int Kind (lua_State * L, int index, lua_CFunction env)
+{
+	if (lua_tocfunction(L, index) == env) return eEnv;
+
+	return IsCallable(L, index) ? eCall : eTable;
+}
+
+// @brief Per-class __index closure
+// @note _U1: Lookup kind
+// @note _U2: Lookup target
+// @note _U3: Flattened members
+// @note I: Instance handle
+// @note key: Lookup key
+static int Index (lua_State * L)
+{
+	lua_settop(L, 2);	// I, key
+
+	switch (lua_tointeger(L, lua_upvalueindex(eUKind)))
+	{
+	case eEnv:
+		lua_getfenv(L, 1);	// I, key, env
+		lua_pushvalue(L, 2);// I, key, env, key
+		lua_rawget(L, 3);	// I, key, env, value
+		break;
+	case eCall:
+		lua_pushvalue(L, lua_upvalueindex(eUTarget));	// I, key, index
+		lua_pushvalue(L, 1);// I, key, index, I
+		lua_pushvalue(L, 2);// I, key, index, I, key
+		lua_call(L, 2, 1);	// I, key, value
+		break;
+	default:
+		lua_pushvalue(L, 2);// I, key, key
+		lua_gettable(L, lua_upvalueindex(eUTarget));// I, key, value
+	}
+
+	// If the value was not found, try the members.
+	if (lua_isnil(L, -1))
+	{
+		lua_pushvalue(L, 2);// I, key, ..., nil, key
+		lua_rawget(L, lua_upvalueindex(eUMembers));	// I, key, ..., nil, member
+	}
+
+	return 1;
+}
+
+// @brief Per-class __newindex closure
+// @note _U1: Lookup kind
+// @note _U2: Assignment target
+// @note I: Instance handle
+// @note key: Lookup key
+// @note value: Value to assign
+static int NewIndex (lua_State * L)
+{
+	lua_settop(L, 3);	// I, key, value
+
+	switch (lua_tointeger(L, lua_upvalueindex(eUKind)))
+	{
+	case eEnv:
+		lua_getfenv(L, 1);	// I, key, value, env
+		lua_replace(L, 1);	// env, key, value
+		lua_rawset(L, 1);	// env
+		break;
+	case eCall:
+		lua_pushvalue(L, lua_upvalueindex(eUTarget));	// I, key, value, newindex
+		lua_insert(L, 1);	// newindex, I, key, value
+		lua_call(L, 3, 0);
+		break;
+	default:
+		lua_settable(L, lua_upvalueindex(eUTarget));// I
+	}
+
+	return 0;
+}
+
+// @brief Default instance allocator: a bare userdata with its own environment
+// @note meta: Metatable
+static int Alloc (lua_State * L)
+{
+	lua_newuserdata(L, 0);	// meta, I
+	lua_insert(L, 1);	// I, meta
+	lua_setmetatable(L, 1);	// I
+	lua_newtable(L);// I, env
+	lua_setfenv(L, 1);	// I
+
+	return 1;
+}
+
+// @brief Pushes a free instance from a class's pool, if available
+// @param L Lua state
+// @param info Stack index of class info
+// @return If true, an instance was pushed
+static bool Draw (lua_State * L, int info)
+{
+	lua_rawgeti(L, info, eIPool);	// ..., pool?
+
+	Pool * pool = (Pool *)lua_touserdata(L, -1);
+
+	if (0 == pool || 0 == pool->mCount)
+	{
+		if (pool != 0) ++pool->mMisses;
+
+		lua_pop(L, 1);	// ...
+
+		return false;
+	}
+
+	lua_getfenv(L, -1);	// ..., pool, free
+	lua_rawgeti(L, -1, pool->mCount);	// ..., pool, free, I
+	lua_pushnil(L);	// ..., pool, free, I, nil
+	lua_rawseti(L, -3, pool->mCount--);	// ..., pool, free, I
+	lua_replace(L, -3);	// ..., I, free
+	lua_pop(L, 1);	// ..., I
+
+	++pool->mHits;
+
+	return true;
+}
+
+// @brief Appends the position of the caller to a string error and rethrows it
+static int Rethrow (lua_State * L)
+{
+	if (lua_isstring(L, -1))
+	{
+		luaL_where(L, 1);	// ..., message, where
+		lua_insert(L, -2);	// ..., where, message
+		lua_concat(L, 2);	// ..., where .. message
+	}
+
+	return lua_error(L);
+}
+
+// @brief Allocates and constructs an instance
+// @note info: Class info
+// @note ...: Constructor arguments, from index argi to the top
+// @return Stack index of instance
+static int Instantiate (lua_State * L, int info, int argi)
+{
+	int argc = lua_gettop(L) - argi + 1;
+
+	luaL_checkstack(L, argc + 8, "Instantiate: too many arguments");
+
+	// Allocate the instance, unless the pool has one. The default allocator is inlined.
+	if (!Draw(L, info))
+	{
+		lua_rawgeti(L, info, eIAlloc);	// ..., alloc
+
+		if (lua_tocfunction(L, -1) == Alloc)
+		{
+			lua_pop(L, 1);	// ...
+			lua_newuserdata(L, 0);	// ..., I
+			lua_rawgeti(L, info, eIMeta);	// ..., I, meta
+			lua_setmetatable(L, -2);// ..., I
+			lua_newtable(L);// ..., I, env
+			lua_setfenv(L, -2);	// ..., I
+		}
+
+		else
+		{
+			lua_rawgeti(L, info, eIMeta);	// ..., alloc, meta
+			lua_call(L, 1, 1);	// ..., I
+
+			if (!lua_istable(L, -1) && !lua_isuserdata(L, -1)) luaL_error(L, "Bad instance allocation");
+		}
+	}
+
+	int I = lua_gettop(L);
+
+	// Register the instance.
+	Env(L, eInstances);	// ..., I, instances
+	lua_pushvalue(L, I);// ..., I, instances, I
+	lua_rawget(L, -2);	// ..., I, instances, ctype?
+
+	if (!lua_isnil(L, -1)) luaL_error(L, "Instance already exists");
+
+	lua_pop(L, 1);	// ..., I, instances
+	lua_pushvalue(L, I);// ..., I, instances, I
+	lua_rawgeti(L, info, eIType);	// ..., I, instances, I, ctype
+	lua_rawset(L, -3);	// ..., I, instances = { ..., I = ctype }
+	lua_pop(L, 1);	// ..., I
+
+	// Invoke the constructor with the instance on the construction stack. On errors, the
+	// stack is still unwound before the error is propagated.
+	Env(L, eConsStack);	// ..., I, stack
+
+	int height = GetN(L, -1);
+
+	lua_pushvalue(L, I);// ..., I, stack, I
+	lua_rawseti(L, -2, height + 1);	// ..., I, stack = { ..., I }
+	lua_rawgeti(L, info, eICons);	// ..., I, stack, cons
+	lua_pushvalue(L, I);// ..., I, stack, cons, I
+
+	for (int i = 0; i < argc; ++i) lua_pushvalue(L, argi + i);	// ..., I, stack, cons, I, ...
+
+	int result = lua_pcall(L, argc + 1, 0, 0);	// ..., I, stack[, error]
+
+	lua_pushnil(L);	// ..., I, stack[, error], nil
+	lua_rawseti(L, I + 1, height + 1);	// ..., I, stack[, error]
+
+	if (result != 0)
+	{
+		Env(L, eTraceback);	// ..., I, stack, error, store
+
+		if (!lua_isnil(L, -1)) lua_call(L, 0, 0);	// ..., I, stack, error
+
+		else lua_pop(L, 1);	// ..., I, stack, error
+
+		Rethrow(L);
+	}
+
+	lua_pop(L, 1);	// ..., I
+
+	return I;
+}
+
+// @brief class.New
+// @note ctype: Type name
+// @note ...: Constructor arguments
+// @return Instance handle
+static int New (lua_State * L)
+{
+	GetInfo(L, 1, "class.New");	// ctype, ..., info
+
+	lua_replace(L, 1);	// info, ...
+
+	Instantiate(L, 1, 2);	// info, ..., I
+
+	return 1;
+}
+
+// @brief class.NewArray
+// @note ctype: Type name
+// @note count: Instantiation count
+// @note ...: Constructor arguments
+// @return Array of instance handles
+static int NewArray (lua_State * L)
+{
+	luaL_argcheck(L, lua_type(L, 2) == LUA_TNUMBER && lua_tonumber(L, 2) >= 0, 2, "Invalid count");
+
+	GetInfo(L, 1, "class.NewArray");// ctype, count, ..., info
+
+	lua_replace(L, 1);	// info, count, ...
+
+	int count = lua_tointeger(L, 2);
+
+	lua_createtable(L, count, 0);	// info, count, ..., array
+	lua_replace(L, 2);	// info, array, ...
+
+	for (int i = 1, top = lua_gettop(L); i <= count; ++i)
+	{
+		Instantiate(L, 1, 3);	// info, array, ..., I
+
+		lua_rawseti(L, 2, i);	// info, array = { ..., I }, ...
+		lua_settop(L, top);
+	}
+
+	lua_settop(L, 2);	// info, array
+
+	return 1;
+}
+
+// @brief class.IsInstance
+// @note item: Item to test
+// @return If true, item is a class instance
+static int IsInstance (lua_State * L)
+{
+	GetInstanceType(L, 1);	// item, ctype?
+
+	lua_pushboolean(L, !lua_isnil(L, -1));	// item, ctype?, bIsInstance
+
+	return 1;
+}
+
+// @brief Indicates whether an instance's class is or derives from a type
+// @note ctype: Instance type name on stack top (popped)
+static bool IsA (lua_State * L, int what)
+{
+	Env(L, eClasses);	// ..., ctype, classes
+	lua_insert(L, -2);	// ..., classes, ctype
+	lua_rawget(L, -2);	// ..., classes, info
+	lua_rawgeti(L, -1, eIAncestors);// ..., classes, info, ancestors
+	lua_pushvalue(L, what);	// ..., classes, info, ancestors, what
+	lua_rawget(L, -2);	// ..., classes, info, ancestors, bIsA
+
+	bool bIsA = lua_toboolean(L, -1) != 0;
+
+	lua_pop(L, 4);	// ...
+
+	return bIsA;
+}
+
+// @brief class.IsType
+// @note item: Item to test
+// @note what: Type to test
+// @return If true, item is of given type
+static int IsType (lua_State * L)
+{
+	luaL_argcheck(L, !lua_isnoneornil(L, 2), 2, "IsType: what == nil");
+
+	lua_settop(L, 2);	// item, what
+
+	GetInstanceType(L, 1);	// item, what, ctype?
+
+	// Given an instance and a class name, check the ancestry.
+	Env(L, eBuiltIn);	// item, what, ctype?, builtin
+	lua_pushvalue(L, 2);// item, what, ctype?, builtin, what
+	lua_rawget(L, -2);	// item, what, ctype?, builtin, bBuiltIn
+
+	bool bBuiltIn = lua_toboolean(L, -1) != 0;
+
+	lua_pop(L, 2);	// item, what, ctype?
+
+	if (!lua_isnil(L, 3) && !bBuiltIn) lua_pushboolean(L, IsA(L, 2));	// item, what, bIsType
+
+	// For non-instances, check the built-in type.
+	else lua_pushboolean(L, lua_type(L, 2) == LUA_TSTRING && strcmp(luaL_typename(L, 1), lua_tostring(L, 2)) == 0);	// item, what, ctype?, bIsType
+
+	return 1;
+}
+
+// @brief Resets an instance, removes it from the live set, and keeps it in its class's pool,
+// if there is room
+// @param I Stack index of instance
+// @param info Stack index of class info
+// @return If false, the class is not pooled
+static bool Keep (lua_State * L, int I, int info)
+{
+	lua_rawgeti(L, info, eIPool);	// ..., pool?
+
+	Pool * pool = (Pool *)lua_touserdata(L, -1);
+
+	if (0 == pool)
+	{
+		lua_pop(L, 1);	// ...
+
+		return false;
+	}
+
+	lua_rawgeti(L, info, eIReset);	// ..., pool, reset?
+
+	if (!lua_isnil(L, -1))
+	{
+		lua_pushvalue(L, I);// ..., pool, reset, I
+		lua_call(L, 1, 0);	// ..., pool
+	}
+
+	else lua_pop(L, 1);	// ..., pool
+
+	Env(L, eInstances);	// ..., pool, instances
+	lua_pushvalue(L, I);// ..., pool, instances, I
+	lua_pushnil(L);	// ..., pool, instances, I, nil
+	lua_rawset(L, -3);	// ..., pool, instances = { ..., I = nil }
+
+	if (pool->mCount < pool->mMax)
+	{
+		lua_getfenv(L, -2);	// ..., pool, instances, free
+		lua_pushvalue(L, I);// ..., pool, instances, free, I
+		lua_rawseti(L, -2, ++pool->mCount);	// ..., pool, instances, free = { ..., I }
+		lua_pop(L, 1);	// ..., pool, instances
+	}
+
+	lua_pop(L, 2);	// ...
+
+	return true;
+}
+
+// @brief class.Recycle
+// @note I: Instance handle
+static int Recycle (lua_State * L)
+{
+	lua_settop(L, 1);	// I
+
+	GetInstanceType(L, 1);	// I, ctype
+
+	if (lua_isnil(L, 2)) luaL_error(L, "Recycle: Not an instance");
+
+	GetInfo(L, 2, "Recycle");	// I, ctype, info
+
+	if (!Keep(L, 1, 3)) luaL_error(L, "Recycle: Type not pooled");
+
+	return 0;
+}
+
+// @brief Gives a class a pool
+// @param info Stack index of class info
+// @param pool_def Stack index of pool parameters, as built by class.Define
+static void AddPool (lua_State * L, int info, int pool_def)
+{
+	Pool * pool = (Pool *)lua_newuserdata(L, sizeof(Pool));	// ..., pool
+
+	lua_getfield(L, pool_def, "max");	// ..., pool, max
+
+	lua_Number max = lua_tonumber(L, -1);
+
+	pool->mHits = pool->mMisses = pool->mCount = 0;
+	pool->mMax = max < lua_Number(~0U) ? uInt(max) : ~0U;
+
+	lua_pop(L, 1);	// ..., pool
+	lua_newtable(L);// ..., pool, free
+	lua_setfenv(L, -2);	// ..., pool
+	lua_rawseti(L, info, eIPool);	// ...
+	lua_getfield(L, pool_def, "reset");	// ..., reset
+	lua_rawseti(L, info, eIReset);	// ...
+}
+
+// @brief class.GetPoolStats
+// @note ctype: Type name
+// @return Pool hit count, miss count, and free instance count; nothing if unpooled
+static int GetPoolStats (lua_State * L)
+{
+	GetInfo(L, 1, "GetPoolStats");	// ctype, info
+
+	lua_rawgeti(L, -1, eIPool);	// ctype, info, pool?
+
+	Pool * pool = (Pool *)lua_touserdata(L, -1);
+
+	if (0 == pool) return 0;
+
+	lua_pushinteger(L, pool->mHits);// ctype, info, pool, hits
+	lua_pushinteger(L, pool->mMisses);	// ctype, info, pool, hits, misses
+	lua_pushinteger(L, pool->mCount);	// ctype, info, pool, hits, misses, count
+
+	return 3;
+}
+
+// @brief class.SuperCons
+// @note I: Instance handle
+// @note stype: Superclass type name
+// @note ...: Constructor arguments
+static int SuperCons (lua_State * L)
+{
+	luaL_argcheck(L, !lua_isnoneornil(L, 1), 1, "SuperCons: I == nil");
+	luaL_argcheck(L, !lua_isnoneornil(L, 2), 2, "SuperCons: stype == nil");
+
+	Env(L, eConsStack);	// I, stype, ..., stack
+	lua_rawgeti(L, -1, GetN(L, -1));// I, stype, ..., stack, top
+
+	if (!lua_rawequal(L, 1, -1)) luaL_error(L, "Invoked outside of constructor");
+
+	lua_pop(L, 2);	// I, stype, ...
+
+	GetInstanceType(L, 1);	// I, stype, ..., ctype
+
+	if (lua_rawequal(L, 2, -1)) luaL_error(L, "Instance already of superclass type");
+	if (!IsA(L, 2)) luaL_error(L, "Superclass not found");	// I, stype, ...
+
+	// Invoke the constructor.
+	GetInfo(L, 2, "SuperCons");	// I, stype, ..., info
+
+	lua_rawgeti(L, -1, eICons);	// I, stype, ..., info, cons
+	lua_replace(L, 2);	// I, cons, ..., info
+	lua_pop(L, 1);	// I, cons, ...
+	lua_pushvalue(L, 2);// I, cons, ..., cons
+	lua_insert(L, 1);	// cons, I, cons, ...
+	lua_remove(L, 3);	// cons, I, ...
+	lua_call(L, lua_gettop(L) - 1, 0);
+
+	return 0;
+}
+
+// @brief class.Type
+// @note item: Item, which might be a class instance
+// @return Item's class or primitive type, and instance boolean
+static int Type (lua_State * L)
+{
+	lua_settop(L, 1);	// item
+
+	GetInstanceType(L, 1);	// item, ctype?
+
+	if (!lua_isnil(L, 2))
+	{
+		GetInfo(L, 2, "Type");	// item, ctype, info
+
+		lua_rawgeti(L, 3, eIHidden);// item, ctype, info, bHidden
+
+		if (lua_toboolean(L, -1)) Env(L, eHidden);	// item, ctype, info, bHidden, hidden
+
+		else lua_pushvalue(L, 2);	// item, ctype, info, bHidden, ctype
+
+		lua_pushboolean(L, true);	// item, ctype, info, bHidden, type, true
+	}
+
+	else
+	{
+		lua_pushstring(L, luaL_typename(L, 1));	// item, nil, type
+		lua_pushboolean(L, false);	// item, nil, type, false
+	}
+
+	return 2;
+}
+
+// @brief Builds a per-class lookup closure
+// @param L Lua state
+// @param def Stack index of class definition
+// @param field Name of lookup field in definition
+// @param func Closure body
+// @param env Environment access function corresponding to the lookup
+// @param members Stack index of flattened members (if 0, not used)
+static void PushLookup (lua_State * L, int def, char const * field, lua_CFunction func, lua_CFunction env, int members)
+{
+	lua_getfield(L, def, field);// ..., target
+
+	lua_pushinteger(L, Kind(L, -1, env));	// ..., target, kind
+	lua_insert(L, -2);	// ..., kind, target
+
+	if (members != 0) lua_pushvalue(L, members);// ..., kind, target, members
+
+	lua_pushcclosure(L, func, members != 0 ? 3 : 2);// ..., closure
+}
+
+// @brief Registers a class definition and installs its lookup metamethods
+// @note ctype: Type name
+// @note def: Class definition, as built by class.Define
+static int Define (lua_State * L)
+{
+	luaL_checktype(L, 2, LUA_TTABLE);
+	lua_settop(L, 2);	// ctype, def
+	lua_createtable(L, eIReset, 0);	// ctype, def, info
+
+	// Flatten the members, beginning with those of the base class.
+	lua_newtable(L);// ctype, def, info, members
+	lua_newtable(L);// ctype, def, info, members, ancestors
+	lua_getfield(L, 2, "base");	// ctype, def, info, members, ancestors, base
+
+	if (!lua_isnil(L, -1))
+	{
+		GetInfo(L, 6, "Define");// ctype, def, info, members, ancestors, base, binfo
+
+		for (int i = eIAncestors; i <= eIMembers; ++i)
+		{
+			lua_rawgeti(L, -1, i);	// ctype, def, info, members, ancestors, base, binfo, bset
+
+			for (lua_pushnil(L); lua_next(L, -2) != 0; )	// ctype, def, info, members, ancestors, base, binfo, bset, k, v
+			{
+				lua_pushvalue(L, -2);	// ctype, def, info, members, ancestors, base, binfo, bset, k, v, k
+				lua_insert(L, -2);	// ctype, def, info, members, ancestors, base, binfo, bset, k, k, v
+				lua_rawset(L, eIAncestors == i ? 5 : 4);// ctype, def, info, members, ancestors, base, binfo, bset, k
+			}
+
+			lua_pop(L, 1);	// ctype, def, info, members, ancestors, base, binfo
+		}
+
+		lua_pop(L, 1);	// ctype, def, info, members, ancestors, base
+	}
+
+	lua_rawseti(L, 3, eIBase);	// ctype, def, info = { base }, members, ancestors
+	lua_pushvalue(L, 1);// ctype, def, info, members, ancestors, ctype
+	lua_pushboolean(L, true);	// ctype, def, info, members, ancestors, ctype, true
+	lua_rawset(L, 5);	// ctype, def, info, members, ancestors = { ..., ctype = true }
+	lua_rawseti(L, 3, eIAncestors);	// ctype, def, info = { base, ancestors }, members
+	lua_getfield(L, 2, "members");	// ctype, def, info, members, own
+
+	for (lua_pushnil(L); lua_next(L, 5) != 0; )	// ctype, def, info, members, own, k, v
+	{
+		lua_pushvalue(L, -2);	// ctype, def, info, members, own, k, v, k
+		lua_insert(L, -2);	// ctype, def, info, members, own, k, k, v
+		lua_rawset(L, 4);	// ctype, def, info, members = { ..., k = v }, own, k
+	}
+
+	lua_pop(L, 1);	// ctype, def, info, members
+
+	// Install the per-class lookups on the metatable, in place of the common ones.
+	lua_getfield(L, 2, "meta");	// ctype, def, info, members, meta
+
+	PushLookup(L, 2, "__index", Index, Class::EnvIndex, 4);	// ctype, def, info, members, meta, __index
+
+	lua_setfield(L, 5, "__index");	// ctype, def, info, members, meta = { ..., __index }
+
+	PushLookup(L, 2, "__newindex", NewIndex, Class::EnvNewIndex, 0);// ctype, def, info, members, meta, __newindex
+
+	lua_setfield(L, 5, "__newindex");	// ctype, def, info, members, meta = { ..., __index, __newindex }
+
+	// Fill in the remaining info and register it.
+	lua_rawseti(L, 3, eIMeta);	// ctype, def, info = { base, ancestors, meta }, members
+	lua_rawseti(L, 3, eIMembers);	// ctype, def, info = { base, ancestors, meta, members }
+	lua_getfield(L, 2, "cons");	// ctype, def, info, cons
+	lua_rawseti(L, 3, eICons);	// ctype, def, info = { base, ancestors, meta, members, cons }
+	lua_getfield(L, 2, "alloc");// ctype, def, info, alloc
+	lua_rawseti(L, 3, eIAlloc);	// ctype, def, info = { base, ancestors, meta, members, cons, alloc }
+	lua_getfield(L, 2, "bHidden");	// ctype, def, info, bHidden
+	lua_rawseti(L, 3, eIHidden);// ctype, def, info = { base, ancestors, meta, members, cons, alloc, bHidden }
+	lua_pushvalue(L, 1);// ctype, def, info, ctype
+	lua_rawseti(L, 3, eIType);	// ctype, def, info = { base, ancestors, meta, members, cons, alloc, bHidden, ctype }
+
+	// Give the class a pool, if it has one.
+	lua_getfield(L, 2, "pool");	// ctype, def, info, pool_def
+
+	if (!lua_isnil(L, -1)) AddPool(L, 3, 4);
+
+	lua_pop(L, 1);	// ctype, def, info
+
+	Env(L, eClasses);	// ctype, def, info, classes
+
+	lua_insert(L, 1);	// classes, ctype, def, info
+	lua_replace(L, 3);	// classes, ctype, info
+	lua_rawset(L, 1);	// classes = { ..., ctype = info }
+
+	return 0;
+}
+
+// @brief class.SetPool
+// @note ctype: Type name
+// @note pool: Pool parameters, as built by class.SetPool
+static int SetPool (lua_State * L)
+{
+	luaL_checktype(L, 2, LUA_TTABLE);
+	lua_settop(L, 2);	// ctype, pool_def
+
+	GetInfo(L, 1, "SetPool");	// ctype, pool_def, info
+
+	lua_rawgeti(L, 3, eIPool);	// ctype, pool_def, info, pool?
+
+	if (!lua_isnil(L, 4)) luaL_error(L, "SetPool: Type already pooled");
+
+	AddPool(L, 3, 2);
+
+	return 0;
+}
+
+// @brief Binds the runtime to the state shared with the Lua-side class module
+// @note instances: Instance -> type name map
+// @note hidden: Hidden type value
+// @note store: [optional] Traceback store routine
+static int Init (lua_State * L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+	luaL_checkany(L, 2);
+
+	lua_settop(L, 3);	// instances, hidden, store
+	lua_rawseti(L, LUA_ENVIRONINDEX, eTraceback);	// instances, hidden
+	lua_rawseti(L, LUA_ENVIRONINDEX, eHidden);	// instances
+	lua_rawseti(L, LUA_ENVIRONINDEX, eInstances);
+
+	return 0;
+}
+
+// @brief Opens the native class runtime
+// @note Registered as class_core; class.lua picks it up if present
+int Bindings::open_class (lua_State * L)
+{
+	luaL_reg funcs[] = {
+		{ "Alloc", Alloc },
+		{ "Define", Define },
+		{ "EnvIndex", Class::EnvIndex },
+		{ "EnvNewIndex", Class::EnvNewIndex },
+		{ "GetPoolStats", GetPoolStats },
+		{ "Init", Init },
+		{ "IsInstance", IsInstance },
+		{ "IsType", IsType },
+		{ "New", New },
+		{ "NewArray", NewArray },
+		{ "Recycle", Recycle },
+		{ "SetPool", SetPool },
+		{ "SuperCons", SuperCons },
+		{ "Type", Type },
+		{ 0, 0 }
+	};
+
+	char const * builtin[] = { "boolean", "function", "nil", "number", "string", "table", "thread", "userdata" };
+
+	// Build the shared environment.
+	lua_createtable(L, eBuiltIn, 0);// env
+	lua_newtable(L);// env, classes
+	lua_rawseti(L, -2, eClasses);	// env = { classes }
+	lua_newtable(L);// env, stack
+	lua_rawseti(L, -2, eConsStack);	// env = { classes, stack }
+	lua_createtable(L, 0, ArrayN(builtin));	// env, builtin
+
+	for (int i = 0; i < ArrayN(builtin); ++i)
+	{
+		lua_pushboolean(L, true);	// env, builtin, true
+		lua_setfield(L, -2, builtin[i]);// env, builtin = { ..., name = true }
+	}
+
+	lua_rawseti(L, -2, eBuiltIn);	// env = { classes, stack, builtin }
+
+	Register(L, "class_core", funcs, -1);
+
+	lua_pop(L, 1);
+
+	return 0;
+}
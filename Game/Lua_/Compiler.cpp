@@ -0,0 +1,466 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Compiler.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include "Lua_/Pack.h"
+#include <SCRIPT_MANAGER>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
+using namespace Lua;
+
+// @brief Compile job
+struct Job {
+	enum State { eQueued, eRunning, eDone, eClaimed };
+
+	std::string mName;	// Script name
+	std::string mSource;// Script text, read by the main thread; released once compiled
+	std::string mResult;// Bytecode, or error message
+	std::string mHeader;// Bytecode cache entry header, if the bytecode should be cached
+	State mState;	// Progress; a claimed job was taken back by the main thread before it finished
+	bool mOK;	// If true, the result is bytecode
+};
+
+// @brief Worker pool state
+// @note Jobs stay in mJobs until the main thread consumes, claims, or drops them; claimed jobs
+// are freed by whichever worker pops or finishes them
+static struct WorkerPool {
+#ifdef _WIN32
+	CRITICAL_SECTION mLock;	// Guards the pool
+	CONDITION_VARIABLE mWork;	// Signaled when jobs are queued, or on shutdown
+	CONDITION_VARIABLE mDone;	// Signaled when a job finishes
+	std::vector<HANDLE> mThreads;	// Workers
+#else
+	pthread_mutex_t mLock;
+	pthread_cond_t mWork;
+	pthread_cond_t mDone;
+	std::vector<pthread_t> mThreads;
+#endif
+	std::deque<Job *> mQueue;	// Jobs waiting for a worker
+	std::map<std::string, Job *> mJobs;	// Unconsumed jobs, by name
+	std::set<std::string> mLoaded;	// Names consumed since the last drop, which are not queued again
+	bool mRunning;	// If true, workers are up
+	bool mQuit;	// If true, workers should exit
+} sPool;
+
+static void Lock (void)
+{
+#ifdef _WIN32
+	EnterCriticalSection(&sPool.mLock);
+#else
+	pthread_mutex_lock(&sPool.mLock);
+#endif
+}
+
+static void Unlock (void)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&sPool.mLock);
+#else
+	pthread_mutex_unlock(&sPool.mLock);
+#endif
+}
+
+#ifdef _WIN32
+	static void Wait (CONDITION_VARIABLE & cond) { SleepConditionVariableCS(&cond, &sPool.mLock, INFINITE); }
+	static void WakeAll (CONDITION_VARIABLE & cond) { WakeAllConditionVariable(&cond); }
+#else
+	static void Wait (pthread_cond_t & cond) { pthread_cond_wait(&cond, &sPool.mLock); }
+	static void WakeAll (pthread_cond_t & cond) { pthread_cond_broadcast(&cond); }
+#endif
+
+// @brief lua_dump writer: appends to a string
+static int DumpWriter (lua_State *, void const * p, size_t size, void * ud)
+{
+	((std::string *)ud)->append((char const *)p, size);
+
+	return 0;
+}
+
+// @brief Compiles a job's script to bytecode
+// @param L Scratch state
+// @note Workers only see the text the main thread read, so they never touch the file manager
+static void Compile (lua_State * L, Job * job)
+{
+	job->mOK = luaL_loadbuffer(L, job->mSource.data(), job->mSource.size(), job->mName.c_str()) == 0;	// chunk / error
+
+	if (job->mOK)
+	{
+		job->mOK = lua_dump(L, DumpWriter, &job->mResult) == 0;
+
+		if (!job->mOK) job->mResult = "Could not dump script";
+	}
+
+	else
+	{
+		char const * error = lua_tostring(L, -1);
+
+		job->mResult = error != 0 ? error : "Could not compile script";
+	}
+
+	lua_settop(L, 0);
+
+	std::string().swap(job->mSource);
+}
+
+// @brief Reads a script's text, looking it up as FM_Loader does
+// @param name Script name
+// @param text [out] Script text
+// @return If true, the text was read
+static bool ReadSource (char const * name, std::string & text)
+{
+	int result = Pack::LooseOverrides() ? -1 : Pack::Read(name, text);
+
+	if (result < 0)
+	{
+		FILE_STREAM * pIn = CREATE_FILESTREAM(name, 0);
+
+		if (0 == pIn) result = Pack::LooseOverrides() ? Pack::Read(name, text) : -1;
+
+		else
+		{
+			int size = pIn->GetSize();
+
+			text.resize(size_t(size));
+
+			if (size > 0) pIn->Read(&text[0], size);
+
+			pIn->Close();
+
+			result = 0;
+		}
+	}
+
+	return 0 == result;
+}
+
+// @brief Worker body
+static void Work (void)
+{
+	lua_State * L = luaL_newstate();
+
+	Lock();
+
+	for (;;)
+	{
+		while (sPool.mQueue.empty() && !sPool.mQuit) Wait(sPool.mWork);
+
+		if (sPool.mQuit) break;
+
+		Job * job = sPool.mQueue.front();
+
+		sPool.mQueue.pop_front();
+
+		if (Job::eClaimed == job->mState)
+		{
+			delete job;
+
+			continue;
+		}
+
+		job->mState = Job::eRunning;
+
+		Unlock();
+
+		Compile(L, job);
+
+		Lock();
+
+		// A job dropped while it ran is no longer in the map, so it falls to the worker to free.
+		if (Job::eClaimed == job->mState) delete job;
+
+		else
+		{
+			job->mState = Job::eDone;
+
+			WakeAll(sPool.mDone);
+		}
+	}
+
+	Unlock();
+
+	lua_close(L);
+}
+
+#ifdef _WIN32
+	static DWORD WINAPI ThreadProc (LPVOID) { Work(); return 0; }
+#else
+	static void * ThreadProc (void *) { Work(); return 0; }
+#endif
+
+// @brief Queues scripts for compilation
+// @note loader: Loader the scripts will be requested through; if it is not Compiler.Loader, or the
+// compiler is not running, nothing is queued
+// @note names: Array of script names; scripts already queued or loaded are skipped, as are any that
+// cannot be read, which the loader then reports on, or that the bytecode cache already holds
+// @note The scripts are read here, on the main thread, and only their text goes to the workers
+static int Prefetch (lua_State * L)
+{
+	if (!sPool.mRunning || lua_tocfunction(L, 1) != Compiler::Loader) return 0;
+
+	// Gather the names first, since a bad one raises an error.
+	std::vector<std::string> names(GetN(L, 2));
+
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		lua_rawgeti(L, 2, int(i + 1));	// loader, names, name
+
+		names[i] = S(L, -1);
+
+		lua_pop(L, 1);	// loader, names
+	}
+
+	Lock();
+
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		if (sPool.mJobs.count(names[i]) != 0 || sPool.mLoaded.count(names[i]) != 0) continue;
+
+		// Read the script without holding the lock, so workers keep going meanwhile.
+		Unlock();
+
+		Job * job = new Job;
+
+		job->mName = names[i];
+		job->mState = Job::eQueued;
+		job->mOK = false;
+
+		bool bRead = ReadSource(names[i].c_str(), job->mSource);
+
+		// A cached script loads as fast from the cache, so leave it to the loader.
+		if (bRead) bRead = !FindBytecode(job->mSource.data(), job->mSource.size(), names[i].c_str(), job->mHeader);
+
+		Lock();
+
+		if (!bRead) delete job;
+
+		else
+		{
+			sPool.mJobs[names[i]] = job;
+			sPool.mQueue.push_back(job);
+
+			WakeAll(sPool.mWork);
+		}
+	}
+
+	Unlock();
+
+	return 0;
+}
+
+namespace Lua
+{
+	// @brief Starts the worker pool
+	// @param workers Worker count; if 0, one fewer than the processor count
+	// @return If true, the pool is running
+	bool Compiler::Start (uInt workers)
+	{
+		if (sPool.mRunning) return true;
+
+		if (0 == workers)
+		{
+		#ifdef _WIN32
+			SYSTEM_INFO info;
+
+			GetSystemInfo(&info);
+
+			workers = uInt(info.dwNumberOfProcessors);
+		#else
+			long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+			workers = count > 0 ? uInt(count) : 1;
+		#endif
+
+			if (workers > 1) --workers;
+		}
+
+	#ifdef _WIN32
+		InitializeCriticalSection(&sPool.mLock);
+		InitializeConditionVariable(&sPool.mWork);
+		InitializeConditionVariable(&sPool.mDone);
+	#else
+		pthread_mutex_init(&sPool.mLock, 0);
+		pthread_cond_init(&sPool.mWork, 0);
+		pthread_cond_init(&sPool.mDone, 0);
+	#endif
+
+		sPool.mQuit = false;
+
+		for (uInt i = 0; i < workers; ++i)
+		{
+		#ifdef _WIN32
+			HANDLE thread = CreateThread(0, 0, ThreadProc, 0, 0, 0);
+
+			if (thread != 0) sPool.mThreads.push_back(thread);
+		#else
+			pthread_t thread;
+
+			if (0 == pthread_create(&thread, 0, ThreadProc, 0)) sPool.mThreads.push_back(thread);
+		#endif
+		}
+
+		sPool.mRunning = true;
+
+		if (sPool.mThreads.empty()) Stop();
+
+		return sPool.mRunning;
+	}
+
+	// @brief Stops the worker pool, dropping any unconsumed jobs
+	void Compiler::Stop (void)
+	{
+		if (!sPool.mRunning) return;
+
+		Lock();
+
+		sPool.mQuit = true;
+
+		WakeAll(sPool.mWork);
+
+		Unlock();
+
+		for (size_t i = 0; i < sPool.mThreads.size(); ++i)
+		{
+		#ifdef _WIN32
+			WaitForSingleObject(sPool.mThreads[i], INFINITE);
+			CloseHandle(sPool.mThreads[i]);
+		#else
+			pthread_join(sPool.mThreads[i], 0);
+		#endif
+		}
+
+		// Claimed jobs live only in the queue; the rest are all in the map.
+		for (std::deque<Job *>::iterator iter = sPool.mQueue.begin(); iter != sPool.mQueue.end(); ++iter)
+		{
+			if (Job::eClaimed == (*iter)->mState) delete *iter;
+		}
+
+		for (std::map<std::string, Job *>::iterator iter = sPool.mJobs.begin(); iter != sPool.mJobs.end(); ++iter) delete iter->second;
+
+		sPool.mThreads.clear();
+		sPool.mQueue.clear();
+		sPool.mJobs.clear();
+		sPool.mLoaded.clear();
+
+	#ifdef _WIN32
+		DeleteCriticalSection(&sPool.mLock);
+	#else
+		pthread_cond_destroy(&sPool.mDone);
+		pthread_cond_destroy(&sPool.mWork);
+		pthread_mutex_destroy(&sPool.mLock);
+	#endif
+
+		sPool.mRunning = false;
+	}
+
+	// @brief Drops any unconsumed jobs, e.g. once a boot tree is loaded, and forgets which scripts
+	// were loaded, so that they may be prefetched again
+	// @note Jobs a worker is busy on are left for it to free
+	void Compiler::Drop (void)
+	{
+		if (!sPool.mRunning) return;
+
+		Lock();
+
+		for (std::map<std::string, Job *>::iterator iter = sPool.mJobs.begin(); iter != sPool.mJobs.end(); ++iter)
+		{
+			if (Job::eDone == iter->second->mState) delete iter->second;
+
+			else iter->second->mState = Job::eClaimed;
+		}
+
+		sPool.mJobs.clear();
+		sPool.mLoaded.clear();
+
+		Unlock();
+	}
+
+	// @brief Indicates whether the worker pool is running
+	bool Compiler::IsRunning (void)
+	{
+		return sPool.mRunning;
+	}
+
+	// @brief Loader: takes a prefetched script's bytecode, waiting for it if a worker is busy on it
+	// @note name: Script name
+	// @return Chunk, or nil and an error message
+	// @note Scripts that were never prefetched, or that no worker has started on yet, are compiled
+	// here instead, via FM_Loader; bytecode from the workers is stored into the bytecode cache, when
+	// that is writable
+	int Compiler::Loader (lua_State * L)
+	{
+		if (!sPool.mRunning) return FM_Loader(L);
+
+		std::string name = S(L, 1);
+		Job * job = 0;
+
+		Lock();
+
+		std::map<std::string, Job *>::iterator iter = sPool.mJobs.find(name);
+
+		if (iter != sPool.mJobs.end())
+		{
+			job = iter->second;
+
+			sPool.mJobs.erase(iter);
+			sPool.mLoaded.insert(name);
+
+			if (Job::eQueued == job->mState)
+			{
+				job->mState = Job::eClaimed;
+				job = 0;
+			}
+
+			else while (job->mState != Job::eDone) Wait(sPool.mDone);
+		}
+
+		Unlock();
+
+		if (0 == job) return FM_Loader(L);
+
+		// Load the bytecode, which keeps the script's name for debug info.
+		int result = job->mOK ? luaL_loadbuffer(L, job->mResult.data(), job->mResult.size(), name.c_str()) : -1;	// name[, chunk / error]
+
+		if (0 == result) StoreBytecode(job->mHeader, job->mResult);
+
+		if (result != 0)
+		{
+			if (result < 0) lua_pushlstring(L, job->mResult.data(), job->mResult.size());	// name, error
+
+			lua_pushnil(L);	// name, error, nil
+			lua_insert(L, -2);	// name, nil, error
+		}
+
+		delete job;
+
+		return result != 0 ? 2 : 1;
+	}
+}
+
+// @brief Opens the compiler_core library
+// @param L Lua state
+// @return 0
+// @note Load scripts look this up to prefetch the scripts a boot tree names
+int Bindings::open_compiler (lua_State * L)
+{
+	luaL_reg funcs[] = {
+		{ "Prefetch", Prefetch },
+		{ 0, 0 }
+	};
+
+	Register(L, "compiler_core", funcs);
+
+	return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef LUA_COMPILER_H
+#define LUA_COMPILER_H
+
+#include "AppTypes.h"
+
+struct lua_State;
+
+namespace Lua
+{
+	// @brief Parallel script compilation: scripts named ahead of time are compiled on worker
+	// threads, each with its own scratch Lua state, and handed over as bytecode
+	// @note The main thread reads the scripts, from the packs or the file manager, and workers
+	// only compile the text, so neither needs to be thread-safe; prefetched scripts do not go
+	// through the bytecode cache
+	namespace Compiler
+	{
+		bool Start (uInt workers = 0);
+		void Stop (void);
+		void Drop (void);
+
+		bool IsRunning (void);
+
+		int Loader (lua_State * L);
+	}
+}
+
+#endif // LUA_COMPILER_H
@@ -0,0 +1,378 @@
+#ifndef LUA_CONTAINERS_H
+#define LUA_CONTAINERS_H
+
+#include <new>
+#include <string>
+#include <vector>
+#include "AppTypes.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include "Lua_/Templates.h"
+
+namespace Lua
+{
+	/*%%%%%%%%%%%%%%%% ELEMENT CONVERSIONS %%%%%%%%%%%%%%%%*/
+
+	// @brief Element conversions (bound class version); elements are pushed as copies (q.v. _copyT)
+	template<typename T> struct _elementT {
+		static void Push (lua_State * L, T const & t)
+		{
+			Lua_Class_New(L, _typeT<T>(), "u", &t);	// ..., t
+		}
+
+		static T Get (lua_State * L, int index)
+		{
+			return *_pT<T>(L, index);
+		}
+	};
+
+	// @brief Element conversions (number version)
+	template<typename T> struct _numberelementT {
+		static void Push (lua_State * L, T t)
+		{
+			lua_pushnumber(L, lua_Number(t));	// ..., t
+		}
+
+		static T Get (lua_State * L, int index)
+		{
+			return T(luaL_checknumber(L, index));
+		}
+	};
+
+	template<> struct _elementT<sChar> : _numberelementT<sChar> {};
+	template<> struct _elementT<sShort> : _numberelementT<sShort> {};
+	template<> struct _elementT<sLong> : _numberelementT<sLong> {};
+	template<> struct _elementT<sInt> : _numberelementT<sInt> {};
+	template<> struct _elementT<uChar> : _numberelementT<uChar> {};
+	template<> struct _elementT<uShort> : _numberelementT<uShort> {};
+	template<> struct _elementT<uLong> : _numberelementT<uLong> {};
+	template<> struct _elementT<uInt> : _numberelementT<uInt> {};
+	template<> struct _elementT<float> : _numberelementT<float> {};
+	template<> struct _elementT<double> : _numberelementT<double> {};
+
+	// @brief Element conversions (boolean version)
+	template<> struct _elementT<bool> {
+		static void Push (lua_State * L, bool b)
+		{
+			lua_pushboolean(L, b);	// ..., b
+		}
+
+		static bool Get (lua_State * L, int index)
+		{
+			return lua_toboolean(L, index) != 0;
+		}
+	};
+
+	// @brief Element conversions (string version)
+	template<> struct _elementT<std::string> {
+		static void Push (lua_State * L, std::string const & str)
+		{
+			lua_pushlstring(L, str.data(), str.length());	// ..., str
+		}
+
+		static std::string Get (lua_State * L, int index)
+		{
+			size_t len;
+			char const * str = luaL_checklstring(L, index, &len);
+
+			return std::string(str, len);
+		}
+	};
+
+	/*%%%%%%%%%%%%%%%% CONTAINERS %%%%%%%%%%%%%%%%*/
+
+	// @brief Span of elements, of fixed count
+	template<typename T> struct Span {
+		typedef T Element;
+
+		T * mData;	// Elements
+		size_t mCount;	// Element count
+
+		size_t Size (void) const { return mCount; }
+		T & At (size_t i) const { return mData[i]; }
+
+		// @brief Spans cannot grow
+		bool Resize (size_t) const { return false; }
+	};
+
+	// @brief Reference to a vector, which may grow
+	template<typename T> struct VectorRef {
+		typedef T Element;
+
+		std::vector<T> * mVector;	// Referenced vector
+
+		size_t Size (void) const { return mVector->size(); }
+		T & At (size_t i) const { return (*mVector)[i]; }
+
+		bool Resize (size_t count) const
+		{
+			mVector->resize(count);
+
+			return true;
+		}
+	};
+
+	// @brief Templated container metatable key
+	template<typename C> void * _containerkeyT (void)
+	{
+		static int sKey;
+
+		return &sKey;
+	}
+
+	// @brief Templated container accessor
+	// @note The metatable is checked under every policy, since any other userdata would be misread
+	template<typename C> C const * _containerT (lua_State * L, int index)
+	{
+		void * ud = lua_touserdata(L, index);
+
+		if (ud != 0 && lua_getmetatable(L, index))	// ..., meta
+		{
+			lua_pushlightuserdata(L, _containerkeyT<C>());	// ..., meta, key
+			lua_rawget(L, LUA_REGISTRYINDEX);	// ..., meta, cmeta
+
+			bool bMatch = lua_rawequal(L, -1, -2) != 0;
+
+			lua_pop(L, 2);	// ...
+
+			if (bMatch) return static_cast<C const *>(ud);
+		}
+
+		luaL_typerror(L, index, "container");
+
+		return 0;
+	}
+
+	// @brief Templated container __index metamethod
+	// @note _U1: Method table
+	// @note C: Container being accessed
+	// @note key: Element index or method name
+	template<typename C> int _containerindexT (lua_State * L)
+	{
+		C const * container = _containerT<C>(L, 1);
+
+		if (lua_type(L, 2) == LUA_TNUMBER)
+		{
+			lua_Integer index = lua_tointeger(L, 2);
+
+			if (index >= 1 && size_t(index) <= container->Size()) _elementT<typename C::Element>::Push(L, container->At(size_t(index - 1)));	// C, key, element
+
+			else lua_pushnil(L);// C, key, nil
+
+			return 1;
+		}
+
+		lua_pushvalue(L, 2);// C, key, key
+		lua_rawget(L, lua_upvalueindex(1));	// C, key, method
+
+		return 1;
+	}
+
+	// @brief Templated container __newindex metamethod; growable containers may append at #C + 1
+	// @note C: Container being accessed
+	// @note key: Element index
+	// @note value: Value to assign
+	template<typename C> int _containernewindexT (lua_State * L)
+	{
+		C const * container = _containerT<C>(L, 1);
+		lua_Integer index = luaL_checkinteger(L, 2);
+		size_t count = container->Size();
+
+		// Bounds are checked under every policy, since a bad index would write out of bounds.
+		if (index < 1 || size_t(index) > count + 1 || (size_t(index) == count + 1 && !container->Resize(count + 1))) luaL_error(L, "Container: Index %d out of bounds", int(index));
+
+		container->At(size_t(index - 1)) = _elementT<typename C::Element>::Get(L, 3);
+
+		return 0;
+	}
+
+	// @brief Templated container __len metamethod
+	// @note C: Container being accessed
+	template<typename C> int _containerlenT (lua_State * L)
+	{
+		lua_pushinteger(L, lua_Integer(_containerT<C>(L, 1)->Size()));	// C, count
+
+		return 1;
+	}
+
+	// @brief Templated container iterator, as per ipairs
+	// @note C: Container being iterated
+	// @note i: Previous index
+	// @return Next index and element, or nothing when done
+	template<typename C> int _containernextT (lua_State * L)
+	{
+		C const * container = _containerT<C>(L, 1);
+		size_t i = size_t(lua_tointeger(L, 2));
+
+		if (i >= container->Size()) return 0;
+
+		lua_pushinteger(L, lua_Integer(i + 1));	// C, i, i + 1
+		_elementT<typename C::Element>::Push(L, container->At(i));	// C, i, i + 1, element
+
+		return 2;
+	}
+
+	// @brief Templated container ipairs method; the iterator is shared, so no closure is built per loop
+	// @note _U1: Iterator
+	// @note C: Container to iterate
+	// @return Iterator, container, 0
+	template<typename C> int _containeripairsT (lua_State * L)
+	{
+		lua_pushvalue(L, lua_upvalueindex(1));	// C, next
+		lua_pushvalue(L, 1);// C, next, C
+		lua_pushinteger(L, 0);	// C, next, C, 0
+
+		return 3;
+	}
+
+	// @brief Copies elements into a new table, presized to fit
+	// @param container Container to copy
+	template<typename C> void _containertotableT (lua_State * L, C const & container)
+	{
+		size_t count = container.Size();
+
+		lua_createtable(L, int(count), 0);	// ..., t
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			_elementT<typename C::Element>::Push(L, container.At(i));	// ..., t, element
+
+			lua_rawseti(L, -2, int(i + 1));	// ..., t = { ..., element }
+		}
+	}
+
+	// @brief Copies a table's array part into a container; growable containers are sized once to fit
+	// @param container Container to fill
+	// @param index Table stack index
+	template<typename C> void _containerfromtableT (lua_State * L, C const & container, int index)
+	{
+		IndexAbsolute(L, index);
+
+		luaL_checktype(L, index, LUA_TTABLE);
+
+		size_t n = lua_objlen(L, index);
+
+		if (n > container.Size() && !container.Resize(n)) luaL_error(L, "Container: %d elements given, %d available", int(n), int(container.Size()));
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			lua_rawgeti(L, index, int(i + 1));	// ..., t[i + 1]
+
+			container.At(i) = _elementT<typename C::Element>::Get(L, -1);
+
+			lua_pop(L, 1);	// ...
+		}
+	}
+
+	// @brief Templated container toTable method
+	// @note C: Container being accessed
+	// @return Table
+	template<typename C> int _containertotablemT (lua_State * L)
+	{
+		_containertotableT(L, *_containerT<C>(L, 1));	// C, t
+
+		return 1;
+	}
+
+	// @brief Templated container fromTable method
+	// @note C: Container being accessed
+	// @note t: Table of elements
+	template<typename C> int _containerfromtablemT (lua_State * L)
+	{
+		_containerfromtableT(L, *_containerT<C>(L, 1), 2);
+
+		return 0;
+	}
+
+	// @brief Pushes a container userdata
+	// @param container Container to push
+	// @param anchor Stack index of owner to keep alive while the container is referenced (0 for none)
+	// @note The metatable is built on first use, and shared by all containers of type C
+	template<typename C> void _pushcontainerT (lua_State * L, C const & container, int anchor)
+	{
+		IndexAbsolute(L, anchor);
+
+		new (lua_newuserdata(L, sizeof(C))) C(container);	// ..., C
+
+		// Install the shared metatable, building it on first use.
+		lua_pushlightuserdata(L, _containerkeyT<C>());	// ..., C, key
+		lua_rawget(L, LUA_REGISTRYINDEX);	// ..., C, meta?
+
+		if (lua_isnil(L, -1))
+		{
+			lua_pop(L, 1);	// ..., C
+			lua_createtable(L, 0, 3);	// ..., C, meta
+			lua_createtable(L, 0, 3);	// ..., C, meta, methods
+			lua_pushcfunction(L, _containertotablemT<C>);	// ..., C, meta, methods, toTable
+			lua_setfield(L, -2, "toTable");	// ..., C, meta, methods = { toTable }
+			lua_pushcfunction(L, _containerfromtablemT<C>);	// ..., C, meta, methods, fromTable
+			lua_setfield(L, -2, "fromTable");	// ..., C, meta, methods = { toTable, fromTable }
+			lua_pushcfunction(L, _containernextT<C>);	// ..., C, meta, methods, next
+			lua_pushcclosure(L, _containeripairsT<C>, 1);	// ..., C, meta, methods, ipairs
+			lua_setfield(L, -2, "ipairs");	// ..., C, meta, methods = { toTable, fromTable, ipairs }
+			lua_pushcclosure(L, _containerindexT<C>, 1);// ..., C, meta, __index
+			lua_setfield(L, -2, "__index");	// ..., C, meta = { __index }
+			lua_pushcfunction(L, _containernewindexT<C>);	// ..., C, meta, __newindex
+			lua_setfield(L, -2, "__newindex");	// ..., C, meta = { __index, __newindex }
+			lua_pushcfunction(L, _containerlenT<C>);// ..., C, meta, __len
+			lua_setfield(L, -2, "__len");	// ..., C, meta = { __index, __newindex, __len }
+			lua_pushlightuserdata(L, _containerkeyT<C>());	// ..., C, meta, key
+			lua_pushvalue(L, -2);	// ..., C, meta, key, meta
+			lua_rawset(L, LUA_REGISTRYINDEX);	// ..., C, meta
+		}
+
+		lua_setmetatable(L, -2);// ..., C
+
+		// Anchor the owner in the container's environment.
+		if (anchor != 0)
+		{
+			lua_createtable(L, 1, 0);	// ..., C, env
+			lua_pushvalue(L, anchor);	// ..., C, env, owner
+			lua_rawseti(L, -2, 1);	// ..., C, env = { owner }
+			lua_setfenv(L, -2);	// ..., C
+		}
+	}
+
+	// @brief Pushes a span of elements as a container userdata
+	// @param data Elements; the memory must outlive the container
+	// @param count Element count
+	// @param anchor Stack index of owner to keep alive while the container is referenced (0 for none)
+	template<typename T> void _pushspanT (lua_State * L, T * data, size_t count, int anchor = 0)
+	{
+		Span<T> span = { data, count };
+
+		_pushcontainerT(L, span, anchor);	// ..., span
+	}
+
+	// @brief Pushes a vector reference as a container userdata
+	// @param vec Vector; it must outlive the container
+	// @param anchor Stack index of owner to keep alive while the container is referenced (0 for none)
+	template<typename T> void _pushvectorT (lua_State * L, std::vector<T> & vec, int anchor = 0)
+	{
+		VectorRef<T> ref = { &vec };
+
+		_pushcontainerT(L, ref, anchor);// ..., vector
+	}
+
+	// @brief Copies a vector into a new table, presized to fit
+	template<typename T> void _vectortotableT (lua_State * L, std::vector<T> & vec)
+	{
+		VectorRef<T> ref = { &vec };
+
+		_containertotableT(L, ref);	// ..., t
+	}
+
+	// @brief Copies a table's array part into a vector, resized to fit
+	// @param index Table stack index
+	template<typename T> void _tabletovectorT (lua_State * L, int index, std::vector<T> & vec)
+	{
+		VectorRef<T> ref = { &vec };
+
+		vec.clear();
+
+		_containerfromtableT(L, ref, index);
+	}
+}
+
+#endif // LUA_CONTAINERS_H
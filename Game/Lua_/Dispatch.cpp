@@ -0,0 +1,128 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+
+using namespace Lua;
+
+// @brief Dummy variable; class.Type is cached under its address
+static int _Type;
+
+// @brief Dummy variable; class.Hidden is cached under its address
+static int _Hidden;
+
+// @brief Pushes the type of an argument, as per class.Type
+// @param arg Argument stack index
+// @return If true, the type is hidden
+// @note All hidden classes share the hidden type value, so it says nothing about which function
+// applies, and calls with hidden arguments are never cached
+static bool PushType (lua_State * L, int arg)
+{
+	CacheAndGet(L, "class.Type", &_Type);	// ..., class.Type
+	lua_pushvalue(L, arg);	// ..., class.Type, arg
+	lua_call(L, 1, 1);	// ..., type
+	CacheAndGet(L, "class.Hidden", &_Hidden);	// ..., type, class.Hidden
+
+	bool bHidden = lua_rawequal(L, -2, -1) != 0;
+
+	lua_pop(L, 1);	// ..., type
+
+	return bHidden;
+}
+
+// @brief Looks up the function cached for a set of argument types
+// @note cache: Dispatch cache, a tree of tables keyed by argument type
+// @note paramc: Count of dispatch-relevant parameters
+// @note ...: Call arguments
+// @return Function, or nil if not cached (always, if an argument's type is hidden)
+static int Lookup (lua_State * L)
+{
+	int paramc = sI(L, 2);
+
+	// Missing arguments are typed as nil.
+	if (lua_gettop(L) < paramc + 2) lua_settop(L, paramc + 2);	// cache, paramc, ...
+
+	lua_pushvalue(L, 1);// cache, paramc, ..., node
+
+	for (int i = 1; i <= paramc && !lua_isnil(L, -1); ++i)
+	{
+		if (PushType(L, i + 2)) lua_pushnil(L);	// cache, paramc, ..., node, hidden, nil
+
+		else lua_rawget(L, -2);	// cache, paramc, ..., node, node[type]
+
+		lua_replace(L, -2);	// cache, paramc, ..., node[type] / nil
+	}
+
+	return 1;
+}
+
+// @brief Caches the function resolved for a set of argument types
+// @note cache: Dispatch cache
+// @note paramc: Count of dispatch-relevant parameters
+// @note func: Resolved function
+// @note ...: Call arguments
+static int Store (lua_State * L)
+{
+	int paramc = sI(L, 2);
+
+	if (lua_gettop(L) < paramc + 3) lua_settop(L, paramc + 3);	// cache, paramc, func, ...
+
+	// Leave calls with hidden argument types uncached.
+	for (int i = 1; i <= paramc; ++i)
+	{
+		bool bHidden = PushType(L, i + 3);	// cache, paramc, func, ..., type
+
+		lua_pop(L, 1);	// cache, paramc, func, ...
+
+		if (bHidden) return 0;
+	}
+
+	lua_pushvalue(L, 1);// cache, paramc, func, ..., node
+
+	// Walk the types down the tree, adding missing levels.
+	for (int i = 1; i < paramc; ++i)
+	{
+		PushType(L, i + 3);	// cache, paramc, func, ..., node, type
+		lua_pushvalue(L, -1);	// cache, paramc, func, ..., node, type, type
+		lua_rawget(L, -3);	// cache, paramc, func, ..., node, type, node[type]
+
+		if (lua_isnil(L, -1))
+		{
+			lua_pop(L, 1);	// cache, paramc, func, ..., node, type
+			lua_newtable(L);// cache, paramc, func, ..., node, type, {}
+			lua_pushvalue(L, -1);	// cache, paramc, func, ..., node, type, {}, {}
+			lua_insert(L, -4);	// cache, paramc, func, ..., {}, node, type, {}
+			lua_rawset(L, -3);	// cache, paramc, func, ..., {}, node = { ..., type = {} }
+			lua_pop(L, 1);	// cache, paramc, func, ..., {}
+		}
+
+		else
+		{
+			lua_replace(L, -3);	// cache, paramc, func, ..., node[type], type
+			lua_pop(L, 1);	// cache, paramc, func, ..., node[type]
+		}
+	}
+
+	// Install the function at the leaf.
+	PushType(L, paramc + 3);// cache, paramc, func, ..., node, type
+	lua_pushvalue(L, 3);// cache, paramc, func, ..., node, type, func
+	lua_rawset(L, -3);	// cache, paramc, func, ..., node = { ..., type = func }
+
+	return 0;
+}
+
+// @brief Registers the multimethod dispatch cache
+// @param L Lua state
+// @return 0
+int Bindings::open_dispatch (lua_State * L)
+{
+	luaL_reg funcs[] = {
+		{ "Lookup", Lookup },
+		{ "Store", Store },
+		{ 0, 0 }
+	};
+
+	Register(L, "dispatch_core", funcs);
+
+	return 0;
+}
@@ -0,0 +1,324 @@
+#include "Lua_/Finalizers.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#include <intrin.h>
+
+	// On x86, a single-producer, single-consumer queue only needs compiler ordering.
+	#define FENCE() _ReadWriteBarrier()
+#else
+	#include <time.h>
+
+	#define FENCE() __sync_synchronize()
+#endif
+
+// @brief Pending finalizer
+struct PendingFinalizer {
+	void * mObject;	// Object to finalize
+	Lua::Finalizers::Func mFunc;// Finalizer
+};
+
+// @brief Single-producer, single-consumer ring of pending finalizers
+struct Lua::Finalizers::Queue {
+	enum { eSize = 4096 };	// Capacity (power of 2)
+
+	PendingFinalizer mEntries[eSize];	// Ring storage
+	uInt volatile mHead;// Next entry to drain (written by consumer)
+	uInt volatile mTail;// Next entry to fill (written by producer)
+	bool mClaimed;	// If true, drained by another thread
+	bool mClosed;	// If true, state is closing: finalize immediately
+};
+
+using namespace Lua;
+
+// @brief Dummy variable; the state's queues are stored in the registry under its address
+static int _Queues;
+
+// @brief Gets the current time on a monotonic clock
+// @return Time, in seconds
+static double Now (void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER count, frequency;
+
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&frequency);
+
+	return double(count.QuadPart) / double(frequency.QuadPart);
+#else
+	timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+// @brief Takes the oldest pending finalizer
+// @param queue Queue
+// @param entry [out] Receives finalizer
+// @return If true, an entry was available
+static bool Pop (Finalizers::Queue * queue, PendingFinalizer & entry)
+{
+	uInt head = queue->mHead;
+
+	if (head == queue->mTail) return false;
+
+	FENCE();
+
+	entry = queue->mEntries[head & (Finalizers::Queue::eSize - 1)];
+
+	FENCE();
+
+	queue->mHead = head + 1;
+
+	return true;
+}
+
+// @brief Queue __gc: runs whatever is still pending when the state closes
+static int CloseQueue (lua_State * L)
+{
+	Finalizers::Queue * queue = (Finalizers::Queue *)lua_touserdata(L, 1);
+
+	Finalizers::Drain(queue);
+
+	// Objects collected later in the close, e.g. instances created before the queue, are
+	// finalized on the spot.
+	queue->mClosed = true;
+
+	return 0;
+}
+
+// @brief Pushes the state's queue table, creating it if necessary
+// @note Defer runs inside __gc, where any allocation may step the collector and run other finalizers,
+// which may get here too; whatever is found in the registry after allocating is what gets used
+static void PushQueues (lua_State * L)
+{
+	lua_pushlightuserdata(L, &_Queues);	// ..., key
+	lua_rawget(L, LUA_REGISTRYINDEX);	// ..., queues?
+
+	if (lua_isnil(L, -1))
+	{
+		lua_pop(L, 1);	// ...
+		lua_newtable(L);// ..., new
+		lua_pushlightuserdata(L, &_Queues);	// ..., new, key
+		lua_rawget(L, LUA_REGISTRYINDEX);	// ..., new, queues?
+
+		if (lua_isnil(L, -1))
+		{
+			lua_pop(L, 1);	// ..., new
+			lua_pushlightuserdata(L, &_Queues);	// ..., new, key
+			lua_pushvalue(L, -2);	// ..., new, key, new
+			lua_rawset(L, LUA_REGISTRYINDEX);	// ..., queues
+		}
+
+		else lua_remove(L, -2);	// ..., queues
+	}
+}
+
+// @brief Gets a finalizer's queue, creating it if necessary
+// @param L Lua state
+// @param func Finalizer
+// @return Queue
+// @note As with PushQueues, the queue is looked up again after allocating it, and stored before anything
+// else is allocated
+static Finalizers::Queue * GetQueue (lua_State * L, Finalizers::Func func)
+{
+	PushQueues(L);	// ..., queues
+
+	lua_pushlightuserdata(L, (void *)func);	// ..., queues, func
+	lua_rawget(L, -2);	// ..., queues, queue?
+
+	Finalizers::Queue * queue = (Finalizers::Queue *)lua_touserdata(L, -1);
+
+	if (0 == queue)
+	{
+		lua_pop(L, 1);	// ..., queues
+
+		Finalizers::Queue * fresh = (Finalizers::Queue *)lua_newuserdata(L, sizeof(Finalizers::Queue));	// ..., queues, fresh
+
+		lua_pushlightuserdata(L, (void *)func);	// ..., queues, fresh, func
+		lua_rawget(L, -3);	// ..., queues, fresh, queue?
+
+		queue = (Finalizers::Queue *)lua_touserdata(L, -1);
+
+		if (0 == queue)
+		{
+			queue = fresh;
+
+			queue->mHead = queue->mTail = 0;
+			queue->mClaimed = queue->mClosed = false;
+
+			lua_pop(L, 1);	// ..., queues, queue
+			lua_pushlightuserdata(L, (void *)func);	// ..., queues, queue, func
+			lua_pushvalue(L, -2);	// ..., queues, queue, func, queue
+			lua_rawset(L, -4);	// ..., queues = { ..., [func] = queue }, queue
+			lua_createtable(L, 0, 1);	// ..., queues, queue, meta
+			lua_pushcfunction(L, CloseQueue);	// ..., queues, queue, meta, CloseQueue
+			lua_setfield(L, -2, "__gc");// ..., queues, queue, meta = { __gc = CloseQueue }
+			lua_setmetatable(L, -2);// ..., queues, queue
+		}
+
+		else lua_remove(L, -2);	// ..., queues, queue
+	}
+
+	lua_pop(L, 2);	// ...
+
+	return queue;
+}
+
+namespace Lua
+{
+	// @brief Queues an object for finalization
+	// @param L Lua state
+	// @param object Object to finalize
+	// @param func Finalizer, called with object on drain
+	// @note If the queue is full, or the state is closing, the object is finalized immediately
+	void Finalizers::Defer (lua_State * L, void * object, Func func)
+	{
+		Queue * queue = GetQueue(L, func);
+		uInt tail = queue->mTail;
+
+		if (queue->mClosed || tail - queue->mHead == Queue::eSize) func(object);
+
+		else
+		{
+			PendingFinalizer & entry = queue->mEntries[tail & (Queue::eSize - 1)];
+
+			entry.mObject = object;
+			entry.mFunc = func;
+
+			FENCE();
+
+			queue->mTail = tail + 1;
+		}
+	}
+
+	// @brief Hands a finalizer's queue over to another thread, e.g. a worker for a type whose finalizers
+	// are thread-safe; Drain(L) will then skip it
+	// @param L Lua state
+	// @param func Finalizer
+	// @return Queue, valid until the state is closed
+	Finalizers::Queue * Finalizers::Claim (lua_State * L, Func func)
+	{
+		Queue * queue = GetQueue(L, func);
+
+		queue->mClaimed = true;
+
+		return queue;
+	}
+
+	// @brief Runs the state's unclaimed pending finalizers until they are done or the budget is spent
+	// @param L Lua state
+	// @param budget Time budget, in seconds
+	// @return Count of objects finalized
+	uInt Finalizers::Drain (lua_State * L, double budget)
+	{
+		double deadline = Now() + budget;
+		uInt count = 0;
+
+		PushQueues(L);	// ..., queues
+
+		for (lua_pushnil(L); lua_next(L, -2) != 0; lua_pop(L, 1))
+		{
+			Queue * queue = (Queue *)lua_touserdata(L, -1);
+
+			if (queue->mClaimed) continue;
+
+			for (PendingFinalizer entry; Pop(queue, entry); )
+			{
+				entry.mFunc(entry.mObject);
+
+				// Consult the clock every few finalizers.
+				if (++count % 16 == 0 && Now() >= deadline)
+				{
+					lua_pop(L, 3);	// ...
+
+					return count;
+				}
+			}
+		}
+
+		lua_pop(L, 1);	// ...
+
+		return count;
+	}
+
+	// @brief Runs all of the state's unclaimed pending finalizers
+	// @param L Lua state
+	// @return Count of objects finalized
+	uInt Finalizers::Drain (lua_State * L)
+	{
+		uInt count = 0;
+
+		PushQueues(L);	// ..., queues
+
+		for (lua_pushnil(L); lua_next(L, -2) != 0; lua_pop(L, 1))
+		{
+			Queue * queue = (Queue *)lua_touserdata(L, -1);
+
+			if (!queue->mClaimed) count += Drain(queue);
+		}
+
+		lua_pop(L, 1);	// ...
+
+		return count;
+	}
+
+	// @brief Runs a queue's pending finalizers until it is empty or the budget is spent
+	// @param queue Queue
+	// @param budget Time budget, in seconds
+	// @return Count of objects finalized
+	uInt Finalizers::Drain (Queue * queue, double budget)
+	{
+		double deadline = Now() + budget;
+		uInt count = 0;
+
+		for (PendingFinalizer entry; Pop(queue, entry); )
+		{
+			entry.mFunc(entry.mObject);
+
+			// Consult the clock every few finalizers.
+			if (++count % 16 == 0 && Now() >= deadline) break;
+		}
+
+		return count;
+	}
+
+	// @brief Runs all of a queue's pending finalizers
+	// @param queue Queue
+	// @return Count of objects finalized
+	uInt Finalizers::Drain (Queue * queue)
+	{
+		uInt count = 0;
+
+		for (PendingFinalizer entry; Pop(queue, entry); ++count) entry.mFunc(entry.mObject);
+
+		return count;
+	}
+
+	// @brief Gets the count of the state's pending finalizers, claimed queues included
+	// @param L Lua state
+	// @return Count
+	uInt Finalizers::Pending (lua_State * L)
+	{
+		uInt count = 0;
+
+		PushQueues(L);	// ..., queues
+
+		for (lua_pushnil(L); lua_next(L, -2) != 0; lua_pop(L, 1)) count += Pending((Queue *)lua_touserdata(L, -1));
+
+		lua_pop(L, 1);	// ...
+
+		return count;
+	}
+
+	// @brief Gets the count of a queue's pending finalizers
+	// @param queue Queue
+	// @return Count
+	uInt Finalizers::Pending (Queue * queue)
+	{
+		return queue->mTail - queue->mHead;
+	}
+}
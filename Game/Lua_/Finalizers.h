@@ -0,0 +1,35 @@
+#ifndef LUA_FINALIZERS_H
+#define LUA_FINALIZERS_H
+
+#include "AppTypes.h"
+#include "Lua_/Lua.h"
+
+namespace Lua
+{
+	// @brief Deferred finalization, keeping expensive teardown out of the garbage collector
+	// @note Each Lua state has one queue per finalizer (i.e. per type, q.v. _gcT_ref_deferred), living as
+	// long as the state; closing the state runs whatever is still pending. Threading contract:
+	//	- Defer, Claim, and the lua_State overloads are called on the state's Lua thread
+	//	- each queue has a single consumer: the Lua thread, via Drain(L), unless the queue was claimed,
+	//	  in which case only the claiming thread may drain it, via the Queue overloads
+	//	- a claimed queue must not be drained once its state is closed
+	namespace Finalizers
+	{
+		typedef void (*Func)(void *);
+
+		struct Queue;
+
+		void Defer (lua_State * L, void * object, Func func);
+
+		Queue * Claim (lua_State * L, Func func);
+
+		uInt Drain (lua_State * L, double budget);
+		uInt Drain (lua_State * L);
+		uInt Drain (Queue * queue, double budget);
+		uInt Drain (Queue * queue);
+		uInt Pending (lua_State * L);
+		uInt Pending (Queue * queue);
+	}
+}
+
+#endif // LUA_FINALIZERS_H
@@ -0,0 +1,158 @@
+#ifndef LUA_HANDLES_H
+#define LUA_HANDLES_H
+
+#include <cmath>
+#include <map>
+#include <vector>
+#include "AppTypes.h"
+#include "Lua_/Lua.h"
+
+namespace Lua
+{
+	// @brief Gets a new handle table type tag, in [1, 255]
+	inline uInt NewHandleTag (void)
+	{
+		static uInt sCount;
+
+		return sCount++ % 255 + 1;
+	}
+
+	// @brief Table of generation-checked handles to objects
+	// @note Handles are numbers packing a slot index, the table's type tag, and the slot's generation;
+	// releasing an object bumps the generation, so any handles still held by scripts resolve to 0, as
+	// do handles from another type's table (tags repeat only past 255 tables)
+	template<typename T> class HandleTable {
+		// @brief Table slot
+		struct Slot {
+			T * mObject;// Object (if 0, slot is free)
+			uInt mGeneration;	// Generation, bumped on each release
+			uInt mNext;	// Next free slot
+		};
+
+		// @brief Recently acquired object, to skip the index lookup on repeat pushes
+		struct Recent {
+			T const * mObject;	// Object (if 0, entry is empty)
+			uInt mIndex;// Slot index
+		};
+
+		enum {
+			eIndexBits = 24,// Bits used by slot index
+			eTagBits = 8,	// Bits used by type tag
+			eGenerationMask = (1 << 20) - 1,// Generation wraparound mask (keeps handles exact in a double)
+			eRecentCount = 64,	// Number of recent entries (power of 2)
+			eNone = ~0U	// No slot
+		};
+
+		std::vector<Slot> mSlots;	// Slots, indexed by handle
+		std::map<T const *, uInt> mIndices;	// Object -> slot index
+		Recent mRecent[eRecentCount];	// Recent objects, by address
+		uInt mFree;	// First free slot (if eNone, none)
+		uInt mTag;	// Type tag
+
+		// @brief Packs a slot into a handle
+		lua_Number Pack (uInt index) const
+		{
+			return (lua_Number(mSlots[index].mGeneration) * (1 << eTagBits) + mTag) * (1 << eIndexBits) + index;
+		}
+
+		// @brief Gets an object's recent entry
+		Recent & GetRecent (T const * object)
+		{
+			return mRecent[(size_t(object) >> 4) & (eRecentCount - 1)];
+		}
+
+	public:
+		HandleTable (void) : mFree(eNone), mTag(NewHandleTag())
+		{
+			for (int i = 0; i < eRecentCount; ++i) mRecent[i].mObject = 0;
+		}
+
+		// @brief Gets an object's handle, assigning one if necessary
+		// @param object Object (non-0)
+		// @return Handle, or 0 if the table is full
+		lua_Number Acquire (T * object)
+		{
+			Recent & recent = GetRecent(object);
+
+			if (recent.mObject == object) return Pack(recent.mIndex);
+
+			typename std::map<T const *, uInt>::iterator iter = mIndices.find(object);
+
+			if (iter != mIndices.end())
+			{
+				recent.mObject = object;
+				recent.mIndex = iter->second;
+
+				return Pack(iter->second);
+			}
+
+			// Take a free slot, or add one if the index bits allow it.
+			uInt index = mFree;
+
+			if (index != eNone) mFree = mSlots[index].mNext;
+
+			else
+			{
+				if (mSlots.size() >= 1U << eIndexBits) return 0;
+
+				Slot slot = { 0, 0, eNone };
+
+				index = uInt(mSlots.size());
+
+				mSlots.push_back(slot);
+			}
+
+			mSlots[index].mObject = object;
+
+			mIndices[object] = index;
+
+			recent.mObject = object;
+			recent.mIndex = index;
+
+			return Pack(index);
+		}
+
+		// @brief Resolves a handle
+		// @param handle Handle
+		// @return Object, or 0 if handle is stale, invalid, or from another table
+		T * Get (lua_Number handle) const
+		{
+			lua_Number upper = std::floor(handle / (1 << eIndexBits));
+			lua_Number index = handle - upper * (1 << eIndexBits);
+			lua_Number generation = std::floor(upper / (1 << eTagBits));
+			lua_Number tag = upper - generation * (1 << eTagBits);
+
+			if (!(index >= 0 && index < lua_Number(mSlots.size())) || index != std::floor(index)) return 0;
+			if (tag != lua_Number(mTag)) return 0;
+
+			Slot const & slot = mSlots[size_t(index)];
+
+			return lua_Number(slot.mGeneration) == generation ? slot.mObject : 0;
+		}
+
+		// @brief Releases an object's handle, e.g. when the object is destroyed
+		// @param object Object
+		void Release (T const * object)
+		{
+			typename std::map<T const *, uInt>::iterator iter = mIndices.find(object);
+
+			if (iter == mIndices.end()) return;
+
+			Recent & recent = GetRecent(object);
+
+			if (recent.mObject == object) recent.mObject = 0;
+
+			Slot & slot = mSlots[iter->second];
+
+			slot.mObject = 0;
+			slot.mGeneration = (slot.mGeneration + 1) & eGenerationMask;
+			slot.mNext = mFree;
+
+			mFree = iter->second;
+
+			mIndices.erase(iter);
+		}
+	};
+}
+
+#endif // LUA_HANDLES_H
@@ -0,0 +1,467 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include <cmath>
+#include <new>
+#include <vector>
+
+using namespace Lua;
+
+// @brief Heap arity; four children per node keep the tree shallow and sift-downs cache-friendly
+static uInt const sArity = 4;
+
+// @brief Handle layout: generation * sSlotRange + slot
+static lua_Number const sSlotRange = 16777216.0;
+static uInt const sMaxGeneration = 1U << 28;
+
+// @brief Heap entry
+struct HeapEntry {
+	lua_Number mKey;// Priority; lower keys come out first
+	uInt mSlot;	// Payload slot
+};
+
+// @brief Heap instance data
+// @note Payloads are kept in the environment, indexed by slot
+struct Heap {
+	std::vector<HeapEntry> mEntries;// Entries, in heap order
+	std::vector<uInt> mPos;	// Slot -> entry position, if live; else next vacant slot (0 if none)
+	std::vector<uInt> mGeneration;	// Slot -> generation
+	uInt mFree;	// First vacant slot (if 0, none)
+
+	Heap (void) : mPos(1, 0), mGeneration(1, 0), mFree(0) {}
+
+	// @brief Resolves a handle to its entry position
+	// @param pos [out] Entry position
+	// @return If true, the handle is live
+	bool Find (lua_Number handle, uInt & pos) const
+	{
+		if (!(handle >= sSlotRange)) return false;
+
+		lua_Number gen = std::floor(handle / sSlotRange);
+		uInt slot = uInt(handle - gen * sSlotRange);
+
+		if (0 == slot || slot >= mPos.size() || mGeneration[slot] != uInt(gen)) return false;
+
+		pos = mPos[slot];
+
+		return true;
+	}
+
+	// @brief Gets a slot's handle
+	lua_Number Handle (uInt slot) const
+	{
+		return lua_Number(mGeneration[slot]) * sSlotRange + slot;
+	}
+
+	// @brief Places an entry, updating its slot's position
+	void Place (HeapEntry const & entry, uInt pos)
+	{
+		mEntries[pos] = entry;
+		mPos[entry.mSlot] = pos;
+	}
+
+	// @brief Moves an entry toward the root until its parent is no greater
+	void SiftUp (uInt pos)
+	{
+		HeapEntry entry = mEntries[pos];
+
+		while (pos > 0)
+		{
+			uInt parent = (pos - 1) / sArity;
+
+			if (!(entry.mKey < mEntries[parent].mKey)) break;
+
+			Place(mEntries[parent], pos);
+
+			pos = parent;
+		}
+
+		Place(entry, pos);
+	}
+
+	// @brief Moves an entry toward the leaves until no child is less
+	void SiftDown (uInt pos)
+	{
+		HeapEntry entry = mEntries[pos];
+		uInt count = uInt(mEntries.size());
+
+		for (;;)
+		{
+			uInt first = pos * sArity + 1, best = pos;
+			lua_Number key = entry.mKey;
+
+			for (uInt i = first; i < first + sArity && i < count; ++i)
+			{
+				if (mEntries[i].mKey < key)
+				{
+					best = i;
+					key = mEntries[i].mKey;
+				}
+			}
+
+			if (best == pos) break;
+
+			Place(mEntries[best], pos);
+
+			pos = best;
+		}
+
+		Place(entry, pos);
+	}
+
+	// @brief Claims a slot for a new entry
+	uInt Claim (void)
+	{
+		uInt slot = mFree;
+
+		if (slot != 0) mFree = mPos[slot];
+
+		else
+		{
+			slot = uInt(mPos.size());
+
+			mPos.push_back(0);
+			mGeneration.push_back(1);
+		}
+
+		return slot;
+	}
+
+	// @brief Retires a slot; bumping the generation invalidates any handles to it
+	void Retire (uInt slot)
+	{
+		if (++mGeneration[slot] == sMaxGeneration) mGeneration[slot] = 1;
+
+		mPos[slot] = mFree;
+		mFree = slot;
+	}
+
+	// @brief Removes an entry, refilling its position from the end
+	// @return Removed entry
+	HeapEntry RemoveAt (uInt pos)
+	{
+		HeapEntry entry = mEntries[pos];
+
+		Retire(entry.mSlot);
+
+		if (pos + 1 < mEntries.size())
+		{
+			Place(mEntries.back(), pos);
+
+			mEntries.pop_back();
+
+			// The filler came from a leaf, so it may need to go either way.
+			if (pos > 0 && mEntries[pos].mKey < mEntries[(pos - 1) / sArity].mKey) SiftUp(pos);
+
+			else SiftDown(pos);
+		}
+
+		else mEntries.pop_back();
+
+		return entry;
+	}
+};
+
+// @brief Gets the instance data and environment
+// @return Instance data
+// @note Pushes the environment
+static Heap * GetHeap (lua_State * L)
+{
+	Heap * H = (Heap *)UD(L, 1);
+
+	lua_getfenv(L, 1);	// H, ..., env
+
+	return H;
+}
+
+// @brief Validates a key argument
+static lua_Number GetKey (lua_State * L, int arg)
+{
+	lua_Number key = luaL_checknumber(L, arg);
+
+	luaL_argcheck(L, key == key, arg, "NaN key");
+
+	return key;
+}
+
+// @brief Pushes a removed entry's payload and key, clearing the payload
+// @param env Stack index of environment
+// @return 2 (payload and key on the stack)
+static int PushRemoved (lua_State * L, HeapEntry const & entry, int env)
+{
+	lua_rawgeti(L, env, entry.mSlot);	// ..., payload
+	lua_pushnumber(L, entry.mKey);	// ..., payload, key
+	lua_pushnil(L);	// ..., payload, key, nil
+	lua_rawseti(L, env, entry.mSlot);	// ..., payload, key
+
+	return 2;
+}
+
+// @brief Removes all entries
+// @param env Stack index of environment
+static void ClearHeap (lua_State * L, Heap * H, int env)
+{
+	for (size_t i = 0; i < H->mEntries.size(); ++i)
+	{
+		lua_pushnil(L);	// ..., nil
+		lua_rawseti(L, env, H->mEntries[i].mSlot);	// ...
+
+		H->Retire(H->mEntries[i].mSlot);
+	}
+
+	H->mEntries.clear();
+}
+
+// @brief Removes all entries
+static int Clear (lua_State * L)
+{
+	lua_settop(L, 1);	// H
+
+	Heap * H = GetHeap(L);	// H, env
+
+	ClearHeap(L, H, 2);
+
+	return 0;
+}
+
+// @brief Indicates whether a handle refers to a queued entry
+// @note handle: Entry handle
+// @return If true, the entry is queued
+static int Contains (lua_State * L)
+{
+	uInt pos;
+
+	lua_pushboolean(L, ((Heap *)UD(L, 1))->Find(lua_tonumber(L, 2), pos));	// H, handle, bContains
+
+	return 1;
+}
+
+// @brief Gets an entry's key and payload
+// @note handle: Entry handle
+// @return Key, payload; or nothing, if the handle is stale
+static int Get (lua_State * L)
+{
+	lua_settop(L, 2);	// H, handle
+
+	Heap * H = GetHeap(L);	// H, handle, env
+	uInt pos;
+
+	if (!H->Find(lua_tonumber(L, 2), pos)) return 0;
+
+	lua_pushnumber(L, H->mEntries[pos].mKey);	// H, handle, env, key
+	lua_rawgeti(L, 3, H->mEntries[pos].mSlot);	// H, handle, env, key, payload
+
+	return 2;
+}
+
+// @brief Rebuilds the heap from arrays, in linear time
+// @note keys: Array of keys
+// @note [payloads]: Array of payloads, matching the keys
+// @note [handles]: If present, receives the handles, matching the keys
+// @return Entry count
+static int Heapify (lua_State * L)
+{
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	lua_settop(L, 4);	// H, keys, payloads, handles
+
+	if (!lua_isnil(L, 3)) luaL_checktype(L, 3, LUA_TTABLE);
+	if (!lua_isnil(L, 4)) luaL_checktype(L, 4, LUA_TTABLE);
+
+	Heap * H = GetHeap(L);	// H, keys, payloads, handles, env
+	uInt count = uInt(lua_objlen(L, 2));
+
+	// Check the keys up front, so that a bad key leaves the heap as it was.
+	for (uInt i = 0; i < count; ++i)
+	{
+		lua_rawgeti(L, 2, int(i + 1));	// H, keys, payloads, handles, env, key
+
+		if (!lua_isnumber(L, 6) || lua_tonumber(L, 6) != lua_tonumber(L, 6)) luaL_error(L, "Bad key #%d", i + 1);
+
+		lua_pop(L, 1);	// H, keys, payloads, handles, env
+	}
+
+	ClearHeap(L, H, 5);
+
+	H->mEntries.resize(count);
+
+	for (uInt i = 0; i < count; ++i)
+	{
+		lua_rawgeti(L, 2, int(i + 1));	// H, keys, payloads, handles, env, key
+
+		HeapEntry entry = { lua_tonumber(L, 6), H->Claim() };
+
+		lua_pop(L, 1);	// H, keys, payloads, handles, env
+
+		H->Place(entry, i);
+
+		if (!lua_isnil(L, 3))
+		{
+			lua_rawgeti(L, 3, int(i + 1));	// H, keys, payloads, handles, env, payload
+			lua_rawseti(L, 5, entry.mSlot);	// H, keys, payloads, handles, env
+		}
+
+		if (!lua_isnil(L, 4))
+		{
+			lua_pushnumber(L, H->Handle(entry.mSlot));	// H, keys, payloads, handles, env, handle
+			lua_rawseti(L, 4, int(i + 1));	// H, keys, payloads, handles, env
+		}
+	}
+
+	// Sift down each internal node, from the last one up.
+	for (uInt i = count > 1 ? (count - 2) / sArity + 1 : 0; i-- > 0; ) H->SiftDown(i);
+
+	lua_pushinteger(L, count);	// H, keys, payloads, handles, env, count
+
+	return 1;
+}
+
+// @brief Gets the first entry, without removing it
+// @return Payload, key; or nothing, if the heap is empty
+static int Peek (lua_State * L)
+{
+	lua_settop(L, 1);	// H
+
+	Heap * H = GetHeap(L);	// H, env
+
+	if (H->mEntries.empty()) return 0;
+
+	lua_rawgeti(L, 2, H->mEntries[0].mSlot);// H, env, payload
+	lua_pushnumber(L, H->mEntries[0].mKey);	// H, env, payload, key
+
+	return 2;
+}
+
+// @brief Removes the first entry
+// @return Payload, key; or nothing, if the heap is empty
+static int Pop (lua_State * L)
+{
+	lua_settop(L, 1);	// H
+
+	Heap * H = GetHeap(L);	// H, env
+
+	if (H->mEntries.empty()) return 0;
+
+	return PushRemoved(L, H->RemoveAt(0), 2);	// H, env, payload, key
+}
+
+// @brief Adds an entry
+// @note key: Priority; lower keys come out first
+// @note [payload]: Payload
+// @return Handle
+static int Push (lua_State * L)
+{
+	lua_settop(L, 3);	// H, key, payload
+
+	Heap * H = GetHeap(L);	// H, key, payload, env
+
+	if (H->mPos.size() >= size_t(sSlotRange) && 0 == H->mFree) luaL_error(L, "Heap is full");
+
+	HeapEntry entry = { GetKey(L, 2), H->Claim() };
+
+	lua_pushvalue(L, 3);// H, key, payload, env, payload
+	lua_rawseti(L, 4, entry.mSlot);	// H, key, payload, env
+
+	H->mEntries.push_back(entry);
+	H->SiftUp(uInt(H->mEntries.size() - 1));
+
+	lua_pushnumber(L, H->Handle(entry.mSlot));	// H, key, payload, env, handle
+
+	return 1;
+}
+
+// @brief Removes an entry by handle
+// @note handle: Entry handle
+// @return Payload, key; or nothing, if the handle is stale
+static int Remove (lua_State * L)
+{
+	lua_settop(L, 2);	// H, handle
+
+	Heap * H = GetHeap(L);	// H, handle, env
+	uInt pos;
+
+	if (!H->Find(lua_tonumber(L, 2), pos)) return 0;
+
+	return PushRemoved(L, H->RemoveAt(pos), 3);	// H, handle, env, payload, key
+}
+
+// @brief Changes an entry's key, e.g. decrease-key for pathfinding
+// @note handle: Entry handle
+// @note key: New key
+// @return If true, the handle was live
+static int SetKey (lua_State * L)
+{
+	Heap * H = (Heap *)UD(L, 1);
+	lua_Number key = GetKey(L, 3);
+	uInt pos;
+
+	bool bLive = H->Find(lua_tonumber(L, 2), pos);
+
+	if (bLive)
+	{
+		lua_Number old = H->mEntries[pos].mKey;
+
+		H->mEntries[pos].mKey = key;
+
+		if (key < old) H->SiftUp(pos);
+
+		else if (old < key) H->SiftDown(pos);
+	}
+
+	lua_pushboolean(L, bLive);	// H, handle, key, bLive
+
+	return 1;
+}
+
+// @brief __gc metamethod
+static int GC (lua_State * L)
+{
+	((Heap *)UD(L, 1))->~Heap();
+
+	return 0;
+}
+
+// @brief __len metamethod
+// @return Entry count
+static int Len (lua_State * L)
+{
+	lua_pushinteger(L, ((Heap *)UD(L, 1))->mEntries.size());	// H, count
+
+	return 1;
+}
+
+// @brief Constructor
+// @note H: Heap
+static int Cons (lua_State * L)
+{
+	new (UD(L, 1)) Heap;
+
+	return 0;
+}
+
+// @brief Defines the Heap class
+// @param L Lua state
+// @return 0
+// @note Must be called once the class module is loaded
+int Bindings::open_heap (lua_State * L)
+{
+	luaL_reg methods[] = {
+		{ "Clear", Clear },
+		{ "Contains", Contains },
+		{ "Get", Get },
+		{ "Heapify", Heapify },
+		{ "Peek", Peek },
+		{ "Pop", Pop },
+		{ "Push", Push },
+		{ "Remove", Remove },
+		{ "SetKey", SetKey },
+		{ "__gc", GC },
+		{ "__len", Len },
+		{ 0, 0 }
+	};
+
+	Class::Define(L, "Heap", methods, Cons, Class::Def(sizeof(Heap)));
+
+	return 0;
+}
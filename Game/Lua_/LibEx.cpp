@@ -1,6 +1,8 @@
 #include "Lua_/Lua.h"
 #include "Lua_/LibEx.h"
+#include "Lua_/Compiler.h"
 #include "Lua_/Helpers.h"
+#include "Lua_/Pack.h"
 #include "Lua_/Support.h"
 #include "Lua_/Types.h"
 #include <SCRIPT_MANAGER>
@@ -91,7 +93,7 @@ namespace Lua
 
 	// @brief Default __index metamethod
 	// @note _E: Object environment
-	static int Index (lua_State * L)
+	int Class::EnvIndex (lua_State * L)
 	{
 		lua_getfenv(L, 1);	// object, key, env
 		lua_replace(L, 1);	// env, key
@@ -102,7 +104,7 @@ namespace Lua
 
 	// @brief Default __newindex metamethod
 	// @note _E: Object environment
-	static int NewIndex (lua_State * L)
+	int Class::EnvNewIndex (lua_State * L)
 	{
 		lua_getfenv(L, 1);	// object, key, value, env
 		lua_replace(L, 1);	// env, key, value
@@ -111,6 +113,185 @@ namespace Lua
 		return 0;
 	}
 
+	// @brief Inline field
+	struct Slot {
+		int mType;	// Value type; collectable values live in the environment, under the field name
+		union {
+			lua_Number mNumber;	// Number value
+			void * mPtr;// Light userdata value
+			int mBool;	// Boolean value
+		};
+	};
+
+	// @brief Gets the offset of an instance's inline fields
+	// @param size Class size
+	// @return Offset
+	static uInt SlotOffset (uInt size)
+	{
+		return (size + sizeof(Slot) - 1) / sizeof(Slot) * sizeof(Slot);
+	}
+
+	// @brief Resolves a key to an inline field
+	// @param L Lua state
+	// @return Field, or 0 if key is not declared
+	// @note object: Instance
+	// @note key: Field name
+	// @note _U1: Field map
+	// @note _U2: Field offset
+	static Slot * GetSlot (lua_State * L)
+	{
+		lua_pushvalue(L, 2);// object, key, ..., key
+		lua_rawget(L, lua_upvalueindex(1));	// object, key, ..., index?
+
+		int index = lua_tointeger(L, -1);
+
+		lua_pop(L, 1);	// object, key, ...
+
+		if (0 == index) return 0;
+
+		return (Slot *)((char *)lua_touserdata(L, 1) + uI(L, lua_upvalueindex(2))) + index - 1;
+	}
+
+	// @brief Inline field instance allocator
+	// @note meta: Metatable
+	// @note _U1: Instance size
+	// @note _U2: Field map (also stands in for the environment until an undeclared key is assigned)
+	// @note _U3: Field count
+	static int SlotAlloc (lua_State * L)
+	{
+		uInt offset = SlotOffset(uI(L, lua_upvalueindex(1))), count = uI(L, lua_upvalueindex(3));
+
+		Slot * slots = (Slot *)((char *)lua_newuserdata(L, offset + count * sizeof(Slot)) + offset);	// meta, ud
+
+		for (uInt i = 0; i < count; ++i) slots[i].mType = LUA_TNIL;
+
+		lua_insert(L, 1);	// ud, meta
+		lua_setmetatable(L, 1);	// ud
+		lua_pushvalue(L, lua_upvalueindex(2));	// ud, map
+		lua_setfenv(L, 1);	// ud
+
+		return 1;
+	}
+
+	// @brief Inline field __index metamethod
+	// @note _E: Object environment
+	// @note _U1: Field map
+	// @note _U2: Field offset
+	static int SlotIndex (lua_State * L)
+	{
+		Slot * slot = GetSlot(L);
+
+		if (slot != 0)
+		{
+			switch (slot->mType)
+			{
+			case LUA_TNIL:
+				lua_pushnil(L);	// object, key, nil
+				return 1;
+			case LUA_TBOOLEAN:
+				lua_pushboolean(L, slot->mBool);// object, key, value
+				return 1;
+			case LUA_TLIGHTUSERDATA:
+				lua_pushlightuserdata(L, slot->mPtr);	// object, key, value
+				return 1;
+			case LUA_TNUMBER:
+				lua_pushnumber(L, slot->mNumber);	// object, key, value
+				return 1;
+			}
+		}
+
+		// Collectable fields and undeclared keys are looked up in the environment.
+		return Class::EnvIndex(L);
+	}
+
+	// @brief Inline field __newindex metamethod
+	// @note _E: Object environment
+	// @note _U1: Field map
+	// @note _U2: Field offset
+	static int SlotNewIndex (lua_State * L)
+	{
+		Slot * slot = GetSlot(L);
+
+		if (slot != 0)
+		{
+			int type = lua_type(L, 3);
+
+			switch (type)
+			{
+			case LUA_TBOOLEAN:
+				slot->mBool = lua_toboolean(L, 3);
+				break;
+			case LUA_TLIGHTUSERDATA:
+				slot->mPtr = lua_touserdata(L, 3);
+				break;
+			case LUA_TNUMBER:
+				slot->mNumber = lua_tonumber(L, 3);
+				break;
+			}
+
+			// Stored inline: if this replaces a collectable value, clear its environment entry.
+			bool bWasCollectable = slot->mType > LUA_TNUMBER;
+
+			slot->mType = type;
+
+			if (type <= LUA_TNUMBER)
+			{
+				if (!bWasCollectable) return 0;
+
+				lua_pushnil(L);	// object, key, value, nil
+				lua_replace(L, 3);	// object, key, nil
+			}
+		}
+
+		// Give the instance its own environment on its first collectable or undeclared assignment.
+		lua_getfenv(L, 1);	// object, key, value, env
+
+		if (lua_rawequal(L, -1, lua_upvalueindex(1)))
+		{
+			if (lua_isnil(L, 3)) return 0;
+
+			lua_newtable(L);// object, key, value, map, env
+			lua_pushvalue(L, -1);	// object, key, value, map, env, env
+			lua_setfenv(L, 1);	// object, key, value, map, env
+		}
+
+		lua_replace(L, 1);	// env, key, value[, map]
+		lua_settop(L, 3);	// env, key, value
+		lua_rawset(L, 1);	// env
+
+		return 0;
+	}
+
+	// @brief Pushes the inline field map, installing the field lookups
+	// @param L Lua state
+	// @param fields Field names
+	// @param size Class size
+	// @return Field count
+	// @note M: Metatable
+	static uInt PushSlotMap (lua_State * L, char const ** fields, uInt size)
+	{
+		uInt count = 0;
+
+		lua_newtable(L);// ..., M, map
+
+		for (; fields[count] != 0; ++count)
+		{
+			lua_pushinteger(L, count + 1);	// ..., M, map, index
+			lua_setfield(L, -2, fields[count]);	// ..., M, map = { ..., field = index }
+		}
+
+		lua_pushvalue(L, -1);	// ..., M, map, map
+		lua_pushinteger(L, SlotOffset(size));	// ..., M, map, map, offset
+		lua_pushcclosure(L, SlotIndex, 2);	// ..., M, map, SlotIndex
+		lua_setfield(L, -3, "__index");	// ..., M = { __index = SlotIndex }, map
+		lua_pushvalue(L, -1);	// ..., M, map, map
+		lua_pushinteger(L, SlotOffset(size));	// ..., M, map, map, offset
+		lua_pushcclosure(L, SlotNewIndex, 2);	// ..., M, map, SlotNewIndex
+		lua_setfield(L, -3, "__newindex");	// ..., M = { __index, __newindex = SlotNewIndex }, map
+
+		return count;
+	}
+
 	// @brief Defines a class, with closures on the stack and new function at the top
 	// @param L Lua state
 	// @param name Type name
@@ -130,12 +311,29 @@ namespace Lua
 		// Install the constructor.
 		lua_insert(L, -count - 1);	// cons, ...
 
-		// Load methods, starting with default __index / __newindex metamethods.
+		// Load methods, starting with default __index / __newindex metamethods. With inline
+		// fields, these resolve declared keys by slot; the field map is put aside for the
+		// allocator, below the constructor.
+		uInt nfields = 0;
+
 		lua_newtable(L);// cons, ..., M
-		lua_pushcfunction(L, Index);// cons, ..., M, Index
-		lua_setfield(L, -2, "__index");	// cons, ..., M = { __index = Index }
-		lua_pushcfunction(L, NewIndex);	// cons, ..., M, NewIndex
-		lua_setfield(L, -2, "__newindex");	// cons, ..., M = { __index, __newindex = NewIndex }
+
+		if (def.mFields != 0)
+		{
+			assert(!def.mShared);
+
+			nfields = PushSlotMap(L, def.mFields, def.mSize);	// cons, ..., M, map
+
+			lua_insert(L, -count - 3);	// map, cons, ..., M
+		}
+
+		else
+		{
+			lua_pushcfunction(L, EnvIndex);	// cons, ..., M, EnvIndex
+			lua_setfield(L, -2, "__index");	// cons, ..., M = { __index = EnvIndex }
+			lua_pushcfunction(L, EnvNewIndex);	// cons, ..., M, EnvNewIndex
+			lua_setfield(L, -2, "__newindex");	// cons, ..., M = { __index, __newindex = EnvNewIndex }
+		}
 
 		if (methods != 0) luaL_register(L, 0, methods);
 
@@ -159,6 +357,13 @@ namespace Lua
 			lua_pushcclosure(L, SharedAlloc, 2);// M, cons, SharedAlloc
 		}
 
+		else if (def.mFields != 0)
+		{
+			lua_pushvalue(L, -4);	// map, M, cons, size, map
+			lua_pushinteger(L, nfields);// map, M, cons, size, map, count
+			lua_pushcclosure(L, SlotAlloc, 3);	// map, M, cons, SlotAlloc
+		}
+
 		else
 		{
 			lua_pushinteger(L, def.mArr);	// M, cons, size, narr
@@ -167,11 +372,9 @@ namespace Lua
 		}
 
 		// Assign any parameters.
-		if (!def.mBases.empty()) Call(L, "class.Define", 0, "saa{ Kss Ksa }", name, -3, -2, "base", def.mBases.c_str(), "alloc", -1);
-
-		else Call(L, "class.Define", 0, "saa{ Ksa }", name, -3, -2, "alloc", -1);
+		Call(L, "class.Define", 0, "saa{ CKss CKsi Ksa }", name, -3, -2, !def.mBases.empty(), "base", def.mBases.c_str(), def.mPool != 0, "pool", def.mPool, "alloc", -1);
 
-		lua_pop(L, 3);
+		lua_pop(L, def.mFields != 0 ? 4 : 3);
 	}
 
 	// @brief Dummy variable; class.New is cached under its address
@@ -211,6 +414,24 @@ namespace Lua
 		SetFuncInfo(0, 0, 0);
 	}
 
+	// @brief Dummy variable; class.Recycle is cached under its address
+	static int _Recycle;
+
+	// @brief Returns an instance to its class's pool
+	// @param L Lua state
+	// @param index Index of instance
+	// @note Temporaries built by Lua_Class_New, e.g. in _getmemberT_arg, are handed back this
+	// way once consumed; collection does not return instances to the pool
+	void Class::Recycle (lua_State * L, int index)
+	{
+		IndexAbsolute(L, index);
+
+		CacheAndGet(L, "class.Recycle", &_Recycle);	// class.Recycle
+
+		lua_pushvalue(L, index);// class.Recycle, I
+		lua_call(L, 1, 0);
+	}
+
 	// @brief Dummy variable; class.IsInstance is cached under its address
 	static int _IsInstance;
 
@@ -285,30 +506,47 @@ namespace Lua
 	{
 		const char * pszFilename = S(L, 1);
 
-		FILE_STREAM * pIn = CREATE_FILESTREAM(pszFilename, 0);
+		// Look the script up in the mounted packs, unless loose files come first.
+		int result = Pack::LooseOverrides() ? -1 : Pack::Load(L, pszFilename);	// file[, chunk / error]
 
-		if (0 == pIn)
+		if (result < 0)
 		{
-			lua_pushnil(L);	// file, nil
-			lua_pushfstring(L, "Could not open file: %s", pszFilename);	// file, nil, error
+			FILE_STREAM * pIn = CREATE_FILESTREAM(pszFilename, 0);
 
-			return 2;
-		}
+			if (0 == pIn)
+			{
+				// With overrides, a script with no loose file may still be packed.
+				if (Pack::LooseOverrides()) result = Pack::Load(L, pszFilename);// file[, chunk / error]
+
+				if (result < 0)
+				{
+					lua_pushnil(L);	// file, nil
+					lua_pushfstring(L, "Could not open file: %s", pszFilename);	// file, nil, error
 
-		int iScriptLen = pIn->GetSize();
+					return 2;
+				}
+			}
 
-		TEMP_BUFFER<16 * 1024> buffer(iScriptLen + 1);
+			else
+			{
+				int iScriptLen = pIn->GetSize();
 
-		char *szBuffer = (char *)buffer.GetBuffer();
+				TEMP_BUFFER<16 * 1024> buffer(iScriptLen + 1);
 
-		pIn->Read(szBuffer, iScriptLen);
+				char *szBuffer = (char *)buffer.GetBuffer();
 
-		szBuffer[iScriptLen] = 0;
+				pIn->Read(szBuffer, iScriptLen);
 
-		pIn->Close();
+				szBuffer[iScriptLen] = 0;
 
-		// Load the string as a chunk.
-		if (luaL_loadbuffer(L, szBuffer, iScriptLen, pszFilename) != 0)	// file[, chunk]
+				pIn->Close();
+
+				// Load the string as a chunk, from the bytecode cache if possible.
+				result = LoadChunk(L, szBuffer, iScriptLen, pszFilename);	// file, chunk / error
+			}
+		}
+
+		if (result != 0)
 		{
 			lua_pushnil(L);	// file, nil
 			lua_insert(L, -2);	// file, nil, error
@@ -322,7 +560,7 @@ namespace Lua
 	// @brief
 	int Lua::LoadDir (lua_State * L, char const * boot)
 	{
-		CacheAndGet(L, Lua::FM_Loader);	// ..., loader
+		CacheAndGet(L, Compiler::IsRunning() ? Compiler::Loader : Lua::FM_Loader);	// ..., loader
 
 		int loader = -1;
 
@@ -332,6 +570,9 @@ namespace Lua
 
 		lua_remove(L, loader);	// ...
 
+		// Drop anything prefetched but never loaded, e.g. after an error.
+		Compiler::Drop();
+
 		return result;
 	}
 
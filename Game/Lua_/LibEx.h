@@ -7,7 +7,20 @@
 
 namespace Bindings
 {
+	int open_arrays (lua_State * L);
+	int open_batches (lua_State * L);
+	int open_bench (lua_State * L);
+	int open_class (lua_State * L);
+	int open_compiler (lua_State * L);
+	int open_dispatch (lua_State * L);
+	int open_heap (lua_State * L);
+	int open_random (lua_State * L);
+	int open_sequence (lua_State * L);
+	int open_serialize (lua_State * L);
+	int open_slotmap (lua_State * L);
 	int open_std (lua_State * L);
+	int open_table (lua_State * L);
+	int open_vardump (lua_State * L);
 }
 
 namespace Lua
@@ -17,12 +30,14 @@ namespace Lua
 		// @brief Class definition
 		struct Def {
 			std::string mBases;	// Base types
+			char const ** mFields;	// Inline fields: null-terminated name list (if null, all fields use environment)
 			uInt mArr;	// Environment: Array count
 			uInt mRec;	// Environment: Record count
-			uInt mSize;	// Class size
+			uInt mSize;	// Class size (inline fields follow)
+			uInt mPool;	// Most recycled instances to keep (if 0, class is not pooled)
 			bool mShared;	// If true, use shared environment table
 
-			Def (uInt size = 0, char const * bases = 0, bool bShared = false) : mArr(0), mRec(0), mSize(size), mShared(bShared)
+			Def (uInt size = 0, char const * bases = 0, bool bShared = false) : mFields(0), mArr(0), mRec(0), mSize(size), mPool(0), mShared(bShared)
 			{
 				if (bases != 0) mBases = bases;
 			}
@@ -34,18 +49,28 @@ namespace Lua
 		void Define (lua_State * L, char const * name, luaL_reg const * methods, char const * closures[], Def const & def = Def());
 		void New (lua_State * L, char const * name, int count);
 		void New (lua_State * L, char const * name, char const * params, ...);
+		void Recycle (lua_State * L, int index);
 
 		void GetFuncInfo (char *& file, char *& func, int & line);
 		void SetFuncInfo (char * file, char * func, int line);
 
+		int EnvIndex (lua_State * L);
+		int EnvNewIndex (lua_State * L);
+
 		bool IsInstance (lua_State * L, int index);
 		bool IsType (lua_State * L, int index, char const * type);
 	}
 
 	int FM_Loader (lua_State * L);
 
+	int CacheFile (lua_State * L, char const * name);
+	bool FindBytecode (char const * text, size_t len, char const * name, std::string & header);
+	int LoadChunk (lua_State * L, char const * text, size_t len, char const * name);
 	int LoadDir (lua_State * L, char const * boot);
 	int LoadFile (lua_State * L, char const * name);
+
+	void SetBytecodeCache (char const * dir, bool bWrite = true);
+	void StoreBytecode (std::string const & header, std::string const & bytecode);
 }
 
 #define Lua_Class_New Lua::Class::SetFuncInfo(__FILE__, __FUNCTION__, __LINE__), Lua::Class::New
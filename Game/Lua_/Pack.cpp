@@ -0,0 +1,385 @@
+#include "Lua_/Lua.h"
+#include "Lua_/LibEx.h"
+#include "Lua_/Pack.h"
+#include <SCRIPT_MANAGER>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+// @brief Mounted pack
+struct Mounted {
+	std::string mPrefix;// Normalized prefix of the names the pack answers for
+	uChar const * mBase;// Mapped file
+	size_t mSize;	// Mapped size
+	uInt mCount;// Entry count
+	uChar const * mIndex;	// Index
+	char const * mNames;// Names
+#ifdef _WIN32
+	HANDLE mFile, mMapping;	// File and mapping handles
+#endif
+};
+
+// @brief Mounted packs, most recent last, and override mode
+static std::vector<Mounted> s_packs;
+static bool s_bLooseOverrides;
+
+static uInt GetU32 (uChar const * bytes)
+{
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (uInt(bytes[3]) << 24);
+}
+
+// @brief Unmaps a pack
+static void Unmap (Mounted & pack)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(pack.mBase);
+	CloseHandle(pack.mMapping);
+	CloseHandle(pack.mFile);
+#else
+	munmap((void *)pack.mBase, pack.mSize);
+#endif
+}
+
+// @brief Validates a mapped pack's header and index
+// @return If true, every entry lies within the file, with a size its stored form can hold
+// @note LZ4 expands at most 255:1 (plus a few literal bytes), so larger claimed sizes are corrupt; the
+// size is also kept below 2 GB, so the decode buffer size, plus a terminator, fits an int
+static bool Validate (Mounted & pack)
+{
+	using namespace Lua::Pack;
+
+	if (pack.mSize < eHeaderWords * 4 || memcmp(pack.mBase, Magic, sizeof(Magic)) != 0) return false;
+
+	pack.mCount = GetU32(pack.mBase + 4);
+
+	uInt index = GetU32(pack.mBase + 8), names = GetU32(pack.mBase + 12), nsize = GetU32(pack.mBase + 16);
+
+	if (index > pack.mSize || pack.mCount > (pack.mSize - index) / (eIndexWords * 4)) return false;
+	if (names > pack.mSize || nsize > pack.mSize - names) return false;
+
+	pack.mIndex = pack.mBase + index;
+	pack.mNames = (char const *)pack.mBase + names;
+
+	// Names must end inside their block, so lookups stay in bounds.
+	if (pack.mCount > 0 && (0 == nsize || pack.mNames[nsize - 1] != 0)) return false;
+
+	for (uInt i = 0; i < pack.mCount; ++i)
+	{
+		uChar const * entry = pack.mIndex + i * eIndexWords * 4;
+		uInt name = GetU32(entry), offset = GetU32(entry + 4), stored = GetU32(entry + 8), size = GetU32(entry + 12);
+
+		if (name >= nsize || offset > pack.mSize || stored > pack.mSize - offset) return false;
+
+		if (GetU32(entry + 16) & eLZ4)
+		{
+			if (size >= 0x7FFFFFFFU || size > uInt64(stored) * 255 + 16) return false;
+		}
+
+		else if (size != stored) return false;
+	}
+
+	return true;
+}
+
+// @brief Checks an entry's text against its hash
+static bool Matches (uChar const * entry, uChar const * text, uInt size)
+{
+	uInt low, high;
+
+	Lua::Pack::Hash(text, size, low, high);
+
+	return GetU32(entry + 20) == low && GetU32(entry + 24) == high;
+}
+
+// @brief Finds an entry by normalized name
+// @return Index entry, or 0 if absent
+static uChar const * Find (Mounted const & pack, std::string const & name)
+{
+	using namespace Lua::Pack;
+
+	// Strip the prefix; names outside it are not in this pack.
+	if (name.compare(0, pack.mPrefix.size(), pack.mPrefix) != 0) return 0;
+
+	char const * key = name.c_str() + pack.mPrefix.size();
+
+	// Binary search the sorted index.
+	uInt lo = 0, hi = pack.mCount;
+
+	while (lo < hi)
+	{
+		uInt mid = lo + (hi - lo) / 2;
+
+		uChar const * entry = pack.mIndex + mid * eIndexWords * 4;
+
+		int cmp = strcmp(key, pack.mNames + GetU32(entry));
+
+		if (0 == cmp) return entry;
+
+		else if (cmp < 0) hi = mid;
+
+		else lo = mid + 1;
+	}
+
+	return 0;
+}
+
+namespace Lua
+{
+	// @brief Mounts a pack, mapping it into memory
+	// @param path Pack file
+	// @param prefix Prefix of the script names the pack answers for, e.g. "Scripts/" (if null, none)
+	// @return If true, the pack was mounted
+	// @note Packs mounted later are searched first
+	bool Pack::Mount (char const * path, char const * prefix)
+	{
+		Mounted pack;
+
+		pack.mPrefix = Normalize(prefix != 0 ? prefix : "");
+
+		if (!pack.mPrefix.empty() && pack.mPrefix[pack.mPrefix.size() - 1] != '/') pack.mPrefix += '/';
+
+	#ifdef _WIN32
+		pack.mFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+
+		if (INVALID_HANDLE_VALUE == pack.mFile) return false;
+
+		pack.mSize = size_t(GetFileSize(pack.mFile, 0));
+		pack.mMapping = pack.mSize > 0 ? CreateFileMappingA(pack.mFile, 0, PAGE_READONLY, 0, 0, 0) : 0;
+		pack.mBase = pack.mMapping != 0 ? (uChar const *)MapViewOfFile(pack.mMapping, FILE_MAP_READ, 0, 0, 0) : 0;
+
+		if (0 == pack.mBase)
+		{
+			if (pack.mMapping != 0) CloseHandle(pack.mMapping);
+
+			CloseHandle(pack.mFile);
+
+			return false;
+		}
+	#else
+		int fd = open(path, O_RDONLY);
+
+		if (fd < 0) return false;
+
+		struct stat info;
+
+		void * base = fstat(fd, &info) == 0 && info.st_size > 0 ? mmap(0, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+		close(fd);
+
+		if (MAP_FAILED == base) return false;
+
+		pack.mBase = (uChar const *)base;
+		pack.mSize = size_t(info.st_size);
+	#endif
+
+		if (!Validate(pack))
+		{
+			Unmap(pack);
+
+			return false;
+		}
+
+		s_packs.push_back(pack);
+
+		return true;
+	}
+
+	// @brief Unmounts every pack
+	void Pack::UnmountAll (void)
+	{
+		for (size_t i = 0; i < s_packs.size(); ++i) Unmap(s_packs[i]);
+
+		s_packs.clear();
+	}
+
+	// @brief Sets whether loose files take precedence over packed ones
+	// @param bOverride If true, loose files are tried first (e.g. while developing); otherwise, only
+	// names missing from every pack are looked for on disk
+	void Pack::SetLooseOverrides (bool bOverride)
+	{
+		s_bLooseOverrides = bOverride;
+	}
+
+	// @brief Indicates whether loose files take precedence over packed ones
+	bool Pack::LooseOverrides (void)
+	{
+		return s_bLooseOverrides;
+	}
+
+	// @brief Loads a chunk from the mounted packs
+	// @param L Lua state
+	// @param name Script name
+	// @return -1 if no pack holds the name; otherwise, the LoadChunk result
+	// @note Uncompressed entries are compiled straight from the mapped bytes; every entry is checked
+	// against its hash first, since the mapping is not validated beyond the index
+	int Pack::Load (lua_State * L, char const * name)
+	{
+		if (s_packs.empty()) return -1;
+
+		std::string key = Normalize(name);
+
+		for (size_t i = s_packs.size(); i-- > 0; )
+		{
+			Mounted const & pack = s_packs[i];
+			uChar const * entry = Find(pack, key);
+
+			if (0 == entry) continue;
+
+			uChar const * data = pack.mBase + GetU32(entry + 4);
+			uInt stored = GetU32(entry + 8), size = GetU32(entry + 12);
+
+			if (!(GetU32(entry + 16) & eLZ4))
+			{
+				if (Matches(entry, data, stored)) return LoadChunk(L, (char const *)data, stored, name);
+			}
+
+			// Compressed entries are expanded first. Validate has bounded the size.
+			else
+			{
+				TEMP_BUFFER<16 * 1024> buffer(int(size_t(size) + 1));
+
+				uChar * text = (uChar *)buffer.GetBuffer();
+
+				if (LZ4_Decode(data, stored, text, size) && Matches(entry, text, size)) return LoadChunk(L, (char const *)text, size, name);
+			}
+
+			lua_pushfstring(L, "Corrupt pack entry: %s", name);	// ..., error
+
+			return LUA_ERRFILE;
+		}
+
+		return -1;
+	}
+
+	// @brief Reads a script's text from the mounted packs
+	// @param name Script name
+	// @param text [out] Script text
+	// @return -1 if no pack holds the name; 0 if read; otherwise, LUA_ERRFILE for a corrupt entry
+	// @note Touches only the mapped packs, so it may be called while workers are compiling
+	int Pack::Read (char const * name, std::string & text)
+	{
+		if (s_packs.empty()) return -1;
+
+		std::string key = Normalize(name);
+
+		for (size_t i = s_packs.size(); i-- > 0; )
+		{
+			Mounted const & pack = s_packs[i];
+			uChar const * entry = Find(pack, key);
+
+			if (0 == entry) continue;
+
+			uChar const * data = pack.mBase + GetU32(entry + 4);
+			uInt stored = GetU32(entry + 8), size = GetU32(entry + 12);
+
+			if (!(GetU32(entry + 16) & eLZ4))
+			{
+				if (Matches(entry, data, stored))
+				{
+					text.assign((char const *)data, stored);
+
+					return 0;
+				}
+			}
+
+			// Compressed entries are expanded first. Validate has bounded the size.
+			else
+			{
+				text.resize(size_t(size) + 1);
+
+				if (LZ4_Decode(data, stored, (uChar *)&text[0], size) && Matches(entry, (uChar const *)text.data(), size))
+				{
+					text.resize(size);
+
+					return 0;
+				}
+			}
+
+			text.clear();
+
+			return LUA_ERRFILE;
+		}
+
+		return -1;
+	}
+
+	// @brief Decodes an LZ4 block
+	// @param src Block
+	// @param size Block size
+	// @param dst [out] Decoded data
+	// @param dst_size Decoded size
+	// @return If true, the block was well-formed and decoded to exactly dst_size bytes
+	bool Pack::LZ4_Decode (uChar const * src, uInt size, uChar * dst, uInt dst_size)
+	{
+		uChar const * ip = src, * iend = src + size;
+		uChar * op = dst, * oend = dst + dst_size;
+
+		while (ip < iend)
+		{
+			uInt token = *ip++, count = token >> 4;
+
+			// Copy the literals.
+			if (15 == count)
+			{
+				uChar more;
+
+				do {
+					if (ip == iend) return false;
+
+					more = *ip++;
+					count += more;
+				} while (255 == more);
+			}
+
+			if (count > uInt(iend - ip) || count > uInt(oend - op)) return false;
+
+			memcpy(op, ip, count);
+
+			op += count;
+			ip += count;
+
+			// The last sequence is literals only.
+			if (ip == iend) break;
+
+			// Copy the match, which may overlap its own output.
+			if (iend - ip < 2) return false;
+
+			uInt offset = ip[0] | (ip[1] << 8);
+
+			ip += 2;
+
+			if (0 == offset || offset > uInt(op - dst)) return false;
+
+			count = token & 15;
+
+			if (15 == count)
+			{
+				uChar more;
+
+				do {
+					if (ip == iend) return false;
+
+					more = *ip++;
+					count += more;
+				} while (255 == more);
+			}
+
+			count += 4;
+
+			if (count > uInt(oend - op)) return false;
+
+			for (uChar const * match = op - offset; count > 0; --count) *op++ = *match++;
+		}
+
+		return op == oend;
+	}
+}
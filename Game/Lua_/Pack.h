@@ -0,0 +1,75 @@
+#ifndef LUA_PACK_H
+#define LUA_PACK_H
+
+#include "AppTypes.h"
+#include <string>
+
+struct lua_State;
+
+namespace Lua
+{
+	// @brief Packed script archive: one file, memory-mapped at mount, holding scripts and data
+	// @note Layout, in little-endian 32-bit words: header (magic, entry count, index offset, names
+	// offset, names size); index of eIndexWords words per entry, sorted by name (name offset, data
+	// offset, stored size, size, flags, hash low, hash high); null-terminated names; then entry data
+	namespace Pack
+	{
+	#ifdef _MSC_VER
+		typedef unsigned __int64 uInt64;
+	#else
+		typedef unsigned long long uInt64;
+	#endif
+
+		enum {
+			eHeaderWords = 5,	// Header size, in words
+			eIndexWords = 7,// Index entry size, in words
+			eLZ4 = 0x1	// Flag: entry is an LZ4 block
+		};
+
+		char const Magic[4] = { 'L', 'P', 'K', '\1' };
+
+		bool Mount (char const * path, char const * prefix = 0);
+		void UnmountAll (void);
+
+		void SetLooseOverrides (bool bOverride);
+		bool LooseOverrides (void);
+
+		int Load (lua_State * L, char const * name);
+		int Read (char const * name, std::string & text);
+
+		int Build (char const * out, char const * root, bool bCompress);
+
+		bool LZ4_Decode (uChar const * src, uInt size, uChar * dst, uInt dst_size);
+		void LZ4_Encode (uChar const * src, uInt size, std::string & out);
+
+		// @brief Hashes entry contents: 64-bit FNV-1a, as a low and high word
+		inline void Hash (uChar const * data, uInt size, uInt & low, uInt & high)
+		{
+			uInt64 hash = 0xCBF29CE484222325ULL;
+
+			for (uInt i = 0; i < size; ++i) hash = (hash ^ data[i]) * 0x100000001B3ULL;
+
+			low = uInt(hash);
+			high = uInt(hash >> 32);
+		}
+
+		// @brief Normalizes an entry name: forward slashes, lowercase, no leading "./"
+		inline std::string Normalize (char const * name)
+		{
+			while (name[0] == '.' && (name[1] == '/' || name[1] == '\\')) name += 2;
+
+			std::string out(name);
+
+			for (std::string::size_type i = 0; i < out.size(); ++i)
+			{
+				if (out[i] == '\\') out[i] = '/';
+
+				else if (out[i] >= 'A' && out[i] <= 'Z') out[i] += 'a' - 'A';
+			}
+
+			return out;
+		}
+	}
+}
+
+#endif // LUA_PACK_H
@@ -0,0 +1,286 @@
+#include "Lua_/Pack.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <dirent.h>
+	#include <sys/stat.h>
+#endif
+
+// @brief File gathered for packing
+struct Source {
+	std::string mName;	// Normalized name, relative to the root
+	std::string mPath;	// Path on disk
+
+	bool operator < (Source const & other) const { return mName < other.mName; }
+};
+
+// @brief Gathers the files under a directory
+// @param dir Directory path, with trailing separator
+// @param rel Path relative to the root, with trailing separator (empty at the root)
+static void Gather (std::string const & dir, std::string const & rel, std::vector<Source> & files)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+
+	HANDLE find = FindFirstFileA((dir + "*").c_str(), &data);
+
+	if (INVALID_HANDLE_VALUE == find) return;
+
+	do {
+		std::string name = data.cFileName;
+
+		if ("." == name || ".." == name) continue;
+
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) Gather(dir + name + "/", rel + name + "/", files);
+
+		else
+		{
+			Source source = { Lua::Pack::Normalize((rel + name).c_str()), dir + name };
+
+			files.push_back(source);
+		}
+	} while (FindNextFileA(find, &data));
+
+	FindClose(find);
+#else
+	DIR * handle = opendir(dir.c_str());
+
+	if (0 == handle) return;
+
+	while (dirent * item = readdir(handle))
+	{
+		std::string name = item->d_name;
+
+		if ("." == name || ".." == name) continue;
+
+		struct stat info;
+
+		if (stat((dir + name).c_str(), &info) != 0) continue;
+
+		if (S_ISDIR(info.st_mode)) Gather(dir + name + "/", rel + name + "/", files);
+
+		else if (S_ISREG(info.st_mode))
+		{
+			Source source = { Lua::Pack::Normalize((rel + name).c_str()), dir + name };
+
+			files.push_back(source);
+		}
+	}
+
+	closedir(handle);
+#endif
+}
+
+// @brief Reads a whole file
+// @return If true, the file was read
+static bool ReadFile (std::string const & path, std::string & out)
+{
+	FILE * file = fopen(path.c_str(), "rb");
+
+	if (0 == file) return false;
+
+	char chunk[16 * 1024];
+
+	out.clear();
+
+	for (size_t n; (n = fread(chunk, 1, sizeof(chunk), file)) > 0; ) out.append(chunk, n);
+
+	bool bOK = ferror(file) == 0;
+
+	fclose(file);
+
+	return bOK;
+}
+
+static void SetU32 (std::string & out, size_t pos, uInt value)
+{
+	for (int i = 0; i < 4; ++i, value >>= 8) out[pos + i] = char(value & 0xFF);
+}
+
+// @brief Appends an LZ4 length continuation
+static void PutLength (std::string & out, uInt count)
+{
+	for (; count >= 255; count -= 255) out += char(255);
+
+	out += char(count);
+}
+
+// @brief Appends an LZ4 sequence: literals, then a match (if length is non-zero)
+static void PutSequence (std::string & out, uChar const * lit, uInt nlit, uInt offset, uInt length)
+{
+	uInt mcode = length > 0 ? length - 4 : 0;
+
+	out += char(((nlit < 15 ? nlit : 15) << 4) | (mcode < 15 ? mcode : 15));
+
+	if (nlit >= 15) PutLength(out, nlit - 15);
+
+	out.append((char const *)lit, nlit);
+
+	if (length > 0)
+	{
+		out += char(offset & 0xFF);
+		out += char(offset >> 8);
+
+		if (mcode >= 15) PutLength(out, mcode - 15);
+	}
+}
+
+namespace Lua
+{
+	// @brief Encodes an LZ4 block: greedy matching on a hash of 4-byte sequences
+	// @param src Data
+	// @param size Data size
+	// @param out [out] Block
+	void Pack::LZ4_Encode (uChar const * src, uInt size, std::string & out)
+	{
+		// Per the format, the last match starts at least 12 bytes before the end, and the last 5
+		// bytes are literals.
+		enum { eHashBits = 12, eMinTail = 12, eLastLiterals = 5 };
+
+		std::vector<uInt> table(1 << eHashBits, ~0U);
+		uInt anchor = 0;
+
+		out.clear();
+
+		for (uInt i = 0; i + eMinTail < size; )
+		{
+			uInt seq, ref_seq;
+
+			memcpy(&seq, src + i, 4);
+
+			uInt h = (seq * 2654435761U) >> (32 - eHashBits), ref = table[h];
+
+			table[h] = i;
+
+			if (ref != ~0U && i - ref <= 65535 && (memcpy(&ref_seq, src + ref, 4), ref_seq == seq))
+			{
+				uInt length = 4, limit = size - eLastLiterals - i;
+
+				while (length < limit && src[ref + length] == src[i + length]) ++length;
+
+				PutSequence(out, src + anchor, i - anchor, i - ref, length);
+
+				i += length;
+				anchor = i;
+			}
+
+			else ++i;
+		}
+
+		PutSequence(out, src + anchor, size - anchor, 0, 0);
+	}
+
+	// @brief Builds a pack from a directory tree
+	// @param out Pack file to write
+	// @param root Root directory; entry names are relative to it
+	// @param bCompress If true, entries are LZ4-compressed where that makes them smaller
+	// @return Count of entries packed, or -1 on error
+	int Pack::Build (char const * out, char const * root, bool bCompress)
+	{
+		std::string dir = root;
+
+		if (!dir.empty() && dir[dir.size() - 1] != '/' && dir[dir.size() - 1] != '\\') dir += '/';
+
+		std::vector<Source> files;
+
+		Gather(dir, "", files);
+
+		std::sort(files.begin(), files.end());
+
+		// Lay out the header, index, and names; the data follows.
+		uInt count = uInt(files.size());
+		uInt index = eHeaderWords * 4, names = index + count * eIndexWords * 4;
+		std::string head(names, '\0'), data, text, packed;
+
+		for (uInt i = 0; i < count; ++i)
+		{
+			SetU32(head, index + i * eIndexWords * 4, uInt(head.size() - names));
+
+			head += files[i].mName;
+			head += '\0';
+		}
+
+		uInt base = uInt(head.size());
+
+		head.replace(0, sizeof(Magic), Magic, sizeof(Magic));
+
+		SetU32(head, 4, count);
+		SetU32(head, 8, index);
+		SetU32(head, 12, names);
+		SetU32(head, 16, base - names);
+
+		// Add the entries, compressing them if that saves space.
+		for (uInt i = 0; i < count; ++i)
+		{
+			if (!ReadFile(files[i].mPath, text)) return -1;
+
+			uInt low, high, flags = 0;
+
+			Hash((uChar const *)text.data(), uInt(text.size()), low, high);
+
+			if (bCompress && !text.empty())
+			{
+				LZ4_Encode((uChar const *)text.data(), uInt(text.size()), packed);
+
+				if (packed.size() < text.size()) flags |= eLZ4;
+			}
+
+			std::string const & stored = (flags & eLZ4) ? packed : text;
+			size_t entry = index + i * eIndexWords * 4;
+
+			SetU32(head, entry + 4, base + uInt(data.size()));
+			SetU32(head, entry + 8, uInt(stored.size()));
+			SetU32(head, entry + 12, uInt(text.size()));
+			SetU32(head, entry + 16, flags);
+			SetU32(head, entry + 20, low);
+			SetU32(head, entry + 24, high);
+
+			data += stored;
+		}
+
+		// Write the pack.
+		FILE * file = fopen(out, "wb");
+
+		if (0 == file) return -1;
+
+		bool bOK = fwrite(head.data(), 1, head.size(), file) == head.size();
+
+		bOK = bOK && fwrite(data.data(), 1, data.size(), file) == data.size();
+
+		return fclose(file) == 0 && bOK ? int(count) : -1;
+	}
+}
+
+#ifdef PACK_TOOL
+
+// @brief Standalone packer, e.g. PackTool Scripts Scripts.pak -lz4
+int main (int argc, char ** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s <root> <pack> [-lz4]\n", argv[0]);
+
+		return 1;
+	}
+
+	int count = Lua::Pack::Build(argv[2], argv[1], argc > 3 && strcmp(argv[3], "-lz4") == 0);
+
+	if (count < 0)
+	{
+		fprintf(stderr, "Could not build pack: %s\n", argv[2]);
+
+		return 1;
+	}
+
+	printf("Packed %d files into %s\n", count, argv[2]);
+
+	return 0;
+}
+
+#endif
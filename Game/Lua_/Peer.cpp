@@ -2,243 +2,647 @@
 #include "Lua_/Arg.h"
 #include "Lua_/Peer.h"
 #include <cassert>
+#include <vector>
 
 using namespace Lua;
 
-// @brief Data indices
-enum {
-	_not_datai,
-	eDescriptors,	// Descriptor table index
-	eBoxed	// Boxed boolean index
+// @brief Dispatch entry
+struct Entry {
+	char const * mName;	// Interned member name (if 0, entry is unused)
+	int mGetter;// Getter slot in the accessor table (if 0, none)
+	int mSetter;// Setter slot in the accessor table (if 0, none)
+	size_t mOffset;	// Member offset
+	int mType;	// Member type (if -1, key has no member)
+	struct Accessor const * mAccess;// Typed access, for non-array members
+	int mElement;	// Array element type
+	size_t mCount;	// Array element count or count member offset
 };
 
-// @brief Descriptor indices
-enum {
-	_not_desci,
-	eDOffset,	// Offset index
-	eDName,	// Name index
-	eDType	// Type index
+// @brief Member dispatch table
+struct Dispatch {
+	size_t mMult;	// Hash multiplier
+	uInt mShift;// Hash shift
+	bool mBoxed;// If true, datum is boxed
+	Entry mEntries[1];	// Entries (table size follows from shift)
 };
 
-// @brief Gets member fields
-// @return Pointer to field memory
-static uChar * GetFields (lua_State * L)
+// @brief Hashes an interned name
+static size_t Hash (Dispatch const * dispatch, char const * name)
 {
-	lua_rawgeti(L, -1, eDOffset);	// data, key[, value], D, D[key], offset
-	lua_rawgeti(L, -2, eDType);	// data, key[, value], D, D[key], offset, type
+	return ((size_t(name) >> 3) * dispatch->mMult) >> dispatch->mShift;
+}
+
+// @brief Finds the entry for a lookup key
+// @param key Key stack index
+// @return Entry, or 0 if key is not dispatched
+// @note _U1: Dispatch table
+static Entry const * Find (lua_State * L, int key = 2)
+{
+	if (lua_type(L, key) != LUA_TSTRING) return 0;
+
+	// Lua interns strings, so the name is found by address. A miss lands on an unused or
+	// different entry.
+	Dispatch const * dispatch = static_cast<Dispatch const *>(lua_touserdata(L, lua_upvalueindex(1)));
+	char const * name = lua_tostring(L, key);
+	Entry const * entry = dispatch->mEntries + Hash(dispatch, name);
+
+	return entry->mName == name ? entry : 0;
+}
+
+// @brief Gets the object's data
+// @note _U1: Dispatch table
+// @note object: Object being accessed
+static uChar * GetData (lua_State * L)
+{
+	Dispatch const * dispatch = static_cast<Dispatch const *>(lua_touserdata(L, lua_upvalueindex(1)));
+
+	if (dispatch->mBoxed) return *static_cast<uChar **>(UD(L, 1));
+
+	return static_cast<uChar *>(UD(L, 1));
+}
+
+// @brief Loads an integer member
+template<typename T> static void LoadInteger (lua_State * L, uChar * pData)
+{
+	lua_pushinteger(L, *(T *)pData);// ..., integer
+}
+
+// @brief Loads a floating point member
+template<typename T> static void LoadNumber (lua_State * L, uChar * pData)
+{
+	lua_pushnumber(L, *(T *)pData);	// ..., number
+}
+
+// @brief Loads a pointer member
+static void LoadPointer (lua_State * L, uChar * pData)
+{
+	lua_pushlightuserdata(L, *(void **)pData);	// ..., pointer
+}
 
-	return static_cast<uChar *>(UD(L, 1)) + uI(L, -2);
+// @brief Loads a string member
+static void LoadString (lua_State * L, uChar * pData)
+{
+	lua_pushstring(L, *(char **)pData);	// ..., string
 }
 
-#define F_(t, p) lua_pushnumber(L, *(t *)p)
-#define I_(t, p) lua_pushinteger(L, *(t *)p)
+// @brief Loads a boolean member
+static void LoadBoolean (lua_State * L, uChar * pData)
+{
+	lua_pushboolean(L, *(bool *)pData);	// ..., boolean
+}
+
+// @brief Stores a member
+template<typename T, T (*func)(lua_State *, int)> static void Store (lua_State * L, uChar * pData, int arg)
+{
+	*(T *)pData = func(L, arg);
+}
+
+// @brief Typed member access, indexed by member type
+static struct Accessor {
+	void (*mLoad)(lua_State *, uChar *);// Pushes member
+	void (*mStore)(lua_State *, uChar *, int);	// Assigns argument to member
+	size_t mSize;	// Member size
+} const sAccessors[] = {
+	{ LoadPointer, Store<void *, UD>, sizeof(void *) },	// ePointer
+	{ LoadInteger<sChar>, Store<sChar, sC>, sizeof(sChar) },// eSChar
+	{ LoadInteger<sShort>, Store<sShort, sS>, sizeof(sShort) },	// eSShort
+	{ LoadInteger<sLong>, Store<sLong, sL>, sizeof(sLong) },// eSLong
+	{ LoadInteger<sInt>, Store<sInt, sI>, sizeof(sInt) },	// eSInt
+	{ LoadInteger<uChar>, Store<uChar, uC>, sizeof(uChar) },// eUChar
+	{ LoadInteger<uShort>, Store<uShort, uS>, sizeof(uShort) },	// eUShort
+	{ LoadInteger<uLong>, Store<uLong, uL>, sizeof(uLong) },// eULong
+	{ LoadInteger<uInt>, Store<uInt, uI>, sizeof(uInt) },	// eUInt
+	{ LoadString, Store<char const *, S>, sizeof(char const *) },	// eString
+	{ LoadBoolean, Store<bool, B>, sizeof(bool) },	// eBoolean
+	{ LoadNumber<float>, Store<float, F>, sizeof(float) },	// eFloat
+	{ LoadNumber<double>, Store<double, D>, sizeof(double) }// eDouble
+};
 
 // @brief Indexes a member
-// @note data: Object memory
-static void IndexMember (lua_State * L)
+// @param pData Member memory
+// @param type Member type
+static void IndexMember (lua_State * L, uChar * pData, int type)
+{
+	sAccessors[type].mLoad(L, pData);	// ..., value
+}
+
+// @brief Assigns to a member
+// @param pData Member memory
+// @param type Member type
+// @param arg Value stack index
+static void NewIndexMember (lua_State * L, uChar * pData, int type, int arg = 3)
+{
+	sAccessors[type].mStore(L, pData, arg);
+}
+
+// @brief Array member view
+struct View {
+	uChar * mData;	// Array memory, or pointer member of pointer array
+	uInt * mCount;	// Count member of pointer array (if 0, array is fixed-length)
+	size_t mFixed;	// Fixed-length array element count
+	int mElement;	// Element type
+};
+
+// @brief Gets the size of an array element
+static size_t ElementSize (int type)
+{
+	return sAccessors[type].mSize;
+}
+
+// @brief Gets a view's current elements
+// @param count [out] Element count
+// @return Element memory
+static uChar * Elements (View const & view, size_t & count)
+{
+	if (0 == view.mCount)
+	{
+		count = view.mFixed;
+
+		return view.mData;
+	}
+
+	count = *view.mCount;
+
+	return *(uChar **)view.mData;
+}
+
+// @brief Reads a view element
+// @return If true, index was in bounds and element was pushed
+static bool GetElement (lua_State * L, View const & view, lua_Integer index)
+{
+	size_t count;
+	uChar * pData = Elements(view, count);
+
+	if (index < 1 || size_t(index) > count) return false;
+
+	IndexMember(L, pData + (index - 1) * ElementSize(view.mElement), view.mElement);// ..., element
+
+	return true;
+}
+
+// @brief Copies a table into a view
+// @param arg Table stack index
+static void FromTable (lua_State * L, View const & view, int arg)
 {
-	// Point to the requested member.
-	uChar * pData = GetFields(L);	// data, key, D, D[key], offset, type
+#if LUA_CHECKS == LUA_CHECKS_FULL
+	luaL_checktype(L, arg, LUA_TTABLE);
+#else
+	LUA_CHECK_ASSERT(lua_istable(L, arg));
+#endif
 
-	// Return the appropriate type.
-	switch (uI(L, 6))
+	size_t count, size = ElementSize(view.mElement), n = lua_objlen(L, arg);
+	uChar * pData = Elements(view, count);
+
+	if (n > count) luaL_error(L, "Array view: %d elements given, %d available", int(n), int(count));
+
+	for (size_t i = 1; i <= n; ++i, pData += size)
 	{
-	case Member_Reg::ePointer:
-		lua_pushlightuserdata(L, *(void **)pData);	// data, key, D, D[key], offset, type, pointer
-		break;
-	case Member_Reg::eSChar:
-		I_(sChar, pData);	// data, key, D, D[key], offset, type, schar
-		break;
-	case Member_Reg::eSShort:
-		I_(sShort, pData);	// data, key, D, D[key], offset, type, sshort
-		break;
-	case Member_Reg::eSLong:
-		I_(sLong, pData);	// data, key, D, D[key], offset, type, slong
-		break;
-	case Member_Reg::eSInt:
-		I_(sInt, pData);	// data, key, D, D[key], offset, type, sint
-		break;
-	case Member_Reg::eUChar:
-		I_(uChar, pData);	// data, key, D, D[key], offset, type, uchar
-		break;
-	case Member_Reg::eUShort:
-		I_(uShort, pData);	// data, key, D, D[key], offset, type, ushort
-		break;
-	case Member_Reg::eULong:
-		I_(uLong, pData);	// data, key, D, D[key], offset, type, ulong
-		break;
-	case Member_Reg::eUInt:
-		I_(uInt, pData);// data, key, D, D[key], offset, type, uint
-		break;
-	case Member_Reg::eFloat:	
-		F_(float, pData);	// data, key, D, D[key], offset, type, fsingle
-		break;
-	case Member_Reg::eDouble:
-		F_(double, pData);	// data, key, D, D[key], offset, type, fdouble
-		break;
-	case Member_Reg::eString:
-		lua_pushstring(L, *(char **)pData);	// data, key, D, D[key], offset, type, string
-		break;
-	case Member_Reg::eBoolean:
-		lua_pushboolean(L, *(bool *)pData);	// data, key, D, D[key], offset, type, boolean
-		break;
-	default:
-		luaL_error(L, "Member __index: Bad type");
+		lua_rawgeti(L, arg, int(i));// ..., t[i]
+
+		NewIndexMember(L, pData, view.mElement, lua_gettop(L));
+
+		lua_pop(L, 1);	// ...
 	}
 }
 
-#undef F_
-#undef I_
+// @brief Dummy variable; view metatable is cached under its address
+static int _ViewMeta;
 
-template<typename T> static void Set (lua_State * L, uChar * pData, T (*func)(lua_State *, int))
+// @brief Validates and gets a view argument; checked under every policy, since any other
+// userdata would be read as a view
+// @note view: View being accessed
+// @return View
+static View const * GetView (lua_State * L)
 {
-	*(T *)pData = func(L, 3);
+	void * view = lua_touserdata(L, 1);
+
+	if (view != 0 && lua_getmetatable(L, 1))// view, ..., meta
+	{
+		lua_pushlightuserdata(L, &_ViewMeta);	// view, ..., meta, key
+		lua_rawget(L, LUA_REGISTRYINDEX);	// view, ..., meta, view_meta
+
+		bool bIsView = lua_rawequal(L, -1, -2) != 0;
+
+		lua_pop(L, 2);	// view, ...
+
+		if (bIsView) return static_cast<View const *>(view);
+	}
+
+	luaL_typerror(L, 1, "array view");
+
+	return 0;
 }
 
-// @brief Assigns to a member
-// @note data: Object memory
-static void NewIndexMember (lua_State * L)
+// @brief Array view __index metamethod
+// @note _U1: Method table
+// @note view: View being accessed
+// @note key: Element index or method name
+static int ViewIndex (lua_State * L)
 {
-	// Point to the requested member.
-	uChar * pData = GetFields(L);	// data, key, value, D, D[key], offset, type
+	View const * view = GetView(L);
 
-	// Assign the appropriate type.
-	switch (uI(L, 7))
+	if (lua_type(L, 2) == LUA_TNUMBER)
 	{
-	case Member_Reg::ePointer:
-		Set(L, pData, UD);
-		break;
-	case Member_Reg::eSChar:
-		Set(L, pData, sC);
-		break;
-	case Member_Reg::eSShort:
-		Set(L, pData, sS);
-		break;
-	case Member_Reg::eSLong:
-		Set(L, pData, sL);
-		break;
-	case Member_Reg::eSInt:
-		Set(L, pData, sI);
-		break;
-	case Member_Reg::eUChar:
-		Set(L, pData, uC);
-		break;
-	case Member_Reg::eUShort:
-		Set(L, pData, uS);
-		break;
-	case Member_Reg::eULong:
-		Set(L, pData, uL);
-		break;
-	case Member_Reg::eUInt:
-		Set(L, pData, uI);
-		break;
-	case Member_Reg::eFloat:
-		Set(L, pData, F);
-		break;
-	case Member_Reg::eDouble:
-		Set(L, pData, D);
-		break;
-	case Member_Reg::eString:
-		*(char const **)pData = S(L, 3);
-		break;
-	case Member_Reg::eBoolean:
-		Set(L, pData, B);
-		break;
-	default:
-		luaL_error(L, "Member __newindex: Bad type");
+		if (!GetElement(L, *view, lua_tointeger(L, 2))) lua_pushnil(L);	// view, key, nil
+
+		return 1;
 	}
+
+	lua_pushvalue(L, 2);// view, key, key
+	lua_rawget(L, lua_upvalueindex(1));	// view, key, method
+
+	return 1;
 }
 
-// @brief Looks up member data
-// @note _U1: Boxed boolean
-static void Lookup (lua_State * L)
+// @brief Array view __newindex metamethod
+// @note view: View being accessed
+// @note key: Element index
+// @note value: Value to assign
+static int ViewNewIndex (lua_State * L)
 {
-	lua_rawgeti(L, lua_upvalueindex(1), eBoxed);// object, key[, value], bBoxed
+	View const * view = GetView(L);
+#if LUA_CHECKS == LUA_CHECKS_FULL
+	lua_Integer index = luaL_checkinteger(L, 2);
+#else
+	lua_Integer index = lua_tointeger(L, 2);
+#endif
+	size_t count;
+	uChar * pData = Elements(*view, count);
+
+	// Bounds are checked under every policy, since a bad index would write out of bounds.
+	if (index < 1 || size_t(index) > count) luaL_error(L, "Array view: Index %d out of bounds", int(index));
+
+	NewIndexMember(L, pData + (index - 1) * ElementSize(view->mElement), view->mElement);
 
-	bool bBoxed = lua_toboolean(L, -1) != 0;
+	return 0;
+}
+
+// @brief Array view __len metamethod
+// @note view: View being accessed
+static int ViewLen (lua_State * L)
+{
+	size_t count;
 
-	lua_pop(L, 1);	// object, key[, value]
+	Elements(*GetView(L), count);
 
-	if (bBoxed) lua_pushlightuserdata(L, *(void **)UD(L, 1));	// object, key[, value], data
+	lua_pushinteger(L, count);	// view, count
 
-	else lua_pushvalue(L, 1);// object, key[, value], object
+	return 1;
+}
+
+// @brief Copies a view's elements into a new table
+// @note view: View being accessed
+// @return Table
+static int ToTable (lua_State * L)
+{
+	View const * view = GetView(L);
+	size_t count;
+
+	Elements(*view, count);
+
+	lua_createtable(L, int(count), 0);	// view, t
+
+	for (size_t i = 1; i <= count; ++i)
+	{
+		GetElement(L, *view, lua_Integer(i));	// view, t, element
+
+		lua_rawseti(L, -2, int(i));	// view, t = { ..., element }
+	}
+
+	return 1;
+}
+
+// @brief Copies a table's array part into a view
+// @note view: View being accessed
+// @note t: Table of elements
+static int FromTable (lua_State * L)
+{
+	FromTable(L, *GetView(L), 2);
+
+	return 0;
+}
+
+// @brief Builds a view of an array member
+// @param pData Object data
+// @param entry Array member entry
+// @return View
+static View MakeView (uChar * pData, Entry const & entry)
+{
+	View view;
+
+	view.mData = pData + entry.mOffset;
+	view.mCount = entry.mType == Member_Reg::ePointerArray ? (uInt *)(pData + entry.mCount) : 0;
+	view.mFixed = entry.mCount;
+	view.mElement = entry.mElement;
+
+	return view;
+}
+
+// @brief Pushes a view of an array member
+// @param pData Object data
+// @param entry Array member entry
+// @note object: Object being accessed, kept alive by the view
+static void PushView (lua_State * L, uChar * pData, Entry const & entry)
+{
+	*static_cast<View *>(lua_newuserdata(L, sizeof(View))) = MakeView(pData, entry);	// object, ..., view
+
+	// Install the shared metatable, building it on first use.
+	lua_pushlightuserdata(L, &_ViewMeta);	// object, ..., view, key
+	lua_rawget(L, LUA_REGISTRYINDEX);	// object, ..., view, meta?
+
+	if (lua_isnil(L, -1))
+	{
+		luaL_reg methods[] = {
+			{ "fromTable", FromTable },
+			{ "toTable", ToTable },
+			{ 0, 0 }
+		};
+
+		lua_pop(L, 1);	// object, ..., view
+		lua_createtable(L, 0, 3);	// object, ..., view, meta
+		lua_createtable(L, 0, 2);	// object, ..., view, meta, methods
+
+		luaL_register(L, 0, methods);
+
+		lua_pushcclosure(L, ViewIndex, 1);	// object, ..., view, meta, ViewIndex
+		lua_setfield(L, -2, "__index");	// object, ..., view, meta = { __index = ViewIndex }
+		lua_pushcfunction(L, ViewNewIndex);	// object, ..., view, meta, ViewNewIndex
+		lua_setfield(L, -2, "__newindex");	// object, ..., view, meta = { __index, __newindex = ViewNewIndex }
+		lua_pushcfunction(L, ViewLen);	// object, ..., view, meta, ViewLen
+		lua_setfield(L, -2, "__len");	// object, ..., view, meta = { __index, __newindex, __len = ViewLen }
+		lua_pushlightuserdata(L, &_ViewMeta);	// object, ..., view, meta, key
+		lua_pushvalue(L, -2);	// object, ..., view, meta, key, meta
+		lua_rawset(L, LUA_REGISTRYINDEX);	// object, ..., view, meta
+	}
+
+	lua_setmetatable(L, -2);// object, ..., view
+
+	// Anchor the object in the view's environment.
+	lua_createtable(L, 1, 0);	// object, ..., view, env
+	lua_pushvalue(L, 1);// object, ..., view, env, object
+	lua_rawseti(L, -2, 1);	// object, ..., view, env = { object }
+	lua_setfenv(L, -2);	// object, ..., view
+}
+
+// @brief Indexes a member entry; arrays are returned as views
+// @param pData Object data
+// @param entry Member entry
+static void IndexEntry (lua_State * L, uChar * pData, Entry const & entry)
+{
+	if (entry.mType >= Member_Reg::eArray) PushView(L, pData, entry);	// object, ..., view
+
+	else entry.mAccess->mLoad(L, pData + entry.mOffset);	// object, ..., value
+}
+
+// @brief Assigns to a member entry; arrays are copied from a table
+// @param pData Object data
+// @param entry Member entry
+// @param arg Value stack index
+static void NewIndexEntry (lua_State * L, uChar * pData, Entry const & entry, int arg)
+{
+	if (entry.mType >= Member_Reg::eArray) FromTable(L, MakeView(pData, entry), arg);
+
+	else entry.mAccess->mStore(L, pData + entry.mOffset, arg);
+}
+
+// @brief Pushes the data argument for getters and setters
+// @note _U1: Dispatch table
+static void PushData (lua_State * L)
+{
+	Dispatch const * dispatch = static_cast<Dispatch const *>(lua_touserdata(L, lua_upvalueindex(1)));
+
+	if (dispatch->mBoxed) lua_pushlightuserdata(L, *(void **)UD(L, 1));	// object, key[, value], data
+
+	else lua_pushvalue(L, 1);	// object, key[, value], object
 }
 
 // @brief __index closure
-// @note _U1: Member descriptor and boxed boolean
-// @note _U2: Member getter table
+// @note _U1: Dispatch table
+// @note _U2: Accessor table
 // @note object: Object being accessed
 // @note key: Lookup key
 static int Index (lua_State * L)
 {
-	Lookup(L);	// object, key, data
+	Entry const * entry = Find(L);
 
-	// If a getter exists for this member, return the result of its invocation.
-	lua_pushvalue(L, 2);// object, key, data, key
-	lua_gettable(L, lua_upvalueindex(2));	// object, key, data, getter
+	if (0 == entry) return 0;
 
-	if (!lua_isnil(L, 4))
+	// If a getter exists for this member, return the result of its invocation. Accessors are
+	// called as themselves, so they see their own upvalues and environment.
+	if (entry->mGetter != 0)
 	{
+		lua_settop(L, 2);	// object, key
+
+		PushData(L);// object, key, data
+
+		lua_rawgeti(L, lua_upvalueindex(2), entry->mGetter);// object, key, data, getter
 		lua_insert(L, 1);	// getter, object, key, data
 		lua_call(L, 3, 1);	// result
-	}
 
-	// Otherwise, look up the member. If it exists, index it; otherwise, return nil
-	// to let the __index metamethod continue.
-	else
-	{
-		lua_pop(L, 1);	// object, key, data
-		lua_replace(L, 1);	// data, key
+		return 1;
+	}
 
-		// Look up the member. If it exists, index it; otherwise, return nil to let
-		// the __index metamethod continue.
-		lua_rawgeti(L, lua_upvalueindex(1), eDescriptors);	// data, key, D
-		lua_pushvalue(L, 2);// data, key, D, key
-		lua_gettable(L, 3);	// data, key, D, D[key]
+	// Otherwise, index the member if it exists; if not, return nil to let the __index
+	// metamethod continue.
+	if (entry->mType < 0) return 0;
 
-		if (!lua_isnil(L, 4)) IndexMember(L);	// result
-	}
+	IndexEntry(L, GetData(L), *entry);	// object, key, result
 
 	return 1;
 }
 
 // @brief __newindex closure
-// @note _U1: Member descriptor and boxed boolean
-// @note _U2: Member setter table
+// @note _U1: Dispatch table
+// @note _U2: Accessor table
 // @note object: Object being accessed
 // @note key: Lookup key
 // @note value: Value to assign
 static int NewIndex (lua_State * L)
 {
-	Lookup(L);	// object, key, value, data
+	Entry const * entry = Find(L);
 
-	// If a setter exists for this member, invoke it. If it returns a result, propagate
-	// the __newindex call if allowed.
-	lua_pushvalue(L, 2);// object, key, value, data, key
-	lua_gettable(L, lua_upvalueindex(2));	// object, key, value, data, setter
+	if (0 == entry) return 0;
 
-	if (!lua_isnil(L, 5))
+	// If a setter exists for this member, invoke it.
+	if (entry->mSetter != 0)
 	{
+		lua_settop(L, 3);	// object, key, value
+
+		PushData(L);// object, key, value, data
+
+		lua_rawgeti(L, lua_upvalueindex(2), entry->mSetter);// object, key, value, data, setter
 		lua_insert(L, 1);	// setter, object, key, value, data
 		lua_call(L, 4, 0);
 	}
 
-	// Otherwise, look up the member. If it exists, assign to it; otherwise, return a
-	// result to let the __newindex metamethod continue.
+	// Otherwise, assign to the member if it exists.
+	else if (entry->mType >= 0) NewIndexEntry(L, GetData(L), *entry, 3);
+
+	return 0;
+}
+
+// @brief Multi-member get closure
+// @note _U1: Dispatch table
+// @note object: Object being accessed
+// @note ...: Lookup keys
+// @return Values, in key order
+static int MultiGet (lua_State * L)
+{
+	int top = lua_gettop(L);
+
+	luaL_checkstack(L, top, "Too many keys");
+
+	// Load members directly; other keys go through the object's normal lookup.
+	uChar * pData = GetData(L);
+
+	for (int i = 2; i <= top; ++i)
+	{
+		Entry const * entry = Find(L, i);
+
+		if (entry != 0 && 0 == entry->mGetter && entry->mType >= 0) IndexEntry(L, pData, *entry);	// object, ...[, value]
+
+		else
+		{
+			lua_pushvalue(L, i);// object, ...[, key]
+			lua_gettable(L, 1);	// object, ...[, value]
+		}
+	}
+
+	return top - 1;
+}
+
+// @brief Assigns a member, or routes the assignment through the object
+// @param pData Object data
+// @param key Key stack index
+// @param value Value stack index
+static void SetOne (lua_State * L, uChar * pData, int key, int value)
+{
+	Entry const * entry = Find(L, key);
+
+	if (entry != 0 && 0 == entry->mSetter && entry->mType >= 0) NewIndexEntry(L, pData, *entry, value);
+
 	else
 	{
-		lua_pop(L, 1);	// object, key, value, data
-		lua_replace(L, 1);	// data, key, value
-		lua_rawgeti(L, lua_upvalueindex(1), eDescriptors);	// data, key, value, D
-		lua_pushvalue(L, 2);// data, key, value, D, key
-		lua_gettable(L, 4);	// data, key, value, D, D[key]
+		lua_pushvalue(L, key);	// object, ..., key
+		lua_pushvalue(L, value);// object, ..., key, value
+		lua_settable(L, 1);	// object, ...
+	}
+}
+
+// @brief Multi-member set closure
+// @note _U1: Dispatch table
+// @note object: Object being accessed
+// @note ...: Key-value table, or alternating keys and values
+static int MultiSet (lua_State * L)
+{
+	uChar * pData = GetData(L);
+
+	if (lua_istable(L, 2))
+	{
+		lua_settop(L, 2);	// object, t
+
+		for (lua_pushnil(L); lua_next(L, 2) != 0; lua_pop(L, 1)) SetOne(L, pData, 3, 4);	// object, t, k, v
+	}
+
+	else
+	{
+		int top = lua_gettop(L);
+
+		if (top % 2 == 0) luaL_error(L, "Member set: Unpaired key");
 
-		if (!lua_isnil(L, 5)) NewIndexMember(L);
+		for (int i = 2; i < top; i += 2) SetOne(L, pData, i, i + 1);
 	}
 
 	return 0;
 }
 
+// @brief Adds a name to the dispatch set
+// @param L Lua state
+// @param names Name -> entry index table
+// @param name Name to add
+// @param entries Entry list
+// @return Entry for name
+// @note Names are kept alive in the names table, so their interned addresses remain valid
+static Entry & AddName (lua_State * L, int names, char const * name, std::vector<Entry> & entries)
+{
+	lua_getfield(L, names, name);	// ..., index?
+
+	size_t index = lua_tointeger(L, -1);
+
+	lua_pop(L, 1);	// ...
+
+	if (0 == index)
+	{
+		Entry entry = { 0, 0, 0, 0, -1, 0, 0, 0 };
+
+		entries.push_back(entry);
+
+		index = entries.size();
+
+		lua_pushinteger(L, index);	// ..., index
+		lua_setfield(L, names, name);	// ...
+	}
+
+	return entries[index - 1];
+}
+
+// @brief Fits the entries into a collision-free table
+// @param L Lua state
+// @param entries Entry list
+// @param bBoxed If true, datum is boxed
+// @note names: Name -> entry index table
+static void BuildDispatch (lua_State * L, std::vector<Entry> & entries, bool bBoxed)
+{
+	// Resolve the interned names.
+	for (lua_pushnil(L); lua_next(L, -2) != 0; lua_pop(L, 1))
+	{
+		entries[lua_tointeger(L, -1) - 1].mName = lua_tostring(L, -2);	// ..., names, name, index
+	}
+
+	// Starting from the smallest table that holds every entry, try a few multipliers;
+	// double the table on failure. The names are distinct addresses and the hash keeps every
+	// bit of them, so this terminates.
+	uInt bits = 1;
+	size_t seed = size_t(0x9E3779B97F4A7C15ULL);
+
+	while ((1U << bits) < entries.size()) ++bits;
+
+	for (std::vector<char const *> slots; ; ++bits)
+	{
+		for (int attempt = 0; attempt < 32; ++attempt, seed = seed * size_t(6364136223846793005ULL) + size_t(1442695040888963407ULL))
+		{
+			Dispatch probe;
+
+			probe.mMult = seed | 1;
+			probe.mShift = uInt(sizeof(size_t) * 8) - bits;
+
+			slots.assign(1U << bits, 0);
+
+			size_t i = 0;
+
+			for (size_t h; i < entries.size() && 0 == slots[h = Hash(&probe, entries[i].mName)]; ++i) slots[h] = entries[i].mName;
+
+			if (i < entries.size()) continue;
+
+			// Lay out the table, anchoring the names in its environment.
+			Dispatch * dispatch = static_cast<Dispatch *>(lua_newuserdata(L, sizeof(Dispatch) + ((1U << bits) - 1) * sizeof(Entry)));	// ..., names, dispatch
+
+			*dispatch = probe;
+
+			dispatch->mBoxed = bBoxed;
+
+			for (uInt j = 0; j < (1U << bits); ++j) dispatch->mEntries[j].mName = 0;
+
+			for (i = 0; i < entries.size(); ++i) dispatch->mEntries[Hash(dispatch, entries[i].mName)] = entries[i];
+
+			lua_insert(L, -2);	// ..., dispatch, names
+			lua_setfenv(L, -2);	// ..., dispatch
+
+			return;
+		}
+	}
+}
+
 // @brief Pushes __index and __newindex member binding closures onto stack
 // @param L Lua state
 // @param getters [optional] Member getter functions
@@ -252,41 +656,79 @@ void Lua::BindPeer (lua_State * L, luaL_reg const * getters, luaL_reg const * se
 	assert(0 == count || members != 0);
 	assert(getters != 0 || setters != 0 || (members != 0 && count > 0));
 
-	lua_createtable(L, 4, 0);	// data
+	// Gather the getters, setters, and members under their names.
+	std::vector<Entry> entries;
+
+	lua_newtable(L);// accessors
+	lua_newtable(L);// accessors, names
 
-	// Build up member data.
-	lua_createtable(L, 0, count);	// data, M
+	int names = lua_gettop(L);
 
 	for (int i = 0; i < count; ++i)
 	{
-		lua_pushstring(L, members[i].mName.c_str());// data, M, name
-		lua_createtable(L, 2, 0);	// data, M, name, {}
-		lua_pushinteger(L, members[i].mOffset);	// data, M, name, D, offset
-		lua_pushinteger(L, members[i].mType);	// data, M, name, D, offset, type
-		lua_rawseti(L, -3, eDType);	// data, M, name, D = { type = type }, offset
-		lua_rawseti(L, -2, eDOffset);	// data, M, name, D = { type, offset = offset }
-		lua_settable(L, -3);// data, M = { ..., name = D }
-	}
+		Entry & entry = AddName(L, names, members[i].mName.c_str(), entries);
 
-	lua_rawseti(L, -2, eDescriptors);	// data = { descriptors = M }
+		entry.mOffset = members[i].mOffset;
+		entry.mType = members[i].mType;
 
-	// Install lookup information.
-	lua_pushboolean(L, bBoxed);	// data, bBoxed
-	lua_rawseti(L, -2, eBoxed);	// data = { descriptors, bBoxed }
+		// Resolve the member's typed access now, so lookups need no type dispatch.
+		if (entry.mType >= Member_Reg::eArray)
+		{
+			assert(members[i].mElement >= 0 && members[i].mElement < Member_Reg::eArray);
 
-	// Build __index closure.
-	lua_pushvalue(L, -1);	// data, data
-	lua_newtable(L);// data, data, {}
+			entry.mElement = members[i].mElement;
+			entry.mCount = members[i].mCount;
+		}
 
-	if (getters != 0) luaL_register(L, 0, getters);
+		else
+		{
+			assert(entry.mType >= 0);
 
-	lua_pushcclosure(L, Index, 2);	// data, __index
+			entry.mAccess = sAccessors + entry.mType;
+		}
+	}
 
-	// Build __newindex closure.
-	lua_insert(L, -2);	// __index, data
-	lua_newtable(L);// __index, data, {}
+	// Keep the getters and setters as functions in their own right, called through the table.
+	int slot = 0;
 
-	if (setters != 0) luaL_register(L, 0, setters);
+	for (; getters != 0 && getters->name != 0; ++getters)
+	{
+		lua_pushcfunction(L, getters->func);// accessors, names, getter
+		lua_rawseti(L, names - 1, ++slot);	// accessors = { ..., getter }, names
 
+		AddName(L, names, getters->name, entries).mGetter = slot;
+	}
+
+	for (; setters != 0 && setters->name != 0; ++setters)
+	{
+		lua_pushcfunction(L, setters->func);// accessors, names, setter
+		lua_rawseti(L, names - 1, ++slot);	// accessors = { ..., setter }, names
+
+		AddName(L, names, setters->name, entries).mSetter = slot;
+	}
+
+	// Compile the dispatch table and build closures around it.
+	BuildDispatch(L, entries, bBoxed);	// accessors, dispatch
+
+	lua_pushvalue(L, -1);	// accessors, dispatch, dispatch
+	lua_pushvalue(L, -3);	// accessors, dispatch, dispatch, accessors
+	lua_pushcclosure(L, Index, 2);	// accessors, dispatch, __index
+	lua_insert(L, -3);	// __index, accessors, dispatch
+	lua_insert(L, -2);	// __index, dispatch, accessors
 	lua_pushcclosure(L, NewIndex, 2);	// __index, __newindex
-}
\ No newline at end of file
+}
+
+// @brief Pushes multi-member get and set closures onto stack, e.g. to install as methods
+// @param L Lua state
+// @param index Stack index of __index closure from BindPeer
+// @note The closures share the __index closure's dispatch table
+void Lua::BindPeerBatch (lua_State * L, int index)
+{
+	assert(lua_tocfunction(L, index) == Index);
+
+	lua_getupvalue(L, index, 1);// ..., dispatch
+	lua_pushvalue(L, -1);	// ..., dispatch, dispatch
+	lua_pushcclosure(L, MultiGet, 1);	// ..., dispatch, get
+	lua_insert(L, -2);	// ..., get, dispatch
+	lua_pushcclosure(L, MultiSet, 1);	// ..., get, set
+}
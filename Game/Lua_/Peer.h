@@ -3,6 +3,8 @@
 
 #include <string>
 #include "Lua_/Lua.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/Vars.h"
 
 namespace Lua
 {
@@ -16,8 +18,12 @@ namespace Lua
 			eUChar, eUShort, eULong, eUInt,	// Integer primitives, unsigned
 			eString,// String
 			eBoolean,	// Boolean
-			eFloat, eDouble	// Single- and double-precision floating point
+			eFloat, eDouble,// Single- and double-precision floating point
+			eArray,	// Fixed-length array
+			ePointerArray	// Pointer to array, with count member
 		} mType;// Member type
+		Type mElement;	// Array element type
+		size_t mCount;	// Fixed-length array: element count; pointer array: offset of uInt count member
 
 		Member_Reg (void)
 		{
@@ -29,14 +35,72 @@ namespace Lua
 			mName = name;
 			mType = type;
 		}
+
+		void SetArray (size_t offset, std::string const & name, Type element, size_t count)
+		{
+			Set(offset, name, eArray);
+
+			mElement = element;
+			mCount = count;
+		}
+
+		void SetPointerArray (size_t offset, std::string const & name, Type element, size_t count_offset)
+		{
+			Set(offset, name, ePointerArray);
+
+			mElement = element;
+			mCount = count_offset;
+		}
+
+		template<typename C, typename T> void Bind (T C::* member, std::string const & name);
+		template<typename C, typename T, size_t N> void Bind (T (C::* member)[N], std::string const & name);
 	};
 
+	// @brief Member type, deduced from a C++ type (unsupported types do not compile)
+	template<typename T> struct MemberType;
+
+	template<> struct MemberType<char> { enum { eType = Member_Reg::eSChar }; };
+	template<> struct MemberType<signed char> { enum { eType = Member_Reg::eSChar }; };
+	template<> struct MemberType<signed short> { enum { eType = Member_Reg::eSShort }; };
+	template<> struct MemberType<signed long> { enum { eType = Member_Reg::eSLong }; };
+	template<> struct MemberType<signed int> { enum { eType = Member_Reg::eSInt }; };
+	template<> struct MemberType<unsigned char> { enum { eType = Member_Reg::eUChar }; };
+	template<> struct MemberType<unsigned short> { enum { eType = Member_Reg::eUShort }; };
+	template<> struct MemberType<unsigned long> { enum { eType = Member_Reg::eULong }; };
+	template<> struct MemberType<unsigned int> { enum { eType = Member_Reg::eUInt }; };
+	template<> struct MemberType<char const *> { enum { eType = Member_Reg::eString }; };
+	template<> struct MemberType<char *> { enum { eType = Member_Reg::eString }; };
+	template<> struct MemberType<bool> { enum { eType = Member_Reg::eBoolean }; };
+	template<> struct MemberType<float> { enum { eType = Member_Reg::eFloat }; };
+	template<> struct MemberType<double> { enum { eType = Member_Reg::eDouble }; };
+	template<typename T> struct MemberType<T *> { enum { eType = Member_Reg::ePointer }; };
+
+	// @brief Describes a member, deducing its type
+	// @param member Member pointer
+	// @param name Member name
+	template<typename C, typename T> void Member_Reg::Bind (T C::* member, std::string const & name)
+	{
+		Set(Schema<C>::Offset(member), name, Type(MemberType<T>::eType));
+	}
+
+	// @brief Describes a fixed-length array member, deducing its element type
+	// @param member Member pointer
+	// @param name Member name
+	template<typename C, typename T, size_t N> void Member_Reg::Bind (T (C::* member)[N], std::string const & name)
+	{
+		SetArray(Schema<C>::Offset(member), name, Type(MemberType<T>::eType), N);
+	}
+
 	void BindPeer (lua_State * L, luaL_reg const * getters, luaL_reg const * setters, Member_Reg const * members, int count, bool bBoxed);
 
+	void BindPeerBatch (lua_State * L, int index);
+
 	template<int count> void BindPeer (lua_State * L, luaL_reg const * getters, luaL_reg const * setters, Member_Reg (&members)[count], bool bBoxed)
 	{
 		BindPeer(L, getters, setters, members, count, bBoxed);
 	}
 }
 
+#define Lua_Member(reg, type, name) (reg).Bind(&type::name, #name)
+
 #endif // LUA_PEER_H
\ No newline at end of file
@@ -0,0 +1,523 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Arrays.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Lua;
+
+#ifdef _MSC_VER
+	typedef unsigned __int64 uInt64;
+#else
+	typedef unsigned long long uInt64;
+#endif
+
+// @brief Dummy variables; the named stream table and stream metatable are cached under their addresses
+static int _Streams;
+static int _StreamMeta;
+
+// @brief xoshiro256** generator state
+struct Stream {
+	uInt64 mS[4];	// State words; never all zero
+
+	// @brief Seeds the state via splitmix64, as recommended for xoshiro
+	// @param seed Seed value
+	void Seed (uInt64 seed)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			uInt64 z = (seed += 0x9E3779B97F4A7C15ULL);
+
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+			mS[i] = z ^ (z >> 31);
+		}
+	}
+
+	// @brief Advances the generator
+	// @return Next 64 random bits
+	uInt64 Next (void)
+	{
+		uInt64 result = Rotl(mS[1] * 5, 7) * 9;
+		uInt64 t = mS[1] << 17;
+
+		mS[2] ^= mS[0];
+		mS[3] ^= mS[1];
+		mS[1] ^= mS[2];
+		mS[0] ^= mS[3];
+		mS[2] ^= t;
+		mS[3] = Rotl(mS[3], 45);
+
+		return result;
+	}
+
+	// @brief Draws a uniform number in [0, 1), with 53 bits of precision
+	double Uniform (void)
+	{
+		return double(Next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	// @brief Draws a uniform integer in [lo, hi]
+	double Integer (double lo, double hi)
+	{
+		return lo + std::floor(Uniform() * (hi - lo + 1));
+	}
+
+	// @brief Draws a pair of standard normal numbers, via the Box-Muller transform
+	void Gaussian (double & g1, double & g2)
+	{
+		double r = std::sqrt(-2.0 * std::log(1.0 - Uniform())), theta = 6.283185307179586 * Uniform();
+
+		g1 = r * std::cos(theta);
+		g2 = r * std::sin(theta);
+	}
+
+	static uInt64 Rotl (uInt64 x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+};
+
+// @brief Hashes a name into a seed offset (FNV-1a)
+static uInt64 Hash (char const * name, size_t len)
+{
+	uInt64 hash = 0xCBF29CE484222325ULL;
+
+	for (size_t i = 0; i < len; ++i) hash = (hash ^ uChar(name[i])) * 0x100000001B3ULL;
+
+	return hash;
+}
+
+// @brief Gets a seed argument
+static uInt64 GetSeed (lua_State * L, int arg)
+{
+	return uInt64(std::fabs(luaL_checknumber(L, arg)));
+}
+
+/*%%%%%%%%%%%%%%%% DRAWS %%%%%%%%%%%%%%%%*/
+
+// @brief Draws a number in [a, b), as per math_ex.Rand
+// @note a, b: Bounds
+static int Rand (lua_State * L, Stream & S, int arg)
+{
+	lua_Number a = luaL_checknumber(L, arg), b = luaL_checknumber(L, arg + 1);
+
+	lua_pushnumber(L, a + (b - a) * S.Uniform());	// ..., n
+
+	return 1;
+}
+
+// @brief Draws a number in [x - dx, x + dx), as per math_ex.RBy
+// @note x: Center value
+// @note dx: Spread
+static int RBy (lua_State * L, Stream & S, int arg)
+{
+	lua_Number x = luaL_checknumber(L, arg), dx = luaL_checknumber(L, arg + 1);
+
+	lua_pushnumber(L, x + dx * (2 * S.Uniform() - 1));	// ..., n
+
+	return 1;
+}
+
+// @brief Draws a number, as per math.random
+// @note [m, n]: If absent, draws in [0, 1); with m, draws an integer in [1, m]; with both,
+// draws an integer in [m, n]
+static int Random (lua_State * L, Stream & S, int arg)
+{
+	switch (lua_gettop(L) - arg + 1)
+	{
+	case 0:
+		lua_pushnumber(L, S.Uniform());	// ..., n
+		break;
+	case 1:
+		{
+			lua_Number m = luaL_checknumber(L, arg);
+
+			luaL_argcheck(L, m >= 1, arg, "interval is empty");
+
+			lua_pushnumber(L, S.Integer(1, std::floor(m)));	// ..., n
+		}
+		break;
+	default:
+		{
+			lua_Number m = luaL_checknumber(L, arg), n = luaL_checknumber(L, arg + 1);
+
+			luaL_argcheck(L, m <= n, arg + 1, "interval is empty");
+
+			lua_pushnumber(L, S.Integer(std::floor(m), std::floor(n)));	// ..., n
+		}
+	}
+
+	return 1;
+}
+
+// @brief Draws a normally distributed number
+// @note [mean]: Mean; if absent, 0
+// @note [sd]: Standard deviation; if absent, 1
+static int Gaussian (lua_State * L, Stream & S, int arg)
+{
+	lua_Number mean = luaL_optnumber(L, arg, 0), sd = luaL_optnumber(L, arg + 1, 1);
+	double g1, g2;
+
+	S.Gaussian(g1, g2);
+
+	lua_pushnumber(L, mean + sd * g1);	// ..., n
+
+	return 1;
+}
+
+/*%%%%%%%%%%%%%%%% BULK FILL %%%%%%%%%%%%%%%%*/
+
+// @brief Fill distributions
+enum FillKind { eUniform, eRange, eGaussian };
+
+// @brief Fills a buffer with draws
+// @param out Buffer to fill
+// @param count Element count
+// @param kind Distribution
+// @param a, b Bounds (range) or mean and standard deviation (gaussian)
+template<typename T> void _fillT (Stream & S, T * out, uInt count, FillKind kind, double a, double b)
+{
+	switch (kind)
+	{
+	case eUniform:
+		for (uInt i = 0; i < count; ++i) out[i] = T(S.Uniform());
+		break;
+	case eRange:
+		for (uInt i = 0; i < count; ++i) out[i] = T(a + (b - a) * S.Uniform());
+		break;
+	case eGaussian:
+		for (uInt i = 0; i < count; i += 2)
+		{
+			double g1, g2;
+
+			S.Gaussian(g1, g2);
+
+			out[i] = T(a + b * g1);
+
+			if (i + 1 < count) out[i + 1] = T(a + b * g2);
+		}
+		break;
+	}
+}
+
+// @brief Integer arrays take integers in [a, b] for ranges, and rounded draws otherwise
+template<> void _fillT<sInt> (Stream & S, sInt * out, uInt count, FillKind kind, double a, double b)
+{
+	if (eRange == kind)
+	{
+		for (uInt i = 0; i < count; ++i) out[i] = sInt(S.Integer(a, b));
+	}
+
+	// Draw in batches, then round them into place. The batch size is even, so gaussian pairs
+	// come out as in one pass.
+	else
+	{
+		double buffer[64];
+
+		for (uInt i = 0; i < count; i += ArrayN(buffer))
+		{
+			uInt n = count - i < uInt(ArrayN(buffer)) ? count - i : uInt(ArrayN(buffer));
+
+			_fillT(S, buffer, n, kind, a, b);
+
+			for (uInt j = 0; j < n; ++j) out[i + j] = sInt(std::floor(buffer[j] + .5));
+		}
+	}
+}
+
+// @brief Fills a typed array or table with draws
+// @note target: Float32Array, Float64Array, Int32Array, or table
+// @note kind: "uniform", "range" or "gaussian"
+// @note [a, b]: Range bounds; or mean and standard deviation (by default, 0 and 1)
+// @note [count]: Count to fill; if absent, the whole array, or #table
+// @return target
+static int Fill (lua_State * L, Stream & S, int arg)
+{
+	char const * kinds[] = { "uniform", "range", "gaussian", 0 };
+
+	FillKind kind = FillKind(luaL_checkoption(L, arg + 1, 0, kinds));
+	double a = luaL_optnumber(L, arg + 2, 0), b = luaL_optnumber(L, arg + 3, eGaussian == kind ? 1 : 0);
+
+	lua_settop(L, arg + 4);	// ..., target, kind, a, b, count
+	lua_pushvalue(L, arg);	// ..., target, kind, a, b, count, target
+
+	if (lua_istable(L, arg))
+	{
+		uInt count = lua_isnil(L, arg + 4) ? uInt(lua_objlen(L, arg)) : uI(L, arg + 4);
+
+		// Draw in batches, then write them out.
+		double buffer[64];
+
+		for (uInt i = 0; i < count; i += ArrayN(buffer))
+		{
+			uInt n = count - i < uInt(ArrayN(buffer)) ? count - i : uInt(ArrayN(buffer));
+
+			_fillT(S, buffer, n, kind, a, b);
+
+			for (uInt j = 0; j < n; ++j)
+			{
+				lua_pushnumber(L, buffer[j]);	// ..., target, kind, a, b, count, target, n
+				lua_rawseti(L, arg, int(i + j + 1));// ..., target, kind, a, b, count, target
+			}
+		}
+	}
+
+	else if (Class::IsType(L, arg, _arraynameT<float>()))
+	{
+		Array<float> * A = _arrayT<float>(L, arg);
+
+		_fillT(S, A->mData, lua_isnil(L, arg + 4) ? A->mCount : std::min(uI(L, arg + 4), A->mCount), kind, a, b);
+	}
+
+	else if (Class::IsType(L, arg, _arraynameT<double>()))
+	{
+		Array<double> * A = _arrayT<double>(L, arg);
+
+		_fillT(S, A->mData, lua_isnil(L, arg + 4) ? A->mCount : std::min(uI(L, arg + 4), A->mCount), kind, a, b);
+	}
+
+	else
+	{
+		Array<sInt> * A = _arrayT<sInt>(L, arg);
+
+		_fillT(S, A->mData, lua_isnil(L, arg + 4) ? A->mCount : std::min(uI(L, arg + 4), A->mCount), kind, a, b);
+	}
+
+	return 1;
+}
+
+/*%%%%%%%%%%%%%%%% STATE %%%%%%%%%%%%%%%%*/
+
+// @brief Gets the generator state, for saving and replays
+// @return State string
+static int GetState (lua_State * L, Stream & S, int)
+{
+	uChar bytes[sizeof(S.mS)];
+
+	// Write the words out little-endian, so states carry across platforms.
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 8; ++j) bytes[i * 8 + j] = uChar(S.mS[i] >> (j * 8));
+	}
+
+	lua_pushlstring(L, (char const *)bytes, sizeof(bytes));	// ..., state
+
+	return 1;
+}
+
+// @brief Restores the generator state
+// @note state: State string, from GetState
+static int SetState (lua_State * L, Stream & S, int arg)
+{
+	size_t len;
+	uChar const * bytes = (uChar const *)luaL_checklstring(L, arg, &len);
+
+	luaL_argcheck(L, len == sizeof(S.mS), arg, "Bad state");
+
+	for (int i = 0; i < 4; ++i)
+	{
+		S.mS[i] = 0;
+
+		for (int j = 0; j < 8; ++j) S.mS[i] |= uInt64(bytes[i * 8 + j]) << (j * 8);
+	}
+
+	luaL_argcheck(L, (S.mS[0] | S.mS[1] | S.mS[2] | S.mS[3]) != 0, arg, "Bad state");
+
+	return 0;
+}
+
+// @brief Reseeds the generator
+// @note seed: Seed value
+static int Seed (lua_State * L, Stream & S, int arg)
+{
+	S.Seed(GetSeed(L, arg));
+
+	return 0;
+}
+
+/*%%%%%%%%%%%%%%%% BINDINGS %%%%%%%%%%%%%%%%*/
+
+// @brief Validates a stream argument
+// @param L Lua state
+// @param index Stack index of stream
+// @return Stream; raises an error if the argument is not one
+static Stream * CheckStream (lua_State * L, int index)
+{
+	void * ud = lua_touserdata(L, index);
+
+	if (ud != 0 && lua_getmetatable(L, index))	// ..., meta
+	{
+		lua_pushlightuserdata(L, &_StreamMeta);	// ..., meta, key
+		lua_rawget(L, LUA_REGISTRYINDEX);	// ..., meta, smeta
+
+		bool bMatch = lua_rawequal(L, -1, -2) != 0;
+
+		lua_pop(L, 2);	// ...
+
+		if (bMatch) return static_cast<Stream *>(ud);
+	}
+
+	luaL_typerror(L, index, "stream");
+
+	return 0;
+}
+
+// @brief Binds an operation as a stream method
+template<int (*op)(lua_State *, Stream &, int)> int _methodT (lua_State * L)
+{
+	return op(L, *CheckStream(L, 1), 2);
+}
+
+// @brief Binds an operation to the default stream
+// @note _U1: Default stream
+template<int (*op)(lua_State *, Stream &, int)> int _defaultT (lua_State * L)
+{
+	return op(L, *(Stream *)lua_touserdata(L, lua_upvalueindex(1)), 1);
+}
+
+// @brief Pushes the named stream table
+static void PushStreams (lua_State * L)
+{
+	lua_pushlightuserdata(L, &_Streams);// ..., key
+	lua_rawget(L, LUA_REGISTRYINDEX);	// ..., streams?
+
+	if (lua_isnil(L, -1))
+	{
+		lua_pop(L, 1);	// ...
+		lua_newtable(L);// ..., streams
+		lua_pushlightuserdata(L, &_Streams);// ..., streams, key
+		lua_pushvalue(L, -2);	// ..., streams, key, streams
+		lua_rawset(L, LUA_REGISTRYINDEX);	// ..., streams
+	}
+}
+
+// @brief Pushes a new stream, with the methods bound through its metatable
+// @note Streams are plain userdata rather than a class, so the library can be opened before boot
+static void NewStream (lua_State * L)
+{
+	lua_newuserdata(L, sizeof(Stream));	// ..., stream
+	lua_pushlightuserdata(L, &_StreamMeta);	// ..., stream, key
+	lua_rawget(L, LUA_REGISTRYINDEX);	// ..., stream, meta
+
+	lua_setmetatable(L, -2);// ..., stream
+}
+
+// @brief Gets a named stream, creating it on first use
+// @note name: Stream name
+// @note [seed]: Seed for a new stream; if absent, 0. Streams are seeded with the seed mixed
+// with their name, so that streams sharing a seed stay independent
+// @return Stream
+static int GetStream (lua_State * L)
+{
+	size_t len;
+	char const * name = luaL_checklstring(L, 1, &len);
+
+	lua_settop(L, 2);	// name, seed
+
+	PushStreams(L);	// name, seed, streams
+
+	lua_pushvalue(L, 1);// name, seed, streams, name
+	lua_rawget(L, 3);	// name, seed, streams, stream?
+
+	if (lua_isnil(L, -1))
+	{
+		lua_pop(L, 1);	// name, seed, streams
+
+		NewStream(L);	// name, seed, streams, stream
+
+		((Stream *)UD(L, 4))->Seed(Hash(name, len) ^ (lua_isnil(L, 2) ? 0 : GetSeed(L, 2)));
+
+		lua_pushvalue(L, 1);// name, seed, streams, stream, name
+		lua_pushvalue(L, 4);// name, seed, streams, stream, name, stream
+		lua_rawset(L, 3);	// name, seed, streams = { ..., name = stream }
+	}
+
+	return 1;
+}
+
+// @brief Reseeds every named stream, e.g. to start a replay
+// @note seed: Seed value; each stream mixes in its name, as with GetStream
+static int SeedAll (lua_State * L)
+{
+	uInt64 seed = GetSeed(L, 1);
+
+	PushStreams(L);	// seed, streams
+
+	for (lua_pushnil(L); lua_next(L, 2) != 0; lua_pop(L, 1))
+	{
+		size_t len;
+		char const * name = lua_tolstring(L, -2, &len);
+
+		((Stream *)UD(L, -1))->Seed(Hash(name, len) ^ seed);
+	}
+
+	return 0;
+}
+
+// @brief Opens the random_core library
+// @param L Lua state
+// @return 0
+int Bindings::open_random (lua_State * L)
+{
+	luaL_reg methods[] = {
+		{ "Fill", _methodT<Fill> },
+		{ "Gaussian", _methodT<Gaussian> },
+		{ "GetState", _methodT<GetState> },
+		{ "RBy", _methodT<RBy> },
+		{ "Rand", _methodT<Rand> },
+		{ "Random", _methodT<Random> },
+		{ "Seed", _methodT<Seed> },
+		{ "SetState", _methodT<SetState> },
+		{ 0, 0 }
+	};
+
+	lua_pushlightuserdata(L, &_StreamMeta);	// key
+	lua_createtable(L, 0, 1);	// key, meta
+	lua_newtable(L);// key, meta, methods
+
+	luaL_register(L, 0, methods);
+
+	lua_setfield(L, -2, "__index");	// key, meta = { __index = methods }
+	lua_rawset(L, LUA_REGISTRYINDEX);	//
+
+	// Register the library. The plain draws go to the default stream, which is bound to
+	// each as an upvalue to keep per-call overhead down.
+	luaL_reg funcs[] = {
+		{ "SeedAll", SeedAll },
+		{ "Stream", GetStream },
+		{ 0, 0 }
+	};
+
+	luaL_reg defaults[] = {
+		{ "Fill", _defaultT<Fill> },
+		{ "Gaussian", _defaultT<Gaussian> },
+		{ "GetState", _defaultT<GetState> },
+		{ "RBy", _defaultT<RBy> },
+		{ "Rand", _defaultT<Rand> },
+		{ "Random", _defaultT<Random> },
+		{ "Seed", _defaultT<Seed> },
+		{ "SetState", _defaultT<SetState> },
+		{ 0, 0 }
+	};
+
+	luaL_register(L, "random_core", funcs);	// core
+
+	lua_pushcfunction(L, GetStream);// core, GetStream
+	lua_pushliteral(L, "default");	// core, GetStream, "default"
+	lua_call(L, 1, 1);	// core, stream
+
+	for (int i = 0; defaults[i].name != 0; ++i)
+	{
+		lua_pushvalue(L, -1);	// core, stream, stream
+		lua_pushcclosure(L, defaults[i].func, 1);	// core, stream, func
+		lua_setfield(L, -3, defaults[i].name);	// core = { ..., name = func }, stream
+	}
+
+	lua_pop(L, 2);
+
+	return 0;
+}
@@ -0,0 +1,492 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include <new>
+#include <vector>
+
+using namespace Lua;
+
+// @brief Dummy variable; the index metatable is cached under its address
+static int _IndexMeta;
+
+// @brief Marker node
+// @note A marker's position is the sum of the gaps of every marker up to and including it
+struct Node {
+	sInt mGap;	// Distance from the previous marker (or from 0, for the first)
+	sInt mSum;	// Sum of gaps in this subtree
+	uInt mLeft, mRight, mParent;// Links (0 = none)
+	uInt mPriority;	// Treap priority
+	bool mStrict;	// If true, inserts at the marker's own position leave it in place
+	bool mLive;	// If true, the marker is in the tree
+};
+
+// @brief Sequence index: an order-statistic treap over markers, rather than items, so costs
+// scale with the marker count and edits shift everything past them in O(log n)
+struct SequenceIndex {
+	std::vector<Node> mNodes;	// Nodes; 0 is a dummy, so ids are indices
+	uInt mRoot;	// Root node (0 = empty)
+	uInt mFree;	// First free node, linked through mRight (0 = none)
+	uInt mCount;// Live marker count
+	uInt mSeed;	// Priority generator state
+
+	SequenceIndex (void) : mNodes(1), mRoot(0), mFree(0), mCount(0), mSeed(0x9E3779B9)
+	{
+		mNodes[0].mSum = 0;
+	}
+
+	Node & operator [] (uInt i) { return mNodes[i]; }
+
+	// @brief Recomputes a node's sum and its children's back links
+	void Update (uInt t)
+	{
+		Node & n = mNodes[t];
+
+		n.mSum = mNodes[n.mLeft].mSum + n.mGap + mNodes[n.mRight].mSum;
+
+		if (n.mLeft) mNodes[n.mLeft].mParent = t;
+		if (n.mRight) mNodes[n.mRight].mParent = t;
+	}
+
+	// @brief Splits a subtree where a monotone predicate on (position, strict) turns true
+	// @param t Subtree
+	// @param acc Position preceding the subtree
+	// @param l [out] Nodes where the predicate is false
+	// @param r [out] Nodes where the predicate is true
+	template<typename P> void Split (uInt t, sInt acc, P const & pred, uInt & l, uInt & r)
+	{
+		if (0 == t) l = r = 0;
+
+		else
+		{
+			Node & n = mNodes[t];
+			sInt pos = acc + mNodes[n.mLeft].mSum + n.mGap;
+
+			if (pred(pos, n.mStrict))
+			{
+				Split(n.mLeft, acc, pred, l, mNodes[t].mLeft);
+
+				r = t;
+			}
+
+			else
+			{
+				Split(n.mRight, pos, pred, mNodes[t].mRight, r);
+
+				l = t;
+			}
+
+			Update(t);
+		}
+	}
+
+	// @brief Joins two subtrees, all of whose nodes in l precede those in r
+	uInt Merge (uInt l, uInt r)
+	{
+		if (0 == l || 0 == r) return l ? l : r;
+
+		if (mNodes[l].mPriority > mNodes[r].mPriority)
+		{
+			mNodes[l].mRight = Merge(mNodes[l].mRight, r);
+
+			Update(l);
+
+			return l;
+		}
+
+		else
+		{
+			mNodes[r].mLeft = Merge(l, mNodes[r].mLeft);
+
+			Update(r);
+
+			return r;
+		}
+	}
+
+	// @brief Adds to the gap of a subtree's first node
+	void AddToFirst (uInt t, sInt delta)
+	{
+		if (0 == t) return;
+
+		uInt first = t;
+
+		while (mNodes[first].mLeft) first = mNodes[first].mLeft;
+
+		mNodes[first].mGap += delta;
+
+		Refresh(first);
+	}
+
+	// @brief Recomputes sums from a node up to the root
+	void Refresh (uInt t)
+	{
+		for (; t != 0; t = mNodes[t].mParent) Update(t);
+	}
+
+	// @brief Finalizes a new root
+	void SetRoot (uInt t)
+	{
+		mRoot = t;
+
+		if (t) mNodes[t].mParent = 0;
+	}
+
+	// @brief Gets a marker's position
+	sInt Position (uInt t) const
+	{
+		sInt pos = mNodes[mNodes[t].mLeft].mSum + mNodes[t].mGap;
+
+		for (uInt p = mNodes[t].mParent; p != 0; t = p, p = mNodes[p].mParent)
+		{
+			if (mNodes[p].mRight == t) pos += mNodes[mNodes[p].mLeft].mSum + mNodes[p].mGap;
+		}
+
+		return pos;
+	}
+
+	// @brief Indicates whether an id refers to a live marker
+	bool IsLive (uInt id) const
+	{
+		return id > 0 && id < mNodes.size() && mNodes[id].mLive;
+	}
+
+	uInt NextPriority (void)
+	{
+		mSeed ^= mSeed << 13;
+		mSeed ^= mSeed >> 17;
+		mSeed ^= mSeed << 5;
+
+		return mSeed;
+	}
+};
+
+// @brief Predicate: the marker is at or past a position
+struct AtOrPast {
+	sInt mPos;
+
+	AtOrPast (sInt pos) : mPos(pos) {}
+
+	bool operator () (sInt pos, bool) const { return pos >= mPos; }
+};
+
+// @brief Predicate: the marker moves on an insert at a position; strict markers move only if past it
+struct MovesOnInsert {
+	sInt mPos;
+
+	MovesOnInsert (sInt pos) : mPos(pos) {}
+
+	bool operator () (sInt pos, bool bStrict) const { return pos > mPos || (pos == mPos && !bStrict); }
+};
+
+// @brief Gets the index
+static SequenceIndex * GetIndex (lua_State * L)
+{
+	return (SequenceIndex *)UD(L, 1);
+}
+
+// @brief Validates a position argument
+static sInt GetPos (lua_State * L, int arg)
+{
+	sInt pos = sI(L, arg);
+
+	luaL_argcheck(L, pos >= 0, arg, "Negative position");
+
+	return pos;
+}
+
+// @brief Adds a marker
+// @note pos: Position
+// @note strict: If true, inserts at the marker's own position leave it in place (as for
+// interval bounds); otherwise, they push it ahead (as for spots). At equal positions, strict
+// markers precede the others
+// @return Marker id
+static int Add (lua_State * L)
+{
+	SequenceIndex * S = GetIndex(L);
+	sInt pos = GetPos(L, 2);
+	bool bStrict = lua_toboolean(L, 3) != 0;
+
+	// Claim a node.
+	uInt t = S->mFree;
+
+	if (t != 0) S->mFree = (*S)[t].mRight;
+
+	else
+	{
+		t = uInt(S->mNodes.size());
+
+		S->mNodes.push_back(Node());
+	}
+
+	// Split where the marker goes, carve its gap out of its successor's, and put it in.
+	uInt l, r;
+
+	if (bStrict) S->Split(S->mRoot, 0, AtOrPast(pos), l, r);
+
+	else S->Split(S->mRoot, 0, MovesOnInsert(pos), l, r);
+
+	Node & n = (*S)[t];
+
+	n.mGap = pos - (*S)[l].mSum;
+	n.mLeft = n.mRight = n.mParent = 0;
+	n.mPriority = S->NextPriority();
+	n.mStrict = bStrict;
+	n.mLive = true;
+
+	S->Update(t);
+	S->SetRoot(r);
+	S->AddToFirst(r, -n.mGap);
+	S->SetRoot(S->Merge(S->Merge(l, t), r));
+
+	++S->mCount;
+
+	lua_pushinteger(L, t);	// S, pos, strict, id
+
+	return 1;
+}
+
+// @brief Gets a marker's position
+// @note id: Marker id
+// @return Position, or nil if the marker was removed
+static int Get (lua_State * L)
+{
+	SequenceIndex * S = GetIndex(L);
+	uInt id = uI(L, 2);
+
+	if (S->IsLive(id)) lua_pushinteger(L, S->Position(id));	// S, id, pos
+
+	else lua_pushnil(L);// S, id, nil
+
+	return 1;
+}
+
+// @brief Gets the ids of every marker, in order
+// @return Array of ids
+static int Ids (lua_State * L)
+{
+	SequenceIndex * S = GetIndex(L);
+
+	lua_createtable(L, int(S->mCount), 0);	// S, ids
+
+	int n = 0;
+
+	for (uInt i = 1; i < S->mNodes.size(); ++i)
+	{
+		if ((*S)[i].mLive)
+		{
+			lua_pushinteger(L, i);	// S, ids, id
+			lua_rawseti(L, -2, ++n);// S, ids = { ..., id }
+		}
+	}
+
+	return 1;
+}
+
+// @brief Shifts markers for an insertion
+// @note index: Insertion position
+// @note count: Count of inserted items
+static int Insert (lua_State * L)
+{
+	SequenceIndex * S = GetIndex(L);
+	sInt index = sI(L, 2), count = sI(L, 3);
+	uInt l, r;
+
+	S->Split(S->mRoot, 0, MovesOnInsert(index), l, r);
+	S->SetRoot(r);
+	S->AddToFirst(r, count);
+	S->SetRoot(S->Merge(l, r));
+
+	return 0;
+}
+
+// @brief Releases a detached node
+static void Release (SequenceIndex * S, uInt t)
+{
+	(*S)[t].mLive = false;
+	(*S)[t].mRight = S->mFree;
+
+	S->mFree = t;
+
+	--S->mCount;
+}
+
+// @brief Removes a marker; its gap passes to its successor, so no other marker moves
+// @note id: Marker id
+static int Remove (lua_State * L)
+{
+	SequenceIndex * S = GetIndex(L);
+	uInt id = uI(L, 2);
+
+	if (S->IsLive(id))
+	{
+		Node & n = (*S)[id];
+
+		// Hand the gap on to the successor, if any.
+		uInt next = n.mRight;
+
+		if (next != 0)
+		{
+			while ((*S)[next].mLeft) next = (*S)[next].mLeft;
+		}
+
+		else
+		{
+			for (uInt t = id, p = n.mParent; p != 0; t = p, p = (*S)[p].mParent)
+			{
+				if ((*S)[p].mLeft == t)
+				{
+					next = p;
+
+					break;
+				}
+			}
+		}
+
+		if (next != 0)
+		{
+			(*S)[next].mGap += n.mGap;
+
+			S->Refresh(next);
+		}
+
+		// Splice the marker's children together in its place.
+		uInt parent = n.mParent, child = S->Merge(n.mLeft, n.mRight);
+
+		if (0 == parent) S->SetRoot(child);
+
+		else
+		{
+			if ((*S)[parent].mLeft == id) (*S)[parent].mLeft = child;
+
+			else (*S)[parent].mRight = child;
+
+			S->Refresh(parent);
+		}
+
+		Release(S, id);
+	}
+
+	return 0;
+}
+
+// @brief Collects a subtree's ids in order, releasing the nodes
+// @param ids Stack index of id array
+// @param n [in-out] Ids collected
+static void Collect (lua_State * L, SequenceIndex * S, uInt t, int ids, int & n)
+{
+	if (0 == t) return;
+
+	uInt left = (*S)[t].mLeft, right = (*S)[t].mRight;
+
+	Collect(L, S, left, ids, n);
+
+	lua_pushinteger(L, t);	// ..., ids, id
+	lua_rawseti(L, ids, ++n);	// ..., ids = { ..., id }
+
+	Release(S, t);
+
+	Collect(L, S, right, ids, n);
+}
+
+// @brief Shifts markers for a removal, removing the markers inside the range
+// @note index: Position of first removed item
+// @note count: Count of removed items
+// @return Array of ids of the removed markers, in order, or nil if none; the caller can
+// add them back wherever they belong
+static int RemoveRange (lua_State * L)
+{
+	lua_settop(L, 3);	// S, index, count
+
+	SequenceIndex * S = GetIndex(L);
+	sInt index = sI(L, 2), count = sI(L, 3);
+	uInt l, m, r;
+
+	S->Split(S->mRoot, 0, AtOrPast(index), l, m);
+	S->Split(m, (*S)[l].mSum, AtOrPast(index + count), m, r);
+
+	// The first marker past the range absorbs the removed markers' gaps, less the items.
+	S->SetRoot(r);
+	S->AddToFirst(r, (*S)[m].mSum - count);
+	S->SetRoot(S->Merge(l, r));
+
+	if (0 == m) return 0;
+
+	(*S)[m].mParent = 0;
+
+	lua_newtable(L);// S, index, count, ids
+
+	int n = 0;
+
+	Collect(L, S, m, 4, n);
+
+	return 1;
+}
+
+// @brief __gc metamethod
+static int GC (lua_State * L)
+{
+	GetIndex(L)->~SequenceIndex();
+
+	return 0;
+}
+
+// @brief __len metamethod
+// @return Marker count
+static int Len (lua_State * L)
+{
+	lua_pushinteger(L, GetIndex(L)->mCount);// S, count
+
+	return 1;
+}
+
+// @brief Creates a new sequence index
+// @return Index
+static int New (lua_State * L)
+{
+	new (lua_newuserdata(L, sizeof(SequenceIndex))) SequenceIndex;	// S
+
+	lua_pushlightuserdata(L, &_IndexMeta);	// S, key
+	lua_rawget(L, LUA_REGISTRYINDEX);	// S, meta
+	lua_setmetatable(L, -2);// S
+
+	return 1;
+}
+
+// @brief Opens the sequence_core library
+// @param L Lua state
+// @return 0
+int Bindings::open_sequence (lua_State * L)
+{
+	luaL_reg methods[] = {
+		{ "Add", Add },
+		{ "Get", Get },
+		{ "Ids", Ids },
+		{ "Insert", Insert },
+		{ "Remove", Remove },
+		{ "RemoveRange", RemoveRange },
+		{ 0, 0 }
+	};
+
+	lua_pushlightuserdata(L, &_IndexMeta);	// key
+	lua_createtable(L, 0, 3);	// key, meta
+	lua_newtable(L);// key, meta, methods
+
+	luaL_register(L, 0, methods);
+
+	lua_setfield(L, -2, "__index");	// key, meta = { __index = methods }
+	lua_pushcfunction(L, GC);	// key, meta, GC
+	lua_setfield(L, -2, "__gc");// key, meta = { __index, __gc = GC }
+	lua_pushcfunction(L, Len);	// key, meta, Len
+	lua_setfield(L, -2, "__len");	// key, meta = { __index, __gc, __len = Len }
+	lua_rawset(L, LUA_REGISTRYINDEX);	//
+
+	luaL_reg funcs[] = {
+		{ "New", New },
+		{ 0, 0 }
+	};
+
+	Register(L, "sequence_core", funcs);
+
+	return 0;
+}
@@ -0,0 +1,890 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include "Lua_/Types.h"
+#include <SCRIPT_MANAGER>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#endif
+
+using namespace Lua;
+
+// @brief Stream tags
+enum {
+	_not_tag,
+	eNil,	// nil
+	eFalse,	// false
+	eTrue,	// true
+	eInteger,	// Integral number: zigzag varint
+	eNumber,// Other number: raw double
+	eString,// New string: varint length, bytes; gets next string id
+	eStringRef,	// Repeated string: varint string id
+	eTable,	// New table: varint array count, array values, key-value pairs, eEnd; gets next object id
+	eInstance,	// New class instance: type name, hook state; gets next object id
+	eObjectRef,	// Repeated table or instance: varint object id
+	eVec3D,	// Vec3D: x, y, z floats
+	eColor,	// Color: byte count, raw bytes
+	eEnd	// End of table pairs
+};
+
+// @brief Stream header: magic and format version
+static char const sHeader[] = { 'L', 'S', 'E', 'R', 1 };
+
+// @brief Maximum nesting depth, to keep recursion off the end of the C stack
+static int const sMaxDepth = 512;
+
+// @brief Bytes a file writer buffers before flushing them
+static size_t const sChunkSize = 64 * 1024;
+
+// @brief Dummy variables; hook table, writer metatable, class.Linearization and class.Type are cached under their addresses
+static int _Hooks;
+static int _WriterMeta;
+static int _Linearization;
+static int _Type;
+
+/*%%%%%%%%%%%%%%%% WRITING %%%%%%%%%%%%%%%%*/
+
+// @brief Stream writer; accumulates a buffer, or streams to a file in chunks
+struct Writer {
+	std::vector<char> mBuffer;	// Output; with a file, only what is not yet flushed
+	std::string mPath;	// File path
+	FILE * mFile;	// File, if streaming
+	bool mFailed;	// If true, a file write failed
+
+	Writer (void) : mFile(0), mFailed(false) {}
+
+	// @brief Closes and removes an unfinished file
+	~Writer (void)
+	{
+		Discard();
+	}
+
+	// @brief Writes bytes
+	void Put (void const * data, size_t size)
+	{
+		char const * bytes = static_cast<char const *>(data);
+
+		mBuffer.insert(mBuffer.end(), bytes, bytes + size);
+
+		if (mFile != 0 && mBuffer.size() >= sChunkSize) Flush();
+	}
+
+	// @brief Writes any buffered bytes to the file
+	void Flush (void)
+	{
+		if (!mBuffer.empty() && fwrite(&mBuffer[0], 1, mBuffer.size(), mFile) != mBuffer.size()) mFailed = true;
+
+		mBuffer.clear();
+	}
+
+	// @brief Flushes and closes the file
+	// @return If true, every write succeeded
+	bool Close (void)
+	{
+		Flush();
+
+		bool bClosed = fclose(mFile) == 0;
+
+		mFile = 0;
+
+		return bClosed && !mFailed;
+	}
+
+	// @brief Closes and removes the file, if still open
+	void Discard (void)
+	{
+		if (0 == mFile) return;
+
+		fclose(mFile);
+		remove(mPath.c_str());
+
+		mFile = 0;
+	}
+
+	void PutByte (int byte)
+	{
+		char c = char(byte);
+
+		Put(&c, 1);
+	}
+
+	// @brief Writes an unsigned LEB128 varint
+	void PutVarint (uLong value)
+	{
+		do {
+			int byte = int(value & 0x7F);
+
+			value >>= 7;
+
+			PutByte(value != 0 ? byte | 0x80 : byte);
+		} while (value != 0);
+	}
+};
+
+// @brief Writer __gc metamethod
+static int WriterGC (lua_State * L)
+{
+	static_cast<Writer *>(lua_touserdata(L, 1))->~Writer();
+
+	return 0;
+}
+
+// @brief Pushes a new writer, which cleans up after itself if an error unwinds the stack
+// @return Writer
+static Writer * NewWriter (lua_State * L)
+{
+	Writer * writer = new (lua_newuserdata(L, sizeof(Writer))) Writer;	// ..., writer
+
+	lua_pushlightuserdata(L, &_WriterMeta);	// ..., writer, key
+	lua_rawget(L, LUA_REGISTRYINDEX);	// ..., writer, meta?
+
+	if (lua_isnil(L, -1))
+	{
+		lua_pop(L, 1);	// ..., writer
+		lua_createtable(L, 0, 1);	// ..., writer, meta
+		lua_pushcfunction(L, WriterGC);	// ..., writer, meta, WriterGC
+		lua_setfield(L, -2, "__gc");// ..., writer, meta = { __gc = WriterGC }
+		lua_pushlightuserdata(L, &_WriterMeta);	// ..., writer, meta, key
+		lua_pushvalue(L, -2);	// ..., writer, meta, key, meta
+		lua_rawset(L, LUA_REGISTRYINDEX);	// ..., writer, meta
+	}
+
+	lua_setmetatable(L, -2);// ..., writer
+
+	writer->Put(sHeader, sizeof(sHeader));
+
+	return writer;
+}
+
+// @brief Pushes the hook table
+static void PushHooks (lua_State * L)
+{
+	lua_pushlightuserdata(L, &_Hooks);	// ..., key
+	lua_rawget(L, LUA_REGISTRYINDEX);	// ..., hooks?
+
+	if (lua_isnil(L, -1))
+	{
+		lua_pop(L, 1);	// ...
+		lua_newtable(L);// ..., hooks
+		lua_pushlightuserdata(L, &_Hooks);	// ..., hooks, key
+		lua_pushvalue(L, -2);	// ..., hooks, key, hooks
+		lua_rawset(L, LUA_REGISTRYINDEX);	// ..., hooks
+	}
+}
+
+// @brief Encoder state
+// @note Stack: ..., writer, strings, objects, hooks, at the indices below
+struct Encoder {
+	Writer * mWriter;	// Output
+	int mStrings;	// Stack index of string -> id map
+	int mObjects;	// Stack index of table / instance -> id map
+	int mHooks;	// Stack index of type -> { save, load } map
+	int mStringCount;	// Strings assigned an id so far
+	int mObjectCount;	// Objects assigned an id so far
+};
+
+// @brief Looks up the id of an already-seen value, or assigns the next one
+// @param map Stack index of id map
+// @param arg Stack index of value
+// @param count [in-out] Ids assigned so far
+// @return Existing id, or 0 if a new id was assigned
+static int Intern (lua_State * L, int map, int arg, int & count)
+{
+	lua_pushvalue(L, arg);	// ..., value
+	lua_rawget(L, map);	// ..., id?
+
+	int id = int(lua_tointeger(L, -1));
+
+	lua_pop(L, 1);	// ...
+
+	if (0 == id)
+	{
+		lua_pushvalue(L, arg);	// ..., value
+		lua_pushinteger(L, ++count);// ..., value, id
+		lua_rawset(L, map);	// ...
+	}
+
+	return id;
+}
+
+static void Encode (lua_State * L, Encoder & enc, int arg, int depth);
+
+// @brief Pushes the name of an instance's type and its serialize hook
+// @param arg Stack index of instance
+// @note Hidden classes all report class.Hidden as their type, so a hidden instance goes to the most
+// derived hooked type it belongs to, i.e. the one with the longest linearization
+static void PushHook (lua_State * L, Encoder & enc, int arg)
+{
+	CacheAndGet(L, "class.Type", &_Type);	// ..., class.Type
+	lua_pushvalue(L, arg);	// ..., class.Type, I
+	lua_call(L, 1, 1);	// ..., type
+
+	if (!lua_isstring(L, -1))
+	{
+		lua_pushnil(L);	// ..., hidden, nil
+
+		int best = 0;
+
+		for (lua_pushnil(L); lua_next(L, enc.mHooks) != 0; lua_pop(L, 1))
+		{
+			if (lua_type(L, -2) != LUA_TSTRING || !Class::IsType(L, arg, lua_tostring(L, -2))) continue;
+
+			CacheAndGet(L, "class.Linearization", &_Linearization);	// ..., hidden, best?, htype, hook, class.Linearization
+			lua_pushvalue(L, -3);	// ..., hidden, best?, htype, hook, class.Linearization, htype
+			lua_call(L, 1, 1);	// ..., hidden, best?, htype, hook, size
+
+			int size = int(lua_tointeger(L, -1));
+
+			lua_pop(L, 1);	// ..., hidden, best?, htype, hook
+
+			if (size > best)
+			{
+				best = size;
+
+				lua_pushvalue(L, -2);	// ..., hidden, best?, htype, hook, htype
+				lua_replace(L, -4);	// ..., hidden, htype, htype, hook
+			}
+		}
+
+		if (lua_isnil(L, -1)) luaL_error(L, "No serialize hook for instance of hidden type");
+
+		lua_replace(L, -2);	// ..., type
+	}
+
+	lua_pushvalue(L, -1);	// ..., type, type
+	lua_rawget(L, enc.mHooks);	// ..., type, hook?
+
+	if (!lua_istable(L, -1)) luaL_error(L, "No serialize hook for type \"%s\"", lua_tostring(L, -2));
+}
+
+// @brief Encodes a class instance, via Vec3D / Color support or its type's hook
+// @param arg Stack index of instance
+static void EncodeInstance (lua_State * L, Encoder & enc, int arg, int depth)
+{
+	if (Class::IsType(L, arg, "Vec3D"))
+	{
+		Types::Vec3D & v = Types::Vec3D_r(L, arg);
+		float xyz[] = { v.x, v.y, v.z };
+
+		enc.mWriter->PutByte(eVec3D);
+		enc.mWriter->Put(xyz, sizeof(xyz));
+
+		return;
+	}
+
+	if (Class::IsType(L, arg, "Color"))
+	{
+		// Colors are written as raw bytes, so streams are only portable across matching layouts.
+		enc.mWriter->PutByte(eColor);
+		enc.mWriter->PutByte(int(sizeof(Types::Color)));
+		enc.mWriter->Put(&Types::Color_r(L, arg), sizeof(Types::Color));
+
+		return;
+	}
+
+	// References to an instance already written reuse its id.
+	int id = Intern(L, enc.mObjects, arg, enc.mObjectCount);
+
+	if (id != 0)
+	{
+		enc.mWriter->PutByte(eObjectRef);
+		enc.mWriter->PutVarint(id);
+
+		return;
+	}
+
+	// Write the type name, then whatever state the save hook yields.
+	PushHook(L, enc, arg);	// ..., type, hook
+
+	enc.mWriter->PutByte(eInstance);
+
+	Encode(L, enc, lua_gettop(L) - 1, depth + 1);
+
+	lua_rawgeti(L, -1, 1);	// ..., type, hook, save
+	lua_pushvalue(L, arg);	// ..., type, hook, save, I
+	lua_call(L, 1, 1);	// ..., type, hook, state
+
+	Encode(L, enc, lua_gettop(L), depth + 1);
+
+	lua_pop(L, 3);	// ...
+}
+
+// @brief Encodes a table
+// @param arg Stack index of table
+static void EncodeTable (lua_State * L, Encoder & enc, int arg, int depth)
+{
+	int id = Intern(L, enc.mObjects, arg, enc.mObjectCount);
+
+	if (id != 0)
+	{
+		enc.mWriter->PutByte(eObjectRef);
+		enc.mWriter->PutVarint(id);
+
+		return;
+	}
+
+	// Write the array part, holes included, then the remaining pairs.
+	int n = GetN(L, arg);
+
+	enc.mWriter->PutByte(eTable);
+	enc.mWriter->PutVarint(n);
+
+	for (int i = 1; i <= n; ++i)
+	{
+		lua_rawgeti(L, arg, i);	// ..., v
+
+		Encode(L, enc, lua_gettop(L), depth + 1);
+
+		lua_pop(L, 1);	// ...
+	}
+
+	for (lua_pushnil(L); lua_next(L, arg) != 0; lua_pop(L, 1))
+	{
+		if (lua_type(L, -2) == LUA_TNUMBER)
+		{
+			lua_Number k = lua_tonumber(L, -2);
+
+			if (k >= 1 && k <= n && k == std::floor(k)) continue;
+		}
+
+		int top = lua_gettop(L);
+
+		Encode(L, enc, top - 1, depth + 1);
+		Encode(L, enc, top, depth + 1);
+	}
+
+	enc.mWriter->PutByte(eEnd);
+}
+
+// @brief Encodes a value
+// @param arg Stack index of value
+// @param depth Current nesting depth
+static void Encode (lua_State * L, Encoder & enc, int arg, int depth)
+{
+	if (depth > sMaxDepth) luaL_error(L, "Serialize: nesting too deep");
+
+	luaL_checkstack(L, 8, "Serialize");
+
+	switch (lua_type(L, arg))
+	{
+	case LUA_TNIL:
+		enc.mWriter->PutByte(eNil);
+		break;
+	case LUA_TBOOLEAN:
+		enc.mWriter->PutByte(lua_toboolean(L, arg) ? eTrue : eFalse);
+		break;
+	case LUA_TNUMBER:
+		{
+			lua_Number n = lua_tonumber(L, arg);
+
+			// Integral values are zigzagged, so small magnitudes of either sign stay short.
+			if (n == std::floor(n) && n >= -2147483648.0 && n <= 2147483647.0)
+			{
+				sLong i = sLong(n);
+
+				enc.mWriter->PutByte(eInteger);
+				enc.mWriter->PutVarint(i < 0 ? (uLong(~i) << 1) | 1 : uLong(i) << 1);
+			}
+
+			else
+			{
+				double d = n;
+
+				enc.mWriter->PutByte(eNumber);
+				enc.mWriter->Put(&d, sizeof(d));
+			}
+		}
+		break;
+	case LUA_TSTRING:
+		{
+			int id = Intern(L, enc.mStrings, arg, enc.mStringCount);
+
+			if (id != 0)
+			{
+				enc.mWriter->PutByte(eStringRef);
+				enc.mWriter->PutVarint(id);
+			}
+
+			else
+			{
+				size_t len;
+				char const * str = lua_tolstring(L, arg, &len);
+
+				enc.mWriter->PutByte(eString);
+				enc.mWriter->PutVarint(len);
+				enc.mWriter->Put(str, len);
+			}
+		}
+		break;
+	case LUA_TTABLE:
+		EncodeTable(L, enc, arg, depth);
+		break;
+	case LUA_TUSERDATA:
+		if (Class::IsInstance(L, arg))
+		{
+			EncodeInstance(L, enc, arg, depth);
+
+			break;
+		}
+		// Fall through.
+	default:
+		luaL_error(L, "Serialize: cannot write a %s", luaL_typename(L, arg));
+	}
+}
+
+// @brief Encodes the value at index 1
+// @param writer Writer, on the stack top
+// @note Pushes the string map, object map and hook table
+static void EncodeValue (lua_State * L, Writer * writer)
+{
+	Encoder enc = { writer, 0, 0, 0, 0, 0 };
+
+	lua_newtable(L);// value, ..., writer, strings
+	lua_newtable(L);// value, ..., writer, strings, objects
+
+	PushHooks(L);	// value, ..., writer, strings, objects, hooks
+
+	enc.mStrings = lua_gettop(L) - 2;
+	enc.mObjects = enc.mStrings + 1;
+	enc.mHooks = enc.mStrings + 2;
+
+	Encode(L, enc, 1, 0);
+}
+
+/*%%%%%%%%%%%%%%%% READING %%%%%%%%%%%%%%%%*/
+
+// @brief Decoder state
+// @note Stack: ..., strings, objects, hooks, at the indices below
+struct Decoder {
+	uChar const * mPos;	// Read position
+	uChar const * mEnd;	// End of stream
+	int mStrings;	// Stack index of id -> string array
+	int mObjects;	// Stack index of id -> table / instance array
+	int mHooks;	// Stack index of type -> { save, load } map
+	int mStringCount;	// Strings read so far
+	int mObjectCount;	// Objects read so far
+};
+
+// @brief Reads bytes
+static void Get (lua_State * L, Decoder & dec, void * data, size_t size)
+{
+	if (size_t(dec.mEnd - dec.mPos) < size) luaL_error(L, "Deserialize: truncated stream");
+
+	std::memcpy(data, dec.mPos, size);
+
+	dec.mPos += size;
+}
+
+static int GetByte (lua_State * L, Decoder & dec)
+{
+	uChar byte;
+
+	Get(L, dec, &byte, 1);
+
+	return byte;
+}
+
+// @brief Reads an unsigned LEB128 varint
+static uLong GetVarint (lua_State * L, Decoder & dec)
+{
+	uLong value = 0;
+
+	for (int shift = 0; ; shift += 7)
+	{
+		int byte = GetByte(L, dec);
+
+		if (shift > 28) luaL_error(L, "Deserialize: bad varint");
+
+		value |= uLong(byte & 0x7F) << shift;
+
+		if (!(byte & 0x80)) return value;
+	}
+}
+
+// @brief Pushes an object by id
+static void PushObject (lua_State * L, Decoder & dec, uLong id)
+{
+	if (id < 1 || id > uLong(dec.mObjectCount)) luaL_error(L, "Deserialize: bad object reference");
+
+	lua_rawgeti(L, dec.mObjects, int(id));	// ..., object?
+
+	// Instances are only registered once their load hook returns.
+	if (lua_isnil(L, -1)) luaL_error(L, "Deserialize: instance referenced from its own state");
+}
+
+// @brief Decodes a value and pushes it
+// @param depth Current nesting depth
+static void Decode (lua_State * L, Decoder & dec, int depth)
+{
+	if (depth > sMaxDepth) luaL_error(L, "Deserialize: nesting too deep");
+
+	luaL_checkstack(L, 8, "Deserialize");
+
+	switch (GetByte(L, dec))
+	{
+	case eNil:
+		lua_pushnil(L);	// ..., nil
+		break;
+	case eFalse:
+	case eTrue:
+		lua_pushboolean(L, dec.mPos[-1] == eTrue);	// ..., b
+		break;
+	case eInteger:
+		{
+			uLong u = GetVarint(L, dec);
+
+			lua_pushnumber(L, u & 1 ? -lua_Number(u >> 1) - 1 : lua_Number(u >> 1));	// ..., n
+		}
+		break;
+	case eNumber:
+		{
+			double d;
+
+			Get(L, dec, &d, sizeof(d));
+
+			lua_pushnumber(L, d);	// ..., n
+		}
+		break;
+	case eString:
+		{
+			uLong len = GetVarint(L, dec);
+
+			if (uLong(dec.mEnd - dec.mPos) < len) luaL_error(L, "Deserialize: truncated stream");
+
+			lua_pushlstring(L, (char const *)dec.mPos, len);// ..., str
+			lua_pushvalue(L, -1);	// ..., str, str
+			lua_rawseti(L, dec.mStrings, ++dec.mStringCount);	// ..., str
+
+			dec.mPos += len;
+		}
+		break;
+	case eStringRef:
+		{
+			uLong id = GetVarint(L, dec);
+
+			if (id < 1 || id > uLong(dec.mStringCount)) luaL_error(L, "Deserialize: bad string reference");
+
+			lua_rawgeti(L, dec.mStrings, int(id));	// ..., str
+		}
+		break;
+	case eTable:
+		{
+			uLong count = GetVarint(L, dec);
+
+			// Each array value takes at least a byte, which bounds the presize.
+			if (count > uLong(dec.mEnd - dec.mPos)) luaL_error(L, "Deserialize: bad table size");
+
+			int n = int(count);
+
+			lua_createtable(L, n, 0);	// ..., t
+			lua_pushvalue(L, -1);	// ..., t, t
+			lua_rawseti(L, dec.mObjects, ++dec.mObjectCount);	// ..., t
+
+			for (int i = 1; i <= n; ++i)
+			{
+				Decode(L, dec, depth + 1);	// ..., t, v
+
+				lua_rawseti(L, -2, i);	// ..., t = { ..., v }
+			}
+
+			while (dec.mPos < dec.mEnd && *dec.mPos != eEnd)
+			{
+				Decode(L, dec, depth + 1);	// ..., t, k
+				Decode(L, dec, depth + 1);	// ..., t, k, v
+
+				if (lua_isnil(L, -2)) luaL_error(L, "Deserialize: nil key");
+
+				lua_rawset(L, -3);	// ..., t = { ..., k = v }
+			}
+
+			if (GetByte(L, dec) != eEnd) luaL_error(L, "Deserialize: truncated stream");
+		}
+		break;
+	case eInstance:
+		{
+			int id = ++dec.mObjectCount;
+
+			Decode(L, dec, depth + 1);	// ..., type
+
+			lua_pushvalue(L, -1);	// ..., type, type
+			lua_rawget(L, dec.mHooks);	// ..., type, hook?
+
+			if (!lua_istable(L, -1)) luaL_error(L, "No serialize hook for type \"%s\"", lua_tostring(L, -2));
+
+			lua_rawgeti(L, -1, 2);	// ..., type, hook, load
+
+			Decode(L, dec, depth + 1);	// ..., type, hook, load, state
+
+			lua_call(L, 1, 1);	// ..., type, hook, I
+			lua_replace(L, -3);	// ..., I, hook
+			lua_pop(L, 1);	// ..., I
+			lua_pushvalue(L, -1);	// ..., I, I
+			lua_rawseti(L, dec.mObjects, id);	// ..., I
+		}
+		break;
+	case eObjectRef:
+		PushObject(L, dec, GetVarint(L, dec));	// ..., object
+		break;
+	case eVec3D:
+		{
+			float xyz[3];
+
+			Get(L, dec, xyz, sizeof(xyz));
+
+			Types::Vec3D v;
+
+			v.x = xyz[0];
+			v.y = xyz[1];
+			v.z = xyz[2];
+
+			Lua_Class_New(L, "Vec3D", "u", &v);	// ..., v
+		}
+		break;
+	case eColor:
+		{
+			if (GetByte(L, dec) != int(sizeof(Types::Color))) luaL_error(L, "Deserialize: Color layout mismatch");
+
+			Types::Color color;
+
+			Get(L, dec, &color, sizeof(color));
+
+			Lua_Class_New(L, "Color", "u", &color);	// ..., color
+		}
+		break;
+	default:
+		luaL_error(L, "Deserialize: bad tag %d", int(dec.mPos[-1]));
+	}
+}
+
+// @brief Decodes a stream and pushes its value
+// @param data Stream
+// @param size Stream size
+static void DecodeStream (lua_State * L, void const * data, size_t size)
+{
+	Decoder dec = { static_cast<uChar const *>(data), static_cast<uChar const *>(data) + size, 0, 0, 0, 0, 0 };
+
+	if (size < sizeof(sHeader) || std::memcmp(data, sHeader, sizeof(sHeader)) != 0) luaL_error(L, "Deserialize: not a serialized stream, or wrong version");
+
+	dec.mPos += sizeof(sHeader);
+
+	lua_newtable(L);// ..., strings
+	lua_newtable(L);// ..., strings, objects
+
+	PushHooks(L);	// ..., strings, objects, hooks
+
+	dec.mStrings = lua_gettop(L) - 2;
+	dec.mObjects = dec.mStrings + 1;
+	dec.mHooks = dec.mStrings + 2;
+
+	Decode(L, dec, 0);	// ..., strings, objects, hooks, value
+
+	if (dec.mPos != dec.mEnd) luaL_error(L, "Deserialize: trailing data");
+
+	lua_replace(L, dec.mStrings);	// ..., value, objects, hooks
+	lua_pop(L, 2);	// ..., value
+}
+
+/*%%%%%%%%%%%%%%%% BINDINGS %%%%%%%%%%%%%%%%*/
+
+// @brief Serializes a value into a string
+// @note value: Value to serialize
+// @return Stream string
+static int Encode (lua_State * L)
+{
+	lua_settop(L, 1);	// value
+
+	Writer * writer = NewWriter(L);	// value, writer
+
+	EncodeValue(L, writer);	// value, writer, strings, objects, hooks
+
+	lua_pushlstring(L, writer->mBuffer.empty() ? "" : &writer->mBuffer[0], writer->mBuffer.size());	// value, writer, strings, objects, hooks, stream
+
+	return 1;
+}
+
+// @brief Deserializes a value from a string
+// @note stream: Stream string
+// @return Value
+static int Decode (lua_State * L)
+{
+	size_t size;
+	char const * data = luaL_checklstring(L, 1, &size);
+
+	DecodeStream(L, data, size);// stream, value
+
+	return 1;
+}
+
+// @brief Moves a file over another, replacing it
+// @return If true, the file was moved
+static bool Replace (char const * from, char const * to)
+{
+#ifdef _WIN32
+	return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(from, to) == 0;
+#endif
+}
+
+// @brief Encodes a value into a streaming writer, under protection
+// @note value: Value to encode
+// @note writer: Writer
+static int SaveValue (lua_State * L)
+{
+	EncodeValue(L, static_cast<Writer *>(lua_touserdata(L, 2)));	// value, writer, strings, objects, hooks
+
+	return 0;
+}
+
+// @brief Serializes a value into a file
+// @note name: File name
+// @note value: Value to serialize
+// @return true, or nil and an error message
+// @note The stream is written to name.tmp in chunks as it is encoded, and only moved over the file
+// once complete, so a failure at any point leaves an earlier save intact
+static int Save (lua_State * L)
+{
+	lua_settop(L, 2);	// name, value
+	lua_insert(L, 1);	// value, name
+
+	char const * name = S(L, 2);
+	Writer * writer = NewWriter(L);	// value, name, writer
+
+	lua_pushfstring(L, "%s.tmp", name);	// value, name, writer, temp
+
+	char const * temp = lua_tostring(L, -1);
+
+	writer->mPath = temp;
+	writer->mFile = fopen(temp, "wb");
+
+	if (0 == writer->mFile)
+	{
+		lua_pushnil(L);	// value, name, writer, temp, nil
+		lua_pushfstring(L, "Could not open file: %s", temp);// value, name, writer, temp, nil, error
+
+		return 2;
+	}
+
+	// Encode the value, removing the partial file at once if an error interrupts it.
+	lua_pushcfunction(L, SaveValue);// value, name, writer, temp, SaveValue
+	lua_pushvalue(L, 1);// value, name, writer, temp, SaveValue, value
+	lua_pushvalue(L, 3);// value, name, writer, temp, SaveValue, value, writer
+
+	if (lua_pcall(L, 2, 0, 0) != 0)	// value, name, writer, temp[, error]
+	{
+		writer->Discard();
+
+		lua_error(L);
+	}
+
+	if (!writer->Close() || !Replace(temp, name))
+	{
+		remove(temp);
+
+		lua_pushnil(L);	// value, name, writer, temp, nil
+		lua_pushfstring(L, "Could not write file: %s", name);	// value, name, writer, temp, nil, error
+
+		return 2;
+	}
+
+	lua_pushboolean(L, true);	// value, name, writer, temp, true
+
+	return 1;
+}
+
+// @brief Deserializes a value from a file
+// @note name: File name
+// @return Value, or nil and an error message
+static int Load (lua_State * L)
+{
+	char const * name = S(L, 1);
+
+	FILE_STREAM * pIn = CREATE_FILESTREAM(name, 0);
+
+	if (0 == pIn)
+	{
+		lua_pushnil(L);	// name, nil
+		lua_pushfstring(L, "Could not open file: %s", name);// name, nil, error
+
+		return 2;
+	}
+
+	// Read the file into a string first, so an error while decoding leaks nothing.
+	int size = pIn->GetSize();
+
+	TEMP_BUFFER<16 * 1024> buffer(size + 1);
+
+	pIn->Read(buffer.GetBuffer(), size);
+	pIn->Close();
+
+	lua_pushlstring(L, (char const *)buffer.GetBuffer(), size_t(size));	// name, stream
+
+	size_t len;
+	char const * data = lua_tolstring(L, -1, &len);
+
+	DecodeStream(L, data, len);	// name, stream, value
+
+	return 1;
+}
+
+// @brief Registers a class's serialize hooks
+// @note type: Class type name
+// @note save: Called as save(I); returns the instance state, which must itself be serializable
+// @note load: Called as load(state); returns a new instance
+// @note If save and load are nil, the hooks are removed
+// @note Hidden classes are hooked by their real name; their instances use the most derived hooked type they belong to
+static int SetHook (lua_State * L)
+{
+	luaL_checkstring(L, 1);
+
+	lua_settop(L, 3);	// type, save, load
+
+	PushHooks(L);	// type, save, load, hooks
+
+	lua_pushvalue(L, 1);// type, save, load, hooks, type
+
+	if (lua_isnil(L, 2) && lua_isnil(L, 3)) lua_pushnil(L);	// type, save, load, hooks, type, nil
+
+	else
+	{
+		luaL_argcheck(L, IsCallable(L, 2), 2, "Uncallable save hook");
+		luaL_argcheck(L, IsCallable(L, 3), 3, "Uncallable load hook");
+
+		lua_createtable(L, 2, 0);	// type, save, load, hooks, type, hook
+		lua_pushvalue(L, 2);// type, save, load, hooks, type, hook, save
+		lua_rawseti(L, -2, 1);	// type, save, load, hooks, type, hook = { save }
+		lua_pushvalue(L, 3);// type, save, load, hooks, type, hook, load
+		lua_rawseti(L, -2, 2);	// type, save, load, hooks, type, hook = { save, load }
+	}
+
+	lua_rawset(L, 4);	// type, save, load, hooks = { ..., type = hook }
+
+	return 0;
+}
+
+// @brief Opens the binary serializer
+// @note Registered as serialize_core
+int Bindings::open_serialize (lua_State * L)
+{
+	luaL_reg funcs[] = {
+		{ "Decode", Decode },
+		{ "Encode", Encode },
+		{ "Load", Load },
+		{ "Save", Save },
+		{ "SetHook", SetHook },
+		{ 0, 0 }
+	};
+
+	Register(L, "serialize_core", funcs);
+
+	return 0;
+}
@@ -0,0 +1,400 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include <cmath>
+#include <new>
+#include <vector>
+
+using namespace Lua;
+
+// @brief Handle layout: generation * sSlotRange + slot
+static lua_Number const sSlotRange = 16777216.0;
+static uInt const sMaxGeneration = 1U << 28;
+
+// @brief Dummy variable; the extras table is stored in the environment under its address
+static int _Extras;
+
+// @brief Slot map instance data
+// @note Values are kept densely in the environment's array part, in step with mDense
+struct SlotMap {
+	std::vector<uInt> mDense;	// Dense index - 1 -> slot
+	std::vector<uInt> mIndex;	// Slot -> dense index, if live; else next vacant slot (0 if none)
+	std::vector<uInt> mGeneration;	// Slot -> generation
+	uInt mFree;	// First vacant slot (if 0, none)
+
+	SlotMap (void) : mIndex(1, 0), mGeneration(1, 0), mFree(0) {}
+
+	// @brief Resolves a handle to its dense index
+	// @return Dense index, or 0 if the handle is stale or bad
+	uInt Find (lua_Number handle) const
+	{
+		if (!(handle >= sSlotRange)) return 0;
+
+		lua_Number gen = std::floor(handle / sSlotRange);
+		uInt slot = uInt(handle - gen * sSlotRange);
+
+		return slot > 0 && slot < mIndex.size() && mGeneration[slot] == uInt(gen) ? mIndex[slot] : 0;
+	}
+
+	// @brief Gets the handle of an element
+	// @param index Dense index
+	lua_Number Handle (uInt index) const
+	{
+		uInt slot = mDense[index - 1];
+
+		return lua_Number(mGeneration[slot]) * sSlotRange + slot;
+	}
+};
+
+// @brief Gets the instance data and environment
+// @return Instance data
+// @note Pushes the environment
+static SlotMap * GetMap (lua_State * L)
+{
+	SlotMap * S = (SlotMap *)UD(L, 1);
+
+	lua_getfenv(L, 1);	// S, ..., env
+
+	return S;
+}
+
+// @brief Validates a dense index argument
+// @return Dense index
+static uInt GetIndex (lua_State * L, SlotMap * S, int arg)
+{
+	uInt index = uI(L, arg);
+
+#if LUA_CHECKS == LUA_CHECKS_FULL
+	if (index < 1 || index > S->mDense.size()) luaL_error(L, "Arg #%d: index out of range", arg);
+#else
+	LUA_CHECK_ASSERT(index >= 1 && index <= S->mDense.size());
+#endif
+
+	return index;
+}
+
+// @brief Removes an element, moving the last element into its place
+// @param index Dense index
+// @param env Stack index of environment
+// @param bClear If true, the element is not dropped into the extras
+static void RemoveAt (lua_State * L, SlotMap * S, uInt index, int env, bool bClear)
+{
+	uInt slot = S->mDense[index - 1];
+	uInt last = uInt(S->mDense.size());
+
+	// Drop the element into the extras, unless it is being cleared.
+	if (!bClear)
+	{
+		lua_rawgeti(L, env, index);	// ..., element
+
+		if (!lua_isnil(L, -1))
+		{
+			lua_pushlightuserdata(L, &_Extras);	// ..., element, key
+			lua_rawget(L, env);	// ..., element, extras
+
+			lua_insert(L, -2);	// ..., extras, element
+			lua_rawseti(L, -2, int(lua_objlen(L, -2)) + 1);	// ..., extras = { ..., element }
+		}
+
+		lua_pop(L, 1);	// ...
+	}
+
+	// Move the last element into the vacancy, if the map has not yet become empty.
+	if (index < last)
+	{
+		lua_rawgeti(L, env, last);	// ..., element
+		lua_rawseti(L, env, index);	// ...
+
+		S->mDense[index - 1] = S->mDense[last - 1];
+		S->mIndex[S->mDense[index - 1]] = index;
+	}
+
+	lua_pushnil(L);	// ..., nil
+	lua_rawseti(L, env, last);	// ...
+
+	S->mDense.pop_back();
+
+	// Retire the slot. Bumping the generation invalidates any handles to it.
+	if (++S->mGeneration[slot] == sMaxGeneration) S->mGeneration[slot] = 1;
+
+	S->mIndex[slot] = S->mFree;
+	S->mFree = slot;
+}
+
+// @brief Adds an element
+// @note element: Element to add
+// @return Handle
+static int Add (lua_State * L)
+{
+	lua_settop(L, 2);	// S, element
+
+	SlotMap * S = GetMap(L);// S, element, env
+
+	// Claim a vacant slot, or grow a new one.
+	uInt slot = S->mFree;
+
+	if (slot != 0) S->mFree = S->mIndex[slot];
+
+	else
+	{
+		if (S->mIndex.size() >= size_t(sSlotRange)) luaL_error(L, "SlotMap is full");
+
+		slot = uInt(S->mIndex.size());
+
+		S->mIndex.push_back(0);
+		S->mGeneration.push_back(1);
+	}
+
+	S->mDense.push_back(slot);
+	S->mIndex[slot] = uInt(S->mDense.size());
+
+	lua_pushvalue(L, 2);// S, element, env, element
+	lua_rawseti(L, 3, int(S->mDense.size()));	// S, element, env
+
+	lua_pushnumber(L, S->Handle(uInt(S->mDense.size())));	// S, element, env, handle
+
+	return 1;
+}
+
+// @brief Gets an element by dense index
+// @note index: Dense index
+// @return Element, handle
+static int At (lua_State * L)
+{
+	lua_settop(L, 2);	// S, index
+
+	SlotMap * S = GetMap(L);// S, index, env
+	uInt index = GetIndex(L, S, 2);
+
+	lua_rawgeti(L, 3, index);	// S, index, env, element
+	lua_pushnumber(L, S->Handle(index));// S, index, env, element, handle
+
+	return 2;
+}
+
+// @brief Removes all elements
+// @note clear: If true, elements are not dropped into the extras
+static int Clear (lua_State * L)
+{
+	lua_settop(L, 2);	// S, clear
+
+	SlotMap * S = GetMap(L);// S, clear, env
+
+	while (!S->mDense.empty()) RemoveAt(L, S, uInt(S->mDense.size()), 3, lua_toboolean(L, 2) != 0);
+
+	return 0;
+}
+
+// @brief Gets an element by handle
+// @note handle: Element handle
+// @return Element, or nil if the handle is stale
+static int Get (lua_State * L)
+{
+	lua_settop(L, 2);	// S, handle
+
+	SlotMap * S = GetMap(L);// S, handle, env
+	uInt index = S->Find(lua_tonumber(L, 2));
+
+	if (index != 0) lua_rawgeti(L, 3, index);	// S, handle, env, element
+
+	else lua_pushnil(L);// S, handle, env, nil
+
+	return 1;
+}
+
+// @brief Gets the dense index of a handle's element
+// @note handle: Element handle
+// @return Dense index, or nil if the handle is stale
+static int IndexOf (lua_State * L)
+{
+	uInt index = ((SlotMap *)UD(L, 1))->Find(lua_tonumber(L, 2));
+
+	if (index != 0) lua_pushinteger(L, index);	// S, handle, index
+
+	else lua_pushnil(L);// S, handle, nil
+
+	return 1;
+}
+
+// @brief Indicates whether a handle is still valid
+// @note handle: Element handle
+// @return If true, the handle refers to an element
+static int IsValid (lua_State * L)
+{
+	lua_pushboolean(L, ((SlotMap *)UD(L, 1))->Find(lua_tonumber(L, 2)) != 0);	// S, handle, bValid
+
+	return 1;
+}
+
+// @brief Stateless iterator body; steps down from the end, so removing the current element is safe
+// @note S: Slot map
+// @note index: Previous dense index
+// @return Dense index, element, handle; or nil when done
+static int IterNext (lua_State * L)
+{
+	SlotMap * S = (SlotMap *)UD(L, 1);
+	uInt index = uInt(lua_tointeger(L, 2));
+
+	// Clamp to the end, in case elements past the current one were removed.
+	if (index > S->mDense.size()) index = uInt(S->mDense.size()) + 1;
+
+	if (index <= 1) return 0;
+
+	--index;
+
+	lua_getfenv(L, 1);	// S, index, env
+	lua_pushinteger(L, index);	// S, index, env, index
+	lua_rawgeti(L, 3, index);	// S, index, env, index, element
+	lua_pushnumber(L, S->Handle(index));// S, index, env, index, element, handle
+
+	return 3;
+}
+
+// @brief Builds an iterator over the elements, in no particular order
+// @return Iterator which supplies dense index, element, handle
+// @note Removing the current element during iteration is safe
+static int Iter (lua_State * L)
+{
+	SlotMap * S = (SlotMap *)UD(L, 1);
+
+	lua_settop(L, 1);	// S
+	lua_pushcfunction(L, IterNext);	// S, IterNext
+	lua_insert(L, 1);	// IterNext, S
+	lua_pushinteger(L, int(S->mDense.size()) + 1);	// IterNext, S, count + 1
+
+	return 3;
+}
+
+// @brief Removes and returns an extra element, if any
+// @return Element
+static int PopExtra (lua_State * L)
+{
+	lua_settop(L, 1);	// S
+	lua_getfenv(L, 1);	// S, env
+	lua_pushlightuserdata(L, &_Extras);	// S, env, key
+	lua_rawget(L, 2);	// S, env, extras
+
+	int n = int(lua_objlen(L, 3));
+
+	if (0 == n) return 0;
+
+	lua_rawgeti(L, 3, n);	// S, env, extras, element
+	lua_pushnil(L);	// S, env, extras, element, nil
+	lua_rawseti(L, 3, n);	// S, env, extras, element
+
+	return 1;
+}
+
+// @brief Removes an element by handle
+// @note handle: Element handle
+// @note clear: If true, the element is not dropped into the extras
+// @return If true, an element was removed
+static int Remove (lua_State * L)
+{
+	lua_settop(L, 3);	// S, handle, clear
+
+	SlotMap * S = GetMap(L);// S, handle, clear, env
+	uInt index = S->Find(lua_tonumber(L, 2));
+
+	if (index != 0) RemoveAt(L, S, index, 4, lua_toboolean(L, 3) != 0);
+
+	lua_pushboolean(L, index != 0);	// S, handle, clear, env, bRemoved
+
+	return 1;
+}
+
+// @brief Removes an element by dense index
+// @note index: Dense index
+// @note clear: If true, the element is not dropped into the extras
+static int RemoveAt (lua_State * L)
+{
+	lua_settop(L, 3);	// S, index, clear
+
+	SlotMap * S = GetMap(L);// S, index, clear, env
+
+	RemoveAt(L, S, GetIndex(L, S, 2), 4, lua_toboolean(L, 3) != 0);
+
+	return 0;
+}
+
+// @brief Assigns an element by handle
+// @note handle: Element handle
+// @note element: Element to assign
+// @return If true, the handle was valid
+static int Set (lua_State * L)
+{
+	lua_settop(L, 3);	// S, handle, element
+
+	SlotMap * S = GetMap(L);// S, handle, element, env
+	uInt index = S->Find(lua_tonumber(L, 2));
+
+	if (index != 0)
+	{
+		lua_pushvalue(L, 3);// S, handle, element, env, element
+		lua_rawseti(L, 4, index);	// S, handle, element, env
+	}
+
+	lua_pushboolean(L, index != 0);	// S, handle, element, env, bValid
+
+	return 1;
+}
+
+// @brief __gc metamethod
+static int GC (lua_State * L)
+{
+	((SlotMap *)UD(L, 1))->~SlotMap();
+
+	return 0;
+}
+
+// @brief __len metamethod
+// @return Element count
+static int Len (lua_State * L)
+{
+	lua_pushinteger(L, ((SlotMap *)UD(L, 1))->mDense.size());	// S, count
+
+	return 1;
+}
+
+// @brief Constructor
+// @note S: Slot map
+static int Cons (lua_State * L)
+{
+	new (UD(L, 1)) SlotMap;
+
+	lua_getfenv(L, 1);	// S, ..., env
+	lua_pushlightuserdata(L, &_Extras);	// S, ..., env, key
+	lua_newtable(L);// S, ..., env, key, extras
+	lua_rawset(L, -3);	// S, ..., env = { [key] = extras }
+
+	return 0;
+}
+
+// @brief Defines the SlotMap class
+// @param L Lua state
+// @return 0
+// @note Must be called once the class module is loaded
+int Bindings::open_slotmap (lua_State * L)
+{
+	luaL_reg methods[] = {
+		{ "Add", Add },
+		{ "At", At },
+		{ "Clear", Clear },
+		{ "Get", Get },
+		{ "IndexOf", IndexOf },
+		{ "IsValid", IsValid },
+		{ "Iter", Iter },
+		{ "PopExtra", PopExtra },
+		{ "Remove", Remove },
+		{ "RemoveAt", RemoveAt },
+		{ "Set", Set },
+		{ "__gc", GC },
+		{ "__len", Len },
+		{ 0, 0 }
+	};
+
+	Class::Define(L, "SlotMap", methods, Cons, Class::Def(sizeof(SlotMap)));
+
+	return 0;
+}
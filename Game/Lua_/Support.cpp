@@ -331,23 +331,10 @@ int Lua::OverloadedNew (lua_State * L, char const * type, int argc)
 	return 1;
 }
 
-static int StringVectorPrintf (lua_State * L)
-{
-   std::vector<std::string> * vec = (std::vector<std::string> *)UD(L, lua_upvalueindex(1));
-
-   GetGlobal(L, "string.format"); // format_str, ..., string.format
-
-   lua_insert(L, 1); // string.format, format_str, ...
-
-   lua_call(L, lua_gettop(L) - 1, 1); // result_str
-
-   vec->push_back(S(L, 1));
-
-   return 0;
-}
-
 void Lua::StackView (lua_State * L){
 
+	DumpBuffer buffer;
+
 	lua_Debug ar;
 
 	for (int i = 0; lua_getstack(L, i, &ar) != 0; i++) {
@@ -363,14 +350,10 @@ void Lua::StackView (lua_State * L){
 				continue;
 			}
 			
-			std::vector<std::string> vec;
-
-			GetGlobal(L, "vardump.Print"); // local_var, vardump.Print
+			// reuse the buffer's storage from local to local
+			buffer.Clear();
 
-			lua_pushvalue(L, -2); // local_var, vardump.Print, local_var
-			lua_pushlightuserdata(L, &vec); // local_var, vardump.Print, local_var, vec
-			lua_pushcclosure(L, StringVectorPrintf, 1); // local_var, vardump.Print, local_var, StringVectorPrintf
-			lua_call(L, 2, 0); // local_var
+			VarDump(L, -1, buffer); // local_var
 			// Place breakpoint here!!
 		}
 	}
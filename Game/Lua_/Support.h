@@ -13,6 +13,20 @@ namespace Lua
 
 	void StackView (lua_State * L);
 
+	// @brief Growable output buffer for VarDump, reusable across dumps
+	struct DumpBuffer {
+		std::string mText;	// Printout, one line per newline
+		size_t mMaxSize;// Size limit in bytes (if 0, no limit)
+		int mMaxDepth;	// Nesting limit (if negative, no limit)
+		bool mTruncated;// If true, the size limit cut the printout short
+
+		DumpBuffer (int max_depth = -1, size_t max_size = 0);
+
+		void Clear (void);
+	};
+
+	void VarDump (lua_State * L, int index, DumpBuffer & buffer, char const * indent = "");
+
 	// @brief Overloaded function builder
 	struct Overload {
 		std::string mArgs;	// String used to fetch arguments
@@ -0,0 +1,417 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+
+using namespace Lua;
+
+// @brief Map variants
+enum Kind {
+	eCopy,	// Copy values
+	eMap,	// Map values, as map(v, arg)
+	eMapKV	// Map keys and values, as map(k, v, arg)
+};
+
+// @brief Pushes a new table, presized to hold a source's contents
+// @param source Source table stack index
+// @param bArray If true, only the source's array part is sized for
+static void NewSized (lua_State * L, int source, bool bArray)
+{
+	IndexAbsolute(L, source);
+
+	int narr = GetN(L, source), nrec = 0;
+
+	// The hash size is not exposed, so count the entries outright.
+	if (!bArray)
+	{
+		int count = 0;
+
+		for (lua_pushnil(L); lua_next(L, source) != 0; lua_pop(L, 1)) ++count;	// ...
+
+		nrec = count > narr ? count - narr : 0;
+	}
+
+	lua_createtable(L, narr, nrec);	// ..., t
+}
+
+// @brief Pushes the destination: the bound table, if provided, or else a presized table
+// @param dest Bound table stack index
+// @param source Source table stack index
+// @param bArray If true, only the source's array part is sized for
+static void PushDest (lua_State * L, int dest, int source, bool bArray)
+{
+	if (lua_istable(L, dest)) lua_pushvalue(L, dest);	// ..., dt
+
+	else NewSized(L, source, bArray);	// ..., dt
+}
+
+// @brief Clears a range of an array
+// @param array Array stack index
+// @param first Index of first entry
+// @param last Index of last entry
+// @param wipe Stack index of wipe value (0 for nil)
+static void WipeRange (lua_State * L, int array, int first, int last, int wipe)
+{
+	for (int i = first; i <= last; ++i)
+	{
+		if (wipe != 0) lua_pushvalue(L, wipe);	// ..., wipe
+
+		else lua_pushnil(L);// ..., nil
+
+		lua_rawseti(L, array, i);	// ...
+	}
+}
+
+// @brief Gets the starting offset of an array-style operation
+// @param dest Destination stack index
+// @param how Behavior stack index
+static int GetOffset (lua_State * L, int dest, int how)
+{
+	lua_pushliteral(L, "append");	// ..., "append"
+
+	int offset = (lua_rawequal(L, how, -1) ? GetN(L, dest) : 0) + 1;
+
+	lua_pop(L, 1);	// ...
+
+	return offset;
+}
+
+// @brief Resolves an array-style operation, trimming the destination if requested
+// @param dest Destination stack index
+// @param how Behavior stack index
+// @param offset Offset reached by operation
+// @param how_arg Behavior argument stack index
+static void Resolve (lua_State * L, int dest, int how, int offset, int how_arg)
+{
+	lua_pushliteral(L, "overwrite_trim");	// ..., "overwrite_trim"
+
+	if (lua_rawequal(L, how, -1)) WipeRange(L, dest, offset, lua_isnil(L, how_arg) ? GetN(L, dest) : int(luaL_checkinteger(L, how_arg)), 0);
+
+	lua_pop(L, 1);	// ...
+}
+
+// @brief Pushes a mapped value
+// @param kind Map variant
+// @note ..., k, v: Current key and value
+// @note Stack: dt, t, map, how, arg, how_arg
+static void PushMapped (lua_State * L, Kind kind)
+{
+	if (eCopy == kind)
+	{
+		lua_pushvalue(L, -1);	// ..., k, v, v
+
+		return;
+	}
+
+	lua_pushvalue(L, 3);// ..., k, v, map
+
+	if (eMapKV == kind) lua_pushvalue(L, -3);	// ..., k, v, map, k
+
+	lua_pushvalue(L, eMapKV == kind ? -3 : -2);	// ..., k, v, map[, k], v
+	lua_pushvalue(L, 5);// ..., k, v, map[, k], v, arg
+	lua_call(L, eMapKV == kind ? 3 : 2, 1);	// ..., k, v, result
+}
+
+// @brief Common body of Copy, Map and MapKV
+// @param kind Map variant
+// @note Stack: dt, t, map, how, arg, how_arg
+// @return Mapped table
+static int AuxMap (lua_State * L, Kind kind)
+{
+	lua_settop(L, 6);	// dt, t, map, how, arg, how_arg
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	bool bArray = lua_toboolean(L, 4) != 0;
+
+	PushDest(L, 1, 2, bArray);	// dt, t, map, how, arg, how_arg, dt
+
+	// Array behavior: visit values in order, up to a nil, and put the results at the offset.
+	if (bArray)
+	{
+		int offset = GetOffset(L, 7, 4);
+
+		for (int i = 1; ; ++i, ++offset)
+		{
+			lua_pushinteger(L, i);	// dt, t, map, how, arg, how_arg, dt, i
+			lua_rawgeti(L, 2, i);	// dt, t, map, how, arg, how_arg, dt, i, v
+
+			if (lua_isnil(L, -1))
+			{
+				lua_pop(L, 2);	// dt, t, map, how, arg, how_arg, dt
+
+				break;
+			}
+
+			PushMapped(L, kind);// dt, t, map, how, arg, how_arg, dt, i, v, result
+			lua_rawseti(L, 7, offset);	// dt, t, map, how, arg, how_arg, dt, i, v
+			lua_pop(L, 2);	// dt, t, map, how, arg, how_arg, dt
+		}
+
+		Resolve(L, 7, 4, offset, 6);
+	}
+
+	// Otherwise, map each pair.
+	else
+	{
+		for (lua_pushnil(L); lua_next(L, 2) != 0; )
+		{
+			lua_pushvalue(L, -2);	// dt, t, map, how, arg, how_arg, dt, k, v, k
+			lua_insert(L, -2);	// dt, t, map, how, arg, how_arg, dt, k, k, v
+
+			PushMapped(L, kind);// dt, t, map, how, arg, how_arg, dt, k, k, v, result
+
+			lua_replace(L, -2);	// dt, t, map, how, arg, how_arg, dt, k, k, result
+			lua_rawset(L, 7);	// dt, t, map, how, arg, how_arg, dt, k
+		}
+	}
+
+	return 1;
+}
+
+// @brief Shallow-copies a table
+// @note dt: Bound destination table, or nil
+// @note t: Table to copy
+// @note how, how_arg: Copy behavior, as per table_ex.Map
+// @return Copy
+static int Copy (lua_State * L)
+{
+	lua_settop(L, 4);	// dt, t, how, how_arg
+	lua_pushnil(L);	// dt, t, how, how_arg, nil
+	lua_insert(L, 3);	// dt, t, nil, how, how_arg
+	lua_pushnil(L);	// dt, t, nil, how, how_arg, nil
+	lua_insert(L, 5);	// dt, t, nil, how, nil, how_arg
+
+	return AuxMap(L, eCopy);
+}
+
+// @brief Maps input items to output items
+// @note dt: Bound destination table, or nil
+// @note t, map, how, arg, how_arg: As per table_ex.Map
+// @return Mapped table
+static int Map (lua_State * L)
+{
+	return AuxMap(L, eMap);
+}
+
+// @brief Key-value variant of Map
+// @note dt: Bound destination table, or nil
+// @note t, map, how, arg, how_arg: As per table_ex.MapKV
+// @return Mapped table
+static int MapKV (lua_State * L)
+{
+	return AuxMap(L, eMapKV);
+}
+
+// @brief Moves items into a second table
+// @note dt: Bound destination table, or nil
+// @note t, how, how_arg: As per table_ex.Move
+// @return Destination table
+static int Move (lua_State * L)
+{
+	lua_settop(L, 4);	// dt, t, how, how_arg
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	if (lua_rawequal(L, 1, 2))
+	{
+		lua_settop(L, 1);	// dt
+
+		return 1;
+	}
+
+	bool bArray = lua_toboolean(L, 3) != 0;
+
+	PushDest(L, 1, 2, bArray);	// dt, t, how, how_arg, dt
+
+	if (bArray)
+	{
+		int offset = GetOffset(L, 5, 3);
+
+		for (int i = 1; ; ++i, ++offset)
+		{
+			lua_rawgeti(L, 2, i);	// dt, t, how, how_arg, dt, v
+
+			if (lua_isnil(L, -1))
+			{
+				lua_pop(L, 1);	// dt, t, how, how_arg, dt
+
+				break;
+			}
+
+			lua_rawseti(L, 5, offset);	// dt, t, how, how_arg, dt
+			lua_pushnil(L);	// dt, t, how, how_arg, dt, nil
+			lua_rawseti(L, 2, i);	// dt, t, how, how_arg, dt
+		}
+
+		Resolve(L, 5, 3, offset, 4);
+	}
+
+	// Clearing fields during traversal is allowed, so the source is emptied as it goes.
+	else
+	{
+		for (lua_pushnil(L); lua_next(L, 2) != 0; )
+		{
+			lua_pushvalue(L, -2);	// dt, t, how, how_arg, dt, k, v, k
+			lua_insert(L, -2);	// dt, t, how, how_arg, dt, k, k, v
+			lua_rawset(L, 5);	// dt, t, how, how_arg, dt, k
+			lua_pushvalue(L, -1);	// dt, t, how, how_arg, dt, k, k
+			lua_pushnil(L);	// dt, t, how, how_arg, dt, k, k, nil
+			lua_rawset(L, 2);	// dt, t, how, how_arg, dt, k
+		}
+	}
+
+	return 1;
+}
+
+// @brief Visits each entry of an array in order, removing unwanted entries
+// @note t, func, arg, clear_dead: As per table_ex.CullingForEach
+// @return Size of table after culling
+static int CullingForEach (lua_State * L)
+{
+	lua_settop(L, 4);	// t, func, arg, clear_dead
+
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	int count = GetN(L, 1), kept = 0;
+
+	for (int i = 1; ; ++i)
+	{
+		lua_rawgeti(L, 1, i);	// t, func, arg, clear_dead, v
+
+		if (lua_isnil(L, -1)) break;
+
+		// Put keepers back into the table. If desired, empty the table first.
+		lua_pushvalue(L, 2);// t, func, arg, clear_dead, v, func
+		lua_pushvalue(L, -2);	// t, func, arg, clear_dead, v, func, v
+		lua_pushvalue(L, 3);// t, func, arg, clear_dead, v, func, v, arg
+		lua_call(L, 2, 1);	// t, func, arg, clear_dead, v, result
+
+		if (lua_toboolean(L, -1))
+		{
+			kept = (lua_type(L, -1) == LUA_TNUMBER && lua_tonumber(L, -1) == 0 ? 0 : kept) + 1;
+
+			lua_pushvalue(L, -2);	// t, func, arg, clear_dead, v, result, v
+			lua_rawseti(L, 1, kept);// t, func, arg, clear_dead, v, result
+		}
+
+		lua_pop(L, 2);	// t, func, arg, clear_dead
+	}
+
+	// Clear dead entries or place a sentinel nil.
+	WipeRange(L, 1, kept + 1, lua_toboolean(L, 4) ? count : kept + 1, 0);
+
+	// Report the new size.
+	lua_pushinteger(L, kept);	// t, func, arg, clear_dead, nil, kept
+
+	return 1;
+}
+
+// @brief Clears a range in an array
+// @note array, first, last, wipe: As per varops.ClearRange
+// @return Array
+static int ClearRange (lua_State * L)
+{
+	lua_settop(L, 4);	// array, first, last, wipe
+
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	WipeRange(L, 1, int(luaL_optinteger(L, 2, 1)), lua_isnil(L, 3) ? GetN(L, 1) : int(luaL_checkinteger(L, 3)), lua_isnil(L, 4) ? 0 : 4);
+
+	lua_settop(L, 1);	// array
+
+	return 1;
+}
+
+// @brief Deep-copies a table, along with its subtables and metatables
+// @note dt: Bound destination table, or nil
+// @note t: Table to copy
+// @return Copy
+// @note Each source table is copied once, with every reference to it mapped to the copy, so
+// shared subtables stay shared and cycles terminate
+static int DeepCopy (lua_State * L)
+{
+	lua_settop(L, 2);	// dt, t
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	PushDest(L, 1, 2, false);	// dt, t, copy
+	lua_newtable(L);// dt, t, copy, visited
+	lua_createtable(L, 1, 0);	// dt, t, copy, visited, pending
+
+	// Seed the work list with the source, mapped to the destination.
+	lua_pushvalue(L, 2);// dt, t, copy, visited, pending, t
+	lua_pushvalue(L, 3);// dt, t, copy, visited, pending, t, copy
+	lua_rawset(L, 4);	// dt, t, copy, visited = { t = copy }, pending
+	lua_pushvalue(L, 2);// dt, t, copy, visited, pending, t
+	lua_rawseti(L, 5, 1);	// dt, t, copy, visited, pending = { t }
+
+	// Copy each pending table into its mapped table, queueing any unvisited subtables.
+	for (int n = 1; n > 0; )
+	{
+		lua_rawgeti(L, 5, n);	// dt, t, copy, visited, pending, source
+		lua_pushnil(L);	// dt, t, copy, visited, pending, source, nil
+		lua_rawseti(L, 5, n--);	// dt, t, copy, visited, pending, source
+		lua_pushvalue(L, -1);	// dt, t, copy, visited, pending, source, source
+		lua_rawget(L, 4);	// dt, t, copy, visited, pending, source, dest
+
+		// The copy takes the source's metatable (none included).
+		if (!lua_getmetatable(L, 6)) lua_pushnil(L);// dt, t, copy, visited, pending, source, dest, meta
+
+		lua_setmetatable(L, 7);	// dt, t, copy, visited, pending, source, dest
+
+		for (lua_pushnil(L); lua_next(L, 6) != 0; lua_pop(L, 1))
+		{
+			lua_pushvalue(L, -2);	// dt, t, copy, visited, pending, source, dest, k, v, k
+
+			if (lua_istable(L, -2))
+			{
+				lua_pushvalue(L, -2);	// dt, t, copy, visited, pending, source, dest, k, v, k, v
+				lua_rawget(L, 4);	// dt, t, copy, visited, pending, source, dest, k, v, k, vcopy?
+
+				if (lua_isnil(L, -1))
+				{
+					lua_pop(L, 1);	// dt, t, copy, visited, pending, source, dest, k, v, k
+
+					NewSized(L, -2, false);	// dt, t, copy, visited, pending, source, dest, k, v, k, vcopy
+
+					lua_pushvalue(L, -3);	// dt, t, copy, visited, pending, source, dest, k, v, k, vcopy, v
+					lua_pushvalue(L, -2);	// dt, t, copy, visited, pending, source, dest, k, v, k, vcopy, v, vcopy
+					lua_rawset(L, 4);	// dt, t, copy, visited = { ..., v = vcopy }, pending, source, dest, k, v, k, vcopy
+					lua_pushvalue(L, -3);	// dt, t, copy, visited, pending, source, dest, k, v, k, vcopy, v
+					lua_rawseti(L, 5, ++n);	// dt, t, copy, visited, pending = { ..., v }, source, dest, k, v, k, vcopy
+				}
+			}
+
+			else lua_pushvalue(L, -2);	// dt, t, copy, visited, pending, source, dest, k, v, k, v
+
+			lua_rawset(L, 7);	// dt, t, copy, visited, pending, source, dest, k, v
+		}
+
+		lua_pop(L, 2);	// dt, t, copy, visited, pending
+	}
+
+	lua_settop(L, 3);	// dt, t, copy
+
+	return 1;
+}
+
+// @brief Opens the native table_ex core
+// @note Registered as table_core; table_ex and varops pick it up if present
+int Bindings::open_table (lua_State * L)
+{
+	luaL_reg funcs[] = {
+		{ "ClearRange", ClearRange },
+		{ "Copy", Copy },
+		{ "CullingForEach", CullingForEach },
+		{ "DeepCopy", DeepCopy },
+		{ "Map", Map },
+		{ "MapKV", MapKV },
+		{ "Move", Move },
+		{ 0, 0 }
+	};
+
+	Register(L, "table_core", funcs);
+
+	return 0;
+}
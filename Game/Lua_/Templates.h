@@ -1,6 +1,9 @@
 #ifndef LUA_TEMPLATES_H
 #define LUA_TEMPLATES_H
 
+#include "Lua_/Finalizers.h"
+#include "Lua_/Handles.h"
+
 namespace Lua
 {
 	/*%%%%%%%%%%%%%%%% TEMPLATED HELPER FUNCTIONS %%%%%%%%%%%%%%%%*/
@@ -11,9 +14,67 @@ namespace Lua
 	// @brief Templated reference type stub
 	template<typename T> char const * _rtypeT (void) { return ""; }
 
+	// @brief Templated instance metatable keys; each metatable is cached in the registry under its key's address
+	template<typename T> struct _metaT {
+		static int sType;	// T instances
+		static int sRType;	// T reference instances
+	};
+
+	template<typename T> int _metaT<T>::sType;
+	template<typename T> int _metaT<T>::sRType;
+
+	// @brief Compares the metatable on the stack top against a cached one
+	inline bool _ismetaT (lua_State * L, int * key)
+	{
+		lua_pushlightuserdata(L, key);	// ..., meta, key
+		lua_rawget(L, LUA_REGISTRYINDEX);	// ..., meta, cached?
+
+		bool bSame = lua_rawequal(L, -1, -2) != 0;
+
+		lua_pop(L, 1);	// ..., meta
+
+		return bSame;
+	}
+
+	// @brief Caches the metatable on the stack top
+	inline void _cachemetaT (lua_State * L, int * key)
+	{
+		lua_pushlightuserdata(L, key);	// ..., meta, key
+		lua_pushvalue(L, -2);	// ..., meta, key, meta
+		lua_rawset(L, LUA_REGISTRYINDEX);	// ..., meta
+	}
+
 	// @brief Templated type accessor
 	template<typename T> T * _pT (lua_State * L, int index)
 	{
+#if LUA_CHECKS == LUA_CHECKS_NONE
+		// Unchecked builds trust the argument, so only the reference case needs telling apart. Once
+		// the T and T reference metatables have been seen, this is a direct userdata access.
+		IndexAbsolute(L, index);
+
+		void * ud = lua_touserdata(L, index);
+
+		if (!lua_getmetatable(L, index)) return (T *)ud;// ..., meta
+
+		bool bRef = _ismetaT(L, &_metaT<T>::sRType);
+
+		if (!bRef && !_ismetaT(L, &_metaT<T>::sType))
+		{
+			// First sight of this metatable (or a derived type's): classify it through the class library.
+			if (Class::IsInstance(L, index))
+			{
+				bRef = Class::IsType(L, index, _rtypeT<T>());
+
+				if (bRef) _cachemetaT(L, &_metaT<T>::sRType);
+
+				else if (Class::IsType(L, index, _typeT<T>())) _cachemetaT(L, &_metaT<T>::sType);
+			}
+		}
+
+		lua_pop(L, 1);	// ...
+
+		return bRef ? *(T **)ud : (T *)ud;
+#else
 		// Given an instance, supply its memory; if it is a non-T type, report an error.
 		// Otherwise, simply return the non-instance's memory.
 		if (Class::IsInstance(L, index))
@@ -21,11 +82,16 @@ namespace Lua
 			// If the instance is a T reference, look up its memory.
 			if (Class::IsType(L, index, _rtypeT<T>())) return *(T **)UD(L, index);
 
-			// Otherwise, point to its memory.
+			// Otherwise, point to its memory. The type is only verified under full checks.
+#if LUA_CHECKS == LUA_CHECKS_FULL
 			if (!Class::IsType(L, index, _typeT<T>())) luaL_error(L, "Arg #%d: non-%s/%s", index, _typeT<T>(), _rtypeT<T>());
+#else
+			LUA_CHECK_ASSERT(Class::IsType(L, index, _typeT<T>()));
+#endif
 		}
 
 		return (T *)UD(L, index);
+#endif
 	}
 
 	// @brief Templated type accessor; 0 if unavailable
@@ -37,6 +103,8 @@ namespace Lua
 	}
 
 	// @brief Templated member getter; builds a new object or fills in a passed one if available (passed-in object version)
+	// @note New objects go through class.New, so pooled types (e.g. Vec3D and Color, pooled by
+	// PrimitivesBoot) reuse instances recycled via class.Recycle
 	template<typename D> int _getmemberT_arg (lua_State * L, int index, D & (*ref)(lua_State *, int), char const * type, D const & d, bool bTop = true)
 	{
 		if (!lua_isnoneornil(L, index))
@@ -106,6 +174,56 @@ namespace Lua
 		return _boxedsetT_ref<T>(L, dest, _pTor0<T>(L, source), bCheckTarget);
 	}
 
+	// @brief Templated handle table, shared by all states
+	// @note A static member rather than a function-local static, so pushes skip the initialization guard
+	template<typename T> struct _handlesT {
+		static HandleTable<T> sHandles;
+	};
+
+	template<typename T> HandleTable<T> _handlesT<T>::sHandles;
+
+	// @brief Templated handle push; nil if the object is 0
+	// @note Unlike the reference version of boxing, this costs no userdata and no reference count
+	template<typename T> int _pushhandleT (lua_State * L, T * object)
+	{
+		if (object != 0)
+		{
+			lua_Number handle = _handlesT<T>::sHandles.Acquire(object);
+
+			if (0 == handle) luaL_error(L, "Out of %s handles", _typeT<T>());
+
+			lua_pushnumber(L, handle);	// ..., handle
+		}
+
+		else lua_pushnil(L);// ..., nil
+
+		return 1;
+	}
+
+	// @brief Templated handle accessor; 0 if nil or stale
+	template<typename T> T * _handleTor0 (lua_State * L, int index)
+	{
+		if (lua_type(L, index) != LUA_TNUMBER) return 0;
+
+		return _handlesT<T>::sHandles.Get(lua_tonumber(L, index));
+	}
+
+	// @brief Templated handle accessor
+	template<typename T> T * _handleT (lua_State * L, int index)
+	{
+		T * object = _handleTor0<T>(L, index);
+
+		if (0 == object) luaL_error(L, "Arg #%d: dead or invalid %s handle", index, _typeT<T>());
+
+		return object;
+	}
+
+	// @brief Templated handle release; outstanding handles to the object go stale
+	template<typename T> void _releasehandleT (T const * object)
+	{
+		_handlesT<T>::sHandles.Release(object);
+	}
+
 	// @brief Templated copy constructor
 	template<typename T> int _copyT (lua_State * L, T & t)
 	{
@@ -162,6 +280,32 @@ namespace Lua
 		return _boxedsetT_ref(L, 1, (T *)0);
 	}
 
+	// @brief Templated release, for deferred finalization
+	template<typename T> void _releaseT (void * object)
+	{
+		static_cast<T *>(object)->Release();
+	}
+
+	// @brief Templated deferred finalization queue claim, for draining T releases on another thread
+	// @note Only for types whose Release is thread-safe (q.v. Finalizers::Claim)
+	template<typename T> Finalizers::Queue * _claimfinalizersT (lua_State * L)
+	{
+		return Finalizers::Claim(L, _releaseT<T>);
+	}
+
+	// @brief Templated garbage collector (deferred reference version)
+	// @note The release is queued, to run when the game drains the finalizers (q.v. Finalizers::Drain)
+	template<typename T> int _gcT_ref_deferred (lua_State * L)
+	{
+		T ** target = (T **)UD(L, 1);
+
+		if (*target != 0) Finalizers::Defer(L, *target, _releaseT<T>);
+
+		*target = 0;
+
+		return 0;
+	}
+
 	// @brief Templated garbage collector (destructor version)
 	template<typename T> int _gcT_dtor (lua_State * L)
 	{
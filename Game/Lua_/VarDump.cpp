@@ -0,0 +1,556 @@
+#include "Lua_/Lua.h"
+#include "Lua_/Arg.h"
+#include "Lua_/Helpers.h"
+#include "Lua_/LibEx.h"
+#include "Lua_/Support.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+using namespace Lua;
+
+// @brief Dummy variable; the dump buffer metatable is cached under its address
+static int _BufferMeta;
+
+// @brief Key groups, in print order
+enum {
+	eInteger, eString, eNumber, eBoolean, eFunction, eTable, eThread, eUserdata, eOther
+};
+
+// @brief Sortable key
+// @note Keys are kept in userdata, so they must stay plain data
+struct Key {
+	char const * mStr;	// String form (strings, and keys compared by their tostring form)
+	size_t mLen;// String length
+	lua_Number mNum;// Number value (integer and number groups)
+	int mGroup;	// Key group
+	int mSlot;	// Slot in key array
+
+	// @brief Orders keys by group, then by value
+	bool operator < (Key const & other) const
+	{
+		if (mGroup != other.mGroup) return mGroup < other.mGroup;
+
+		if (eInteger == mGroup || eNumber == mGroup) return mNum < other.mNum;
+
+		int cmp = std::memcmp(mStr, other.mStr, std::min(mLen, other.mLen));
+
+		return cmp != 0 ? cmp < 0 : mLen < other.mLen;
+	}
+};
+
+// @brief Dump state
+// @note Metamethods called while dumping may raise errors, so nothing on the C++ stack needs destruction
+struct Dumper {
+	lua_State * mL;	// Lua state
+	DumpBuffer & mBuffer;	// Output
+	char const * mIndent;	// Initial indent string
+	int mGuard;	// Stack index of cycle guard
+
+	Dumper (lua_State * L, DumpBuffer & buffer, char const * indent) : mL(L), mBuffer(buffer), mIndent(indent), mGuard(0) {}
+
+	// @brief Indicates whether the size limit has been reached
+	bool Full (void) const
+	{
+		return mBuffer.mTruncated;
+	}
+
+	// @brief Appends text to the current line
+	void Add (char const * str, size_t len)
+	{
+		mBuffer.mText.append(str, len);
+	}
+
+	void Add (char const * str)
+	{
+		Add(str, std::strlen(str));
+	}
+
+	// @brief Appends the indentation for a nesting level
+	void Indent (int level)
+	{
+		Add(mIndent);
+
+		for (int i = 0; i < level; ++i) Add("   ", 3);
+	}
+
+	// @brief Ends the current line, checking the size limit
+	void EndLine (void)
+	{
+		mBuffer.mText += '\n';
+
+		if (mBuffer.mMaxSize != 0 && mBuffer.mText.size() >= mBuffer.mMaxSize)
+		{
+			mBuffer.mText += "... (truncated)\n";
+			mBuffer.mTruncated = true;
+		}
+	}
+};
+
+// @brief Indicates whether a number is an integer
+static bool IsInteger (lua_Number n)
+{
+	return std::fmod(n, lua_Number(1)) == 0;
+}
+
+// @brief Appends a number in integer form, as per format("%i")
+static void AddInteger (Dumper & d, lua_Number n)
+{
+	char buf[64];
+
+	if (n >= -2147483648.0 && n <= 2147483647.0) sprintf(buf, "%ld", long(n));
+
+	else sprintf(buf, "%.0f", n);
+
+	d.Add(buf);
+}
+
+// @brief Appends a value's tostring form, without metamethods
+// @param index Stack index of value
+static void AddRaw (Dumper & d, int index)
+{
+	lua_State * L = d.mL;
+
+	switch (lua_type(L, index))
+	{
+	case LUA_TNUMBER:
+	case LUA_TSTRING:
+		{
+			lua_pushvalue(L, index);// ..., v
+
+			size_t len;
+			char const * str = lua_tolstring(L, -1, &len);
+
+			d.Add(str, len);
+
+			lua_pop(L, 1);	// ...
+		}
+		break;
+	case LUA_TBOOLEAN:
+		d.Add(lua_toboolean(L, index) ? "true" : "false");
+		break;
+	case LUA_TNIL:
+		d.Add("nil");
+		break;
+	default:
+		{
+			char buf[64];
+
+			sprintf(buf, "%s: %p", luaL_typename(L, index), lua_topointer(L, index));
+
+			d.Add(buf);
+		}
+	}
+}
+
+// @brief Appends a value's tostring form
+// @param index Stack index of value
+// @note Values with a __tostring metamethod must be handled separately
+static void AddToString (Dumper & d, int index)
+{
+	lua_State * L = d.mL;
+
+	if (luaL_callmeta(L, index, "__tostring"))	// ..., str?
+	{
+		size_t len;
+		char const * str = lua_tolstring(L, -1, &len);
+
+		if (0 == str) luaL_error(L, "'__tostring' must return a string");
+
+		d.Add(str, len);
+
+		lua_pop(L, 1);	// ...
+	}
+
+	else AddRaw(d, index);
+}
+
+// @brief Indicates whether a value has a __tostring metamethod
+static bool HasToString (lua_State * L, int index)
+{
+	if (!luaL_getmetafield(L, index, "__tostring")) return false;	// ..., __tostring
+
+	lua_pop(L, 1);	// ...
+
+	return true;
+}
+
+static void DumpLevel (Dumper & d, int index, int depth);
+
+// @brief Appends a value's pretty form, opening it up if it is a new table
+// @param index Stack index of value
+// @param depth Current nesting depth
+static void DumpValue (Dumper & d, int index, int depth)
+{
+	lua_State * L = d.mL;
+
+	if (HasToString(L, index)) AddToString(d, index);
+
+	else if (lua_type(L, index) == LUA_TSTRING)
+	{
+		d.Add("\"");
+
+		AddRaw(d, index);
+
+		d.Add("\"");
+	}
+
+	else if (lua_type(L, index) == LUA_TNUMBER && IsInteger(lua_tonumber(L, index))) AddInteger(d, lua_tonumber(L, index));
+
+	else if (lua_istable(L, index))
+	{
+		lua_pushvalue(L, index);// ..., t
+		lua_rawget(L, d.mGuard);// ..., seen?
+
+		bool bSeen = lua_toboolean(L, -1) != 0;
+
+		lua_pop(L, 1);	// ...
+
+		if (bSeen)
+		{
+			d.Add("CYCLE, ");
+
+			AddRaw(d, index);
+		}
+
+		else if (d.mBuffer.mMaxDepth >= 0 && depth >= d.mBuffer.mMaxDepth)
+		{
+			d.Add("{ ... } (");
+
+			AddRaw(d, index);
+
+			d.Add(")");
+		}
+
+		else
+		{
+			d.Add("{");
+			d.EndLine();
+
+			DumpLevel(d, index, depth + 1);
+
+			return;
+		}
+	}
+
+	else AddRaw(d, index);
+
+	d.EndLine();
+}
+
+// @brief Appends a table level, with its keys sorted by type, then by value
+// @param index Stack index of table
+// @param depth Current nesting depth, which is also the indentation level
+static void DumpLevel (Dumper & d, int index, int depth)
+{
+	lua_State * L = d.mL;
+
+	luaL_checkstack(L, 8, "VarDump");
+
+	IndexAbsolute(L, index);
+
+	// Mark this table to guard against cycles.
+	lua_pushvalue(L, index);// ..., t
+	lua_pushboolean(L, true);	// ..., t, true
+	lua_rawset(L, d.mGuard);// ...
+
+	// Gather the keys into a userdata array. Keys compared by their tostring form are anchored
+	// in a table along with their key, keeping the strings alive during the sort.
+	size_t count = 0;
+
+	for (lua_pushnil(L); lua_next(L, index) != 0; lua_pop(L, 1)) ++count;
+
+	Key * keys = static_cast<Key *>(lua_newuserdata(L, count * sizeof(Key)));	// ..., keys
+
+	lua_createtable(L, int(count), 0);	// ..., keys, slots
+
+	int slots = lua_gettop(L);
+
+	count = 0;
+
+	for (lua_pushnil(L); lua_next(L, index) != 0; lua_pop(L, 1))
+	{
+		Key & key = keys[count++];
+
+		key.mSlot = int(count);
+		key.mStr = 0;
+		key.mLen = 0;
+		key.mNum = 0;
+
+		lua_pushvalue(L, -2);	// ..., keys, slots, k, v, k
+		lua_rawseti(L, slots, key.mSlot);	// ..., keys, slots, k, v
+
+		switch (lua_type(L, -2))
+		{
+		case LUA_TNUMBER:
+			key.mNum = lua_tonumber(L, -2);
+			key.mGroup = IsInteger(key.mNum) ? eInteger : eNumber;
+			break;
+		case LUA_TSTRING:
+			key.mStr = lua_tolstring(L, -2, &key.mLen);
+			key.mGroup = eString;
+			break;
+		default:
+			switch (lua_type(L, -2))
+			{
+			case LUA_TBOOLEAN:
+				key.mGroup = eBoolean;
+				break;
+			case LUA_TFUNCTION:
+				key.mGroup = eFunction;
+				break;
+			case LUA_TTABLE:
+				key.mGroup = eTable;
+				break;
+			case LUA_TTHREAD:
+				key.mGroup = eThread;
+				break;
+			case LUA_TUSERDATA:
+			case LUA_TLIGHTUSERDATA:
+				key.mGroup = eUserdata;
+				break;
+			default:
+				key.mGroup = eOther;
+			}
+
+			// Order these keys by their tostring form.
+			size_t before = d.mBuffer.mText.size();
+
+			AddToString(d, -2);
+
+			lua_pushlstring(L, d.mBuffer.mText.data() + before, d.mBuffer.mText.size() - before);	// ..., keys, slots, k, v, str
+
+			d.mBuffer.mText.resize(before);
+
+			key.mStr = lua_tolstring(L, -1, &key.mLen);
+
+			lua_rawseti(L, slots, -key.mSlot);	// ..., keys, slots, k, v
+		}
+	}
+
+	std::sort(keys, keys + count);
+
+	// Print each field, recursively dumping tables that open up.
+	for (size_t i = 0; i < count && !d.Full(); ++i)
+	{
+		Key & key = keys[i];
+
+		lua_rawgeti(L, slots, key.mSlot);	// ..., keys, slots, k
+		lua_pushvalue(L, -1);	// ..., keys, slots, k, k
+		lua_rawget(L, index);	// ..., keys, slots, k, v
+
+		d.Indent(depth + 1);
+
+		switch (key.mGroup)
+		{
+		case eInteger:
+			d.Add("[");
+
+			AddInteger(d, key.mNum);
+
+			d.Add("] = ");
+			break;
+		case eNumber:
+			{
+				char buf[512];
+
+				sprintf(buf, "[%f] = ", key.mNum);
+
+				d.Add(buf);
+			}
+			break;
+		case eString:
+			d.Add(key.mStr, key.mLen);
+			d.Add(" = ");
+			break;
+		default:
+			d.Add("[");
+			d.Add(key.mStr, key.mLen);
+			d.Add("] = ");
+		}
+
+		DumpValue(d, lua_gettop(L), depth);
+
+		lua_pop(L, 2);	// ..., keys, slots
+	}
+
+	lua_pop(L, 2);	// ...
+
+	// Close this table.
+	if (!d.Full())
+	{
+		d.Indent(depth);
+		d.Add("} (");
+
+		AddRaw(d, index);
+
+		d.Add(")");
+		d.EndLine();
+	}
+}
+
+// @brief Constructs a DumpBuffer
+// @param max_depth Nesting limit (if negative, no limit)
+// @param max_size Size limit in bytes (if 0, no limit)
+DumpBuffer::DumpBuffer (int max_depth, size_t max_size) : mMaxSize(max_size), mMaxDepth(max_depth), mTruncated(false)
+{
+}
+
+// @brief Clears the text, keeping its storage for reuse
+void DumpBuffer::Clear (void)
+{
+	mText.clear();
+
+	mTruncated = false;
+}
+
+// @brief Pretty prints a variable into a buffer, as per vardump.Print
+// @param L Lua state
+// @param index Stack index of variable
+// @param buffer Output buffer; lines are appended, each ending in a newline
+// @param indent Initial indent string, prepended to each line
+void Lua::VarDump (lua_State * L, int index, DumpBuffer & buffer, char const * indent)
+{
+	IndexAbsolute(L, index);
+
+	Dumper d(L, buffer, indent);
+
+	if (d.Full()) return;
+
+	d.Add(indent);
+
+	if (HasToString(L, index))
+	{
+		AddToString(d, index);
+
+		d.EndLine();
+	}
+
+	else if (lua_istable(L, index))
+	{
+		d.Add("table: {");
+		d.EndLine();
+
+		lua_newtable(L);// ..., guard
+
+		d.mGuard = lua_gettop(L);
+
+		DumpLevel(d, index, 0);
+
+		lua_pop(L, 1);	// ...
+	}
+
+	else
+	{
+		// Preface the pretty form with the type name, where prettying leaves it ambiguous.
+		switch (lua_type(L, index))
+		{
+		case LUA_TNUMBER:
+			if (IsInteger(lua_tonumber(L, index)))
+			{
+				d.Add("integer: ");
+
+				AddInteger(d, lua_tonumber(L, index));
+			}
+
+			else
+			{
+				d.Add("number: ");
+
+				AddRaw(d, index);
+			}
+			break;
+		case LUA_TSTRING:
+			d.Add("string: \"");
+
+			AddRaw(d, index);
+
+			d.Add("\"");
+			break;
+		case LUA_TBOOLEAN:
+			d.Add("boolean: ");
+			// Fall through.
+		default:
+			AddRaw(d, index);
+		}
+
+		d.EndLine();
+	}
+}
+
+// @brief __gc metamethod for dump buffers
+static int BufferGC (lua_State * L)
+{
+	static_cast<DumpBuffer *>(lua_touserdata(L, 1))->~DumpBuffer();
+
+	return 0;
+}
+
+// @brief Pushes a new dump buffer, owned by a userdata
+// @param L Lua state
+// @param max_depth Nesting limit (if negative, no limit)
+// @param max_size Size limit in bytes (if 0, no limit)
+// @return Buffer
+static DumpBuffer * NewBuffer (lua_State * L, int max_depth, size_t max_size)
+{
+	DumpBuffer * buffer = new (lua_newuserdata(L, sizeof(DumpBuffer))) DumpBuffer(max_depth, max_size);	// ..., buffer
+
+	lua_pushlightuserdata(L, &_BufferMeta);	// ..., buffer, key
+	lua_rawget(L, LUA_REGISTRYINDEX);	// ..., buffer, meta?
+
+	if (lua_isnil(L, -1))
+	{
+		lua_pop(L, 1);	// ..., buffer
+		lua_createtable(L, 0, 1);	// ..., buffer, meta
+		lua_pushcfunction(L, BufferGC);	// ..., buffer, meta, BufferGC
+		lua_setfield(L, -2, "__gc");	// ..., buffer, meta = { __gc = BufferGC }
+		lua_pushlightuserdata(L, &_BufferMeta);	// ..., buffer, meta, key
+		lua_pushvalue(L, -2);	// ..., buffer, meta, key, meta
+		lua_rawset(L, LUA_REGISTRYINDEX);	// ..., buffer, meta
+	}
+
+	lua_setmetatable(L, -2);// ..., buffer
+
+	return buffer;
+}
+
+// @brief Pretty prints a variable into a string
+// @note var: Variable to print
+// @note indent: Initial indent string; if absent, the empty string
+// @note max_depth: Nesting limit; if absent, no limit
+// @note max_size: Approximate size limit in bytes; if absent, no limit
+// @return Printout, one line per newline
+static int Dump (lua_State * L)
+{
+	int max_depth = luaL_optint(L, 3, -1);
+	size_t max_size = size_t(luaL_optint(L, 4, 0));
+	char const * indent = luaL_optstring(L, 2, "");
+
+	lua_settop(L, 4);	// var, indent, max_depth, max_size
+
+	// Give each call its own buffer, owned by a userdata: a metamethod may dump reentrantly
+	// or raise an error, in which case the collector reclaims the text.
+	DumpBuffer * buffer = NewBuffer(L, max_depth, max_size);// var, indent, max_depth, max_size, buffer
+
+	VarDump(L, 1, *buffer, indent);
+
+	lua_pushlstring(L, buffer->mText.data(), buffer->mText.size());	// var, indent, max_depth, max_size, buffer, str
+
+	return 1;
+}
+
+// @brief Opens the native VarDump printer
+// @note Registered as vardump_core
+int Bindings::open_vardump (lua_State * L)
+{
+	luaL_reg funcs[] = {
+		{ "Dump", Dump },
+		{ 0, 0 }
+	};
+
+	Register(L, "vardump_core", funcs);
+
+	return 0;
+}
@@ -1,6 +1,8 @@
 #ifndef LUA_VARS_H
 #define LUA_VARS_H
 
+#include <vector>
+
 namespace Lua
 {
 	/*%%%%%%%%%%%%%%%% TEMPLATED LOADER FUNCTIONS %%%%%%%%%%%%%%%%*/
@@ -120,6 +122,214 @@ namespace Lua
 	{
 		return Aux_FromMembersToFields<T, C, F>(L, func, index, *object);
 	}
+
+	/*%%%%%%%%%%%%%%%% COMPILED SCHEMAS %%%%%%%%%%%%%%%%*/
+
+	// @brief Gets the registry key of the schema name cache
+	inline void * SchemaCacheKey (void)
+	{
+		static int sKey;
+
+		return &sKey;
+	}
+
+	// @brief Gets a new schema ID
+	// @note IDs are never reused, so a schema at a recycled address cannot pick up stale names
+	inline int NewSchemaID (void)
+	{
+		static int sID;
+
+		return ++sID;
+	}
+
+	// @brief Loader that reads a Lua table into a C++ struct in one pass
+	// @note Field names are interned once per Lua state, in a registry table keyed by the schema's ID
+	template<typename C> class Schema {
+		typedef void (*Func)(void);	// Type-erased element reader
+
+		// @brief Member reader
+		struct Field {
+			char const * mName;	// Field name
+			size_t mOffset;	// Member offset
+			size_t mCount;	// Array: element count (if 0, member is not an array)
+			size_t mStride;	// Array: element size
+			void (*mRead)(lua_State *, Field const &, void *);	// Reads field on stack top into member memory
+			void (*mElement)(lua_State *, Field const &, void *);	// Array: reads element on stack top
+			Func mFunc;	// Value reader
+			void const * mSchema;	// Nested struct schema
+		};
+
+		std::vector<Field> mFields;	// Member readers
+		int mID;	// Name cache key
+
+		// @brief Reads a value
+		template<typename T> static void ReadValue (lua_State * L, Field const & field, void * pMember)
+		{
+			*static_cast<T *>(pMember) = reinterpret_cast<T (*)(lua_State *, int)>(field.mFunc)(L, -1);
+		}
+
+		// @brief Reads a nested struct
+		template<typename T> static void ReadStruct (lua_State * L, Field const & field, void * pMember)
+		{
+			if (!lua_istable(L, -1)) luaL_error(L, "Field \"%s\": table expected", field.mName);
+
+			static_cast<Schema<T> const *>(field.mSchema)->Load(L, -1, *static_cast<T *>(pMember));
+		}
+
+		// @brief Reads an array of values or structs
+		static void ReadArray (lua_State * L, Field const & field, void * pMember)
+		{
+			if (!lua_istable(L, -1)) luaL_error(L, "Field \"%s\": table expected", field.mName);
+
+			for (size_t i = 0; i < field.mCount; ++i)
+			{
+				lua_rawgeti(L, -1, int(i + 1));	// { ... }, t, t[i]
+
+				field.mElement(L, field, static_cast<char *>(pMember) + i * field.mStride);
+
+				lua_pop(L, 1);	// { ... }, t
+			}
+		}
+
+		// @brief Adds a field
+		Schema & Add (char const * name, size_t offset, void (*read)(lua_State *, Field const &, void *), Func func, void const * schema)
+		{
+			Field field = { name, offset, 0, 0, read, 0, func, schema };
+
+			mFields.push_back(field);
+
+			return *this;
+		}
+
+		// @brief Adds an array field
+		Schema & AddArray (char const * name, size_t offset, size_t count, size_t stride, void (*element)(lua_State *, Field const &, void *), Func func, void const * schema)
+		{
+			Add(name, offset, &ReadArray, func, schema);
+
+			mFields.back().mCount = count;
+			mFields.back().mStride = stride;
+			mFields.back().mElement = element;
+
+			return *this;
+		}
+
+	public:
+		Schema (void) : mID(NewSchemaID())
+		{
+		}
+
+		Schema (Schema const & schema) : mFields(schema.mFields), mID(NewSchemaID())
+		{
+		}
+
+		Schema & operator = (Schema const & schema)
+		{
+			mFields = schema.mFields;
+			mID = NewSchemaID();
+
+			return *this;
+		}
+
+		// @brief Gets a member's offset
+		template<typename T> static size_t Offset (T C::* member)
+		{
+			return size_t(&(reinterpret_cast<C const volatile *>(0)->*member));
+		}
+
+		// @brief Adds a value field
+		// @param name Field name
+		// @param member Member to receive field
+		// @param func Function used to read field
+		// @return Schema, for chaining
+		template<typename T> Schema & Value (char const * name, T C::* member, T (*func)(lua_State *, int))
+		{
+			return Add(name, Offset(member), &ReadValue<T>, reinterpret_cast<Func>(func), 0);
+		}
+
+		// @brief Adds a nested struct field
+		// @param name Field name
+		// @param member Member to receive field
+		// @param schema Schema for member (must outlive this schema)
+		// @return Schema, for chaining
+		template<typename T> Schema & Struct (char const * name, T C::* member, Schema<T> const & schema)
+		{
+			return Add(name, Offset(member), &ReadStruct<T>, 0, &schema);
+		}
+
+		// @brief Adds a fixed-length array field of values
+		// @param name Field name
+		// @param member Member to receive field
+		// @param func Function used to read elements
+		// @return Schema, for chaining
+		template<typename T, size_t N> Schema & Array (char const * name, T (C::* member)[N], T (*func)(lua_State *, int))
+		{
+			return AddArray(name, Offset(member), N, sizeof(T), &ReadValue<T>, reinterpret_cast<Func>(func), 0);
+		}
+
+		// @brief Adds a fixed-length array field of structs
+		// @param name Field name
+		// @param member Member to receive field
+		// @param schema Schema for elements (must outlive this schema)
+		// @return Schema, for chaining
+		template<typename T, size_t N> Schema & Array (char const * name, T (C::* member)[N], Schema<T> const & schema)
+		{
+			return AddArray(name, Offset(member), N, sizeof(T), &ReadStruct<T>, 0, &schema);
+		}
+
+		// @brief Loads a table's fields into an object
+		// @param L Lua state
+		// @param index Table index
+		// @param object Object to load
+		void Load (lua_State * L, int index, C & object) const
+		{
+			IndexAbsolute(L, index);
+
+			// Fetch the interned names, building them on first use or if fields were added since.
+			lua_pushlightuserdata(L, SchemaCacheKey());	// ..., key
+			lua_rawget(L, LUA_REGISTRYINDEX);	// ..., cache?
+
+			if (lua_isnil(L, -1))
+			{
+				lua_pop(L, 1);	// ...
+				lua_newtable(L);// ..., cache
+				lua_pushlightuserdata(L, SchemaCacheKey());	// ..., cache, key
+				lua_pushvalue(L, -2);	// ..., cache, key, cache
+				lua_rawset(L, LUA_REGISTRYINDEX);	// ..., cache
+			}
+
+			lua_rawgeti(L, -1, mID);// ..., cache, names?
+
+			if (lua_isnil(L, -1) || lua_objlen(L, -1) != mFields.size())
+			{
+				lua_pop(L, 1);	// ..., cache
+				lua_createtable(L, int(mFields.size()), 0);	// ..., cache, names
+
+				for (size_t i = 0; i < mFields.size(); ++i)
+				{
+					lua_pushstring(L, mFields[i].mName);// ..., cache, names, name
+					lua_rawseti(L, -2, int(i + 1));	// ..., cache, names = { ..., name }
+				}
+
+				lua_pushvalue(L, -1);	// ..., cache, names, names
+				lua_rawseti(L, -3, mID);// ..., cache = { ..., [id] = names }, names
+			}
+
+			lua_remove(L, -2);	// ..., names
+
+			// Read each field into its member.
+			for (size_t i = 0; i < mFields.size(); ++i)
+			{
+				lua_rawgeti(L, -1, int(i + 1));	// ..., names, name
+				lua_gettable(L, index);	// ..., names, value
+
+				mFields[i].mRead(L, mFields[i], reinterpret_cast<char *>(&object) + mFields[i].mOffset);
+
+				lua_pop(L, 1);	// ..., names
+			}
+
+			lua_pop(L, 1);	// ...
+		}
+	};
 }
 
 #endif // LUA_VARS_H
\ No newline at end of file
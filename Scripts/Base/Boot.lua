@@ -8,5 +8,6 @@ return {
 	"Coroutine",
 	"CoroutineOps",
 	"Class",
-	"VarDump"
+	"VarDump",
+	"Random"
 }, ...
\ No newline at end of file
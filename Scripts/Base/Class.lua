@@ -4,9 +4,11 @@
 local assert = assert
 local format = string.format
 local getmetatable = getmetatable
+local huge = math.huge
 local ipairs = ipairs
 local newproxy = newproxy
 local pairs = pairs
+local remove = table.remove
 local setmetatable = setmetatable
 local tostring = tostring
 local type = type
@@ -14,10 +16,14 @@ local type = type
 -- Imports --
 local Copy = table_ex.Copy
 local IsCallable = varops.IsCallable
+local StoreTraceback = funcops.StoreTraceback
 local Weak = table_ex.Weak
 local WithBoundTable = table_ex.WithBoundTable
 local WithResource = funcops.WithResource
 
+-- Native class runtime, if registered by the host --
+local Core = package.loaded.class_core
+
 -- Cached routines --
 local IsInstance_
 local IsType_
@@ -83,6 +89,43 @@ local Linearizations = setmetatable({}, {
     end
 })
 
+-- Builds an instance pool from its parameters (q.v. Define)
+-- pool: Pool parameters
+-- Returns: Pool
+local function MakePool (pool)
+	local max, reset = huge
+
+	if type(pool) == "number" then
+		assert(pool >= 0, "Invalid pool size")
+
+		max = pool
+
+	elseif pool ~= true then
+		assert(type(pool) == "table", "Invalid pool parameters")
+		assert(pool.max == nil or (type(pool.max) == "number" and pool.max >= 0), "Invalid pool size")
+		assert(pool.reset == nil or IsCallable(pool.reset), "Uncallable pool reset")
+
+		max, reset = pool.max or huge, pool.reset
+	end
+
+	return { free = {}, hits = 0, misses = 0, max = max, reset = reset }
+end
+
+-- Resets an instance, removes it from the live set, and keeps it in a pool, if there is room
+-- I: Instance handle
+-- pool: Pool of instance's type
+local function Keep (I, pool)
+	if pool.reset then
+		pool.reset(I)
+	end
+
+	Instances[I] = nil
+
+	if #pool.free < pool.max then
+		pool.free[#pool.free + 1] = I
+	end
+end
+
 do
 	-- Per-class data for default allocations --
 	local ClassData = setmetatable({}, {
@@ -119,6 +162,11 @@ do
 		InstanceData[I][key] = value
 	end
 
+	-- Under the native runtime, default instances keep their data in an environment table.
+	if Core then
+		DefaultAlloc, DefaultIndex, DefaultNewIndex = Core.Alloc, Core.EnvIndex, Core.EnvNewIndex
+	end
+
 	-- Common __index body
 	-- I: Instance handle
 	-- key: Lookup key
@@ -168,9 +216,15 @@ do
 	-- Entries with names corresponding to metamethods will be installed as such.
 	-- @param cons Constructor function, called each time class is instantiated.
 	-- @param params Configuration parameters.<br><br>
+	-- If <b>pool</b> is present, instances given to <b>Recycle</b> are kept and handed out
+	-- again by <b>New</b>. It may be <b>true</b>, a number (the most instances to keep), or a
+	-- table with optional fields <b>max</b>, as per the number, and <b>reset</b>, called with
+	-- the instance on recycling.
 	-- @see GetMember
+	-- @see GetPoolStats
 	-- @see New
 	-- @see NewArray
+	-- @see Recycle
 	function Define (ctype, members, cons, params)
 		assert(ctype ~= nil, "Define: ctype == nil")
 		assert(ctype == ctype, "Define: ctype is NaN")
@@ -229,6 +283,11 @@ do
 
 				def.alloc = alloc
 			end
+
+			-- Give the class an instance pool, if requested.
+			if params.pool then
+				def.pool = MakePool(params.pool)
+			end
 		end
 
 		-- If the caller loads the members in a function, regularize this to the table case,
@@ -271,8 +330,34 @@ do
 		def.meta.__newindex = NewIndex
 		def.meta.__metatable = true
 
-		-- Register the class.
+		-- Register the class. The native runtime replaces the master lookups with ones
+		-- specialized to the class.
 		Defs[ctype] = def
+
+		if Core then
+			Core.Define(ctype, def)
+		end
+	end
+
+	--- Gives a defined class an instance pool, e.g. a type defined by the application whose
+	-- bindings hand out temporaries.
+	-- @param ctype Class type name.
+	-- @param pool Pool parameters, as per the <b>pool</b> parameter of <b>Define</b>.
+	-- @see Define
+	-- @see GetPoolStats
+	function SetPool (ctype, pool)
+		assert(ctype ~= nil, "SetPool: ctype == nil")
+		assert(pool, "SetPool: no pool parameters")
+
+		local def = assert(Defs[ctype], "Type not found")
+
+		assert(not def.pool, "Type already pooled")
+
+		def.pool = MakePool(pool)
+
+		if Core then
+			Core.SetPool(ctype, def.pool)
+		end
 	end
 end
 
@@ -296,6 +381,19 @@ function GetMember (ctype, member)
 	return assert(Defs[ctype], "Type not found").members[member]
 end
 
+-- ctype: Type name
+-- Returns: Pool hit count, miss count, and free instance count; nothing if unpooled
+------------------------------------------------------------------------------------
+function GetPoolStats (ctype)
+	assert(ctype ~= nil, "GetPoolStats: ctype == nil")
+
+	local pool = assert(Defs[ctype], "Type not found").pool
+
+	if pool then
+		return pool.hits, pool.misses, #pool.free
+	end
+end
+
 -- Returns: If true, item is a class instance
 ----------------------------------------------
 function IsInstance (item)
@@ -392,6 +490,27 @@ do
 		return cond
 	end
 
+	-- Gets an instance to construct, drawing from the pool if possible
+	-- type_info: Class definition
+	-- Returns: Instance handle
+	local function Acquire (type_info)
+		local pool = type_info.pool
+
+		if pool then
+			local I = remove(pool.free)
+
+			if I ~= nil then
+				pool.hits = pool.hits + 1
+
+				return I
+			end
+
+			pool.misses = pool.misses + 1
+		end
+
+		return type_info.alloc(type_info.meta)
+	end
+
 	-- Instantiates a class
 	-- ctype: Type name
 	-- ...: Constructor arguments
@@ -401,7 +520,7 @@ do
 		assert(ctype ~= nil, "class.New: ctype == nil")
 
 		local type_info = assertf(Defs[ctype], "class.New: Type \"%s\" not found", ctype)
-		local I = type_info.alloc(type_info.meta)
+		local I = Acquire(type_info)
 
 		WithResource(nil, Use, Release, 1, type_info.cons, I, ctype, ...)
 
@@ -420,21 +539,30 @@ do
 
 		-- Cache common properties.
 		local type_info = assertf(Defs[ctype], "class.NewArray: Type \"%s\" not found", ctype)
-		local alloc = type_info.alloc
 		local cons = type_info.cons
-		local meta = type_info.meta
 
 		-- Construct the instances.
 		local array = {}
 
 		for i = 1, count do
-			array[i] = alloc(meta)
+			array[i] = Acquire(type_info)
 
 			WithResource(nil, Use, Release, 1, cons, array[i], ctype, ...)
 		end
 
 		return array
 	end
+
+	-- Returns an instance to its type's pool; the handle is dead until New hands it out
+	-- again, reconstructed. This is the only way into a pool: instances that are simply
+	-- dropped are collected as usual
+	-- I: Instance handle
+	---------------------------------------------------------------------------------------
+	function Recycle (I)
+		local ctype = assert(I ~= nil and Instances[I], "Recycle: Not an instance")
+
+		Keep(I, assert(Defs[ctype].pool, "Recycle: Type not pooled"))
+	end
 end
 
 -- ctype: Type name
@@ -464,6 +592,20 @@ end
 -- Export the hidden value type.
 Hidden = u_Hidden
 
+-- Swap in the native hot paths, if available.
+if Core then
+	Core.Init(Instances, u_Hidden, StoreTraceback)
+
+	GetPoolStats = Core.GetPoolStats
+	IsInstance = Core.IsInstance
+	IsType = Core.IsType
+	New = Core.New
+	NewArray = Core.NewArray
+	Recycle = Core.Recycle
+	SuperCons = Core.SuperCons
+	Type = Core.Type
+end
+
 -- Cache some routines.
 IsInstance_ = IsInstance
 IsType_ = IsType
\ No newline at end of file
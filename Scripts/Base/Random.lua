@@ -0,0 +1,92 @@
+-- See TacoShell Copyright Notice in main folder of distribution
+
+-- Standard library imports --
+local random = math.random
+local randomseed = math.randomseed
+
+-- Native generator, if available --
+local Core = package.loaded.random_core
+
+-- Export the random namespace.
+module "random"
+
+if Core then
+	--- Draws a number from the default stream, as per <b>math.random</b>.
+	-- @class function
+	-- @name Random
+	-- @param m Optional upper bound; with <i>n</i>, lower bound.
+	-- @param n Optional upper bound.
+	-- @return If <i>m</i> is absent, a number in [0, 1); otherwise, an integer in [1, <i>m</i>]
+	-- or [<i>m</i>, <i>n</i>].
+	Random = Core.Random
+
+	--- Draws a number in [<i>a</i>, <i>b</i>) from the default stream.
+	-- @class function
+	-- @name Rand
+	-- @param a Lower bound.
+	-- @param b Upper bound.
+	-- @return Number.
+	Rand = Core.Rand
+
+	--- Draws a number in [<i>x</i> - <i>dx</i>, <i>x</i> + <i>dx</i>) from the default stream.
+	-- @class function
+	-- @name RBy
+	-- @param x Center value.
+	-- @param dx Spread.
+	-- @return Number.
+	RBy = Core.RBy
+
+	--- Draws a normally distributed number from the default stream.
+	-- @class function
+	-- @name Gaussian
+	-- @param mean Optional mean; if absent, 0.
+	-- @param sd Optional standard deviation; if absent, 1.
+	-- @return Number.
+	Gaussian = Core.Gaussian
+
+	--- Fills a typed array or table with draws from the default stream.
+	-- @class function
+	-- @name Fill
+	-- @param target <b>Float32Array</b>, <b>Float64Array</b>, <b>Int32Array</b>, or table.
+	-- @param kind One of <b>"uniform"</b>, <b>"range"</b> or <b>"gaussian"</b>.
+	-- @param a Optional range lower bound or mean.
+	-- @param b Optional range upper bound or standard deviation.
+	-- @param count Optional count to fill; if absent, the whole array.
+	-- @return <i>target</i>.
+	Fill = Core.Fill
+
+	--- Reseeds the default stream.
+	-- @class function
+	-- @name Seed
+	-- @param seed Seed value.
+	Seed = Core.Seed
+
+	--- Gets a named stream, creating it on first use. Streams have their own state, and
+	-- offer the functions in this module as methods, along with <b>Fill</b>, <b>Gaussian</b>,
+	-- <b>GetState</b> and <b>SetState</b>.
+	-- @class function
+	-- @name Stream
+	-- @param name Stream name.
+	-- @param seed Optional seed for a new stream.
+	-- @return Stream.
+	Stream = Core.Stream
+
+	--- Reseeds every named stream, e.g. to start a deterministic replay.
+	-- @class function
+	-- @name SeedAll
+	-- @param seed Seed value.
+	SeedAll = Core.SeedAll
+
+else
+	Random = random
+	Seed = randomseed
+
+	-- Rand, RBy
+	function Rand (a, b)
+		return a + (b - a) * random()
+	end
+
+	function RBy (x, dx)
+		return x + dx * (2 * random() - 1)
+	end
+end
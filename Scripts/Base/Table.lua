@@ -23,14 +23,18 @@ local IsCallable = varops.IsCallable
 local IsNaN = varops.IsNaN
 local UnpackClearAndRecache = varops.UnpackClearAndRecache
 
+-- Native core, if registered: destinations are presized and filled with raw access --
+local Core = package.loaded.table_core
+
 -- Cached routines --
 local Copy_
 local DeepCopy_
 local Map_
 local WithBoundTable_
 
--- Routine used to consume tables --
+-- Routines used to consume tables --
 local GetTable
+local TakeTable
 
 -- Export the table_ex namespace.
 module "table_ex"
@@ -59,6 +63,10 @@ end
 -- @see Map
 -- @see WithBoundTable
 function Copy (t, how, how_arg)
+	if Core then
+		return Core.Copy(TakeTable(), t, how, how_arg)
+	end
+
     return Map_(t, Identity, how, nil, how_arg)
 end
 
@@ -91,6 +99,10 @@ end
 -- Otherwise, a <b>nil</b> is inserted after the last live entry.
 -- @return Size of table after culling.
 function CullingForEach (t, func, arg, clear_dead)
+	if Core then
+		return Core.CullingForEach(t, func, arg, clear_dead)
+	end
+
 	local kept = 0
 	local count = #t
 
@@ -121,11 +133,17 @@ do
 	end
 
 	--- Deep-copies a table.<br><br>
-	-- This will also copy metatables, and thus assumes these are accessible.
+	-- This will also copy metatables, and thus assumes these are accessible.<br><br>
+	-- Under the native core, each subtable is copied once, so shared subtables stay shared
+	-- in the copy and cycles are handled.
 	-- @param t Table to copy.
 	-- @return Copy.
 	-- @see WithBoundTable
 	function DeepCopy (t)
+		if Core then
+			return Core.DeepCopy(TakeTable(), t)
+		end
+
 		return setmetatable(Map_(t, Mapping), getmetatable(t))
 	end
 end
@@ -396,6 +414,10 @@ end
 -- Returns: Mapped table
 --------------------------------------------------
 function Map (t, map, how, arg, how_arg)
+	if Core then
+		return Core.Map(TakeTable(), t, map, how, arg, how_arg)
+	end
+
 	local dt = GetTable()
 
 	if how then
@@ -459,6 +481,10 @@ end
 -- Returns: Mapped table
 --------------------------------------------------
 function MapKV (t, map, how, arg, how_arg)
+	if Core then
+		return Core.MapKV(TakeTable(), t, map, how, arg, how_arg)
+	end
+
 	local dt = GetTable()
 
 	if how then
@@ -486,6 +512,10 @@ end
 -- Returns: Destination table
 -----------------------------------------
 function Move (t, how, how_arg)
+	if Core then
+		return Core.Move(TakeTable(), t, how, how_arg)
+	end
+
 	local dt = GetTable()
 
 	if t ~= dt then
@@ -563,14 +593,20 @@ do
 	-- Intermediate destination table --
     local DT
 
-    -- Consumes and supplies a bound table
-    -- Returns: Bound or new table
-    function GetTable ()
+    -- Consumes a bound table
+    -- Returns: Bound table, or nil
+    function TakeTable ()
         local t = DT
 
         DT = nil
 
-        return t or {}
+        return t
+    end
+
+    -- Consumes and supplies a bound table
+    -- Returns: Bound or new table
+    function GetTable ()
+        return TakeTable() or {}
     end
 
 	-- Valid consumers --
@@ -3,6 +3,7 @@
 -- Standard library imports --
 local assert = assert
 local format = string.format
+local gmatch = string.gmatch
 local insert = table.insert
 local ipairs = ipairs
 local pairs = pairs
@@ -17,6 +18,9 @@ local IsCallable = varops.IsCallable
 local IsInteger = varops.IsInteger
 local SubTablesOnDemand = table_ex.SubTablesOnDemand
 
+-- Native printer, if available --
+local Core = package.loaded.vardump_core
+
 -- Export the vardump namespace.
 module "vardump"
 
@@ -118,14 +122,23 @@ end
 -- if absent, the default output function is used.
 -- @param indent Initial indent string; if absent, the empty string.<br><br>
 -- If the variable is a table, this is prepended to each line of the printout.
+-- @param max_depth Optional nesting limit; deeper tables are not opened up.
+-- @param max_size Optional size limit, in bytes, after which the printout is cut short.<br><br>
+-- The limits are only honored by the native printer.
 -- @see SetDefaultOutf
-function Print (var, outf, indent)
+function Print (var, outf, indent, max_depth, max_size)
 	outf = outf or DefaultOutf
 	indent = indent or ""
 
 	assert(IsCallable(outf), "Invalid output function")
 
-	if HasMeta(var, "__tostring") then
+	-- With the native printer, build the whole printout at once, then feed it out.
+	if Core then
+		for line in gmatch(Core.Dump(var, indent, max_depth, max_size), "([^\n]*)\n") do
+			outf("%s", line)
+		end
+
+	elseif HasMeta(var, "__tostring") then
 		outf("%s%s", indent, tostring(var))
 
 	elseif type(var) == "table" then
@@ -19,6 +19,9 @@ local CollectCount = ...
 -- Pure Lua hacks --
 local debug_getmetatable = debug.getmetatable
 
+-- Native table_ex core, if registered --
+local Core = package.loaded.table_core
+
 -- Cached routines --
 local ClearRange_
 local HasMeta_
@@ -164,6 +167,10 @@ do
 	-- @param wipe Value used to wipe cleared entries.
 	-- @return Array.
 	function ClearRange (array, first, last, wipe)
+		if Core then
+			return Core.ClearRange(array, first, last, wipe)
+		end
+
 		for i = first or 1, last or #array do
 			array[i] = wipe
 		end
@@ -0,0 +1,77 @@
+-- See TacoShell Copyright Notice in main folder of distribution
+
+-- Typed arrays: bulk kernels against the equivalent loops over Lua tables.
+
+-- Modules --
+local bench = bench
+local class = class
+
+if not class.Exists("Float32Array") then
+	return
+end
+
+local N, Reps = 100000, 100
+
+-- Lua tables --
+local t, x = {}, {}
+
+for i = 1, N do
+	t[i], x[i] = i * .001, 1
+end
+
+-- Typed arrays --
+local A, X = class.New("Float32Array", t), class.New("Float32Array", x)
+
+bench.Time("Lua loop: fill", Reps, function()
+	for i = 1, N do
+		t[i] = 2
+	end
+end)
+
+bench.Time("Float32Array:Fill", Reps, function()
+	A:Fill(2)
+end)
+
+bench.Time("Lua loop: axpy", Reps, function()
+	for i = 1, N do
+		t[i] = t[i] + .5 * x[i]
+	end
+end)
+
+bench.Time("Float32Array:Axpy", Reps, function()
+	A:Axpy(.5, X)
+end)
+
+bench.Time("Lua loop: scale", Reps, function()
+	for i = 1, N do
+		t[i] = t[i] * .5
+	end
+end)
+
+bench.Time("Float32Array:Scale", Reps, function()
+	A:Scale(.5)
+end)
+
+bench.Time("Lua loop: clamp", Reps, function()
+	for i = 1, N do
+		local v = t[i]
+
+		t[i] = v < 0 and 0 or (v > 1 and 1 or v)
+	end
+end)
+
+bench.Time("Float32Array:Clamp", Reps, function()
+	A:Clamp(0, 1)
+end)
+
+bench.Time("Lua loop: sum", Reps, function()
+	local sum = 0
+
+	for i = 1, N do
+		sum = sum + t[i]
+	end
+end)
+
+bench.Time("Float32Array:Sum", Reps, function()
+	A:Sum()
+end)
@@ -0,0 +1,10 @@
+-- See TacoShell Copyright Notice in main folder of distribution
+
+-- Benchmarks. These are not part of the application boot; run them after it, with
+-- Lua::LoadDir(L, "Scripts/Bench/Boot"), and compare the printed timings across builds.
+return {
+	"Timer",
+	"Class",
+	"Calls",
+	"Arrays"
+}, ...
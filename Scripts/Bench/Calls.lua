@@ -0,0 +1,68 @@
+-- See TacoShell Copyright Notice in main folder of distribution
+
+-- Bound calls: argument validation overhead. Run once per build, with LUA_CHECKS defined as each of
+-- LUA_CHECKS_FULL, LUA_CHECKS_DEBUG (with NDEBUG), and LUA_CHECKS_NONE, to compare the policies.
+-- The bench_core timings need Bindings::open_bench registered.
+
+-- Modules --
+local bench = bench
+local class = class
+
+-- Native libraries, if available --
+local RandomCore = package.loaded.random_core
+
+if RandomCore then
+	local Stream = RandomCore.Stream("bench")
+
+	bench.Time("Stream:Rand (userdata, 2 numbers)", 2000000, function()
+		Stream:Rand(1, 2)
+	end)
+end
+
+if class.Exists("Float32Array") then
+	local A = class.New("Float32Array", 64)
+
+	bench.Time("Float32Array:Set (userdata, 2 numbers)", 2000000, function(i)
+		A:Set(i % 64 + 1, i)
+	end)
+
+	bench.Time("Float32Array:Get (userdata, number)", 2000000, function(i)
+		A:Get(i % 64 + 1)
+	end)
+
+	bench.Time("Float32Array __index", 2000000, function(i)
+		local _ = A[i % 64 + 1]
+	end)
+end
+
+-- Bound calls through the Arg accessors, _pT, and peer accessors, as used by the engine bindings --
+local BenchCore = package.loaded.bench_core
+
+if BenchCore then
+	local Args = BenchCore.Args
+	local ud = newproxy()
+
+	bench.Time("Args (number, integer, boolean, userdata)", 2000000, function(i)
+		Args(i + .5, i, true, ud)
+	end)
+
+	local P, Q = class.New("BenchPoint", 3, 4), class.New("BenchPoint", 1, 1)
+
+	bench.Time("BenchPoint:Length (_pT)", 2000000, function()
+		P:Length()
+	end)
+
+	bench.Time("BenchPoint:Add (_pT x 2)", 2000000, function()
+		P:Add(Q)
+	end)
+
+	local peer = BenchCore.NewPeer()
+
+	bench.Time("Peer member get", 2000000, function()
+		local _ = peer.x
+	end)
+
+	bench.Time("Peer member set", 2000000, function(i)
+		peer.n = i
+	end)
+end
@@ -0,0 +1,42 @@
+-- See TacoShell Copyright Notice in main folder of distribution
+
+-- Class runtime: construction and member access. Run once with class_core registered and once
+-- without it to compare the native runtime against the Lua one.
+
+-- Modules --
+local bench = bench
+local class = class
+
+class.Define("Bench:Base", function(Base)
+	function Base:Get ()
+		return self.x
+	end
+end, function(B, x)
+	B.x = x
+end)
+
+class.Define("Bench:Derived", function(Derived)
+	function Derived:Twice ()
+		return self:Get() * 2
+	end
+end, function(D, x)
+	class.SuperCons(D, "Bench:Base", x)
+
+	D.y = 1
+end, { base = "Bench:Base" })
+
+local D = class.New("Bench:Derived", 21)
+
+printf(package.loaded.class_core and "class: native runtime" or "class: Lua runtime")
+
+bench.Time("class.New (derived)", 200000, function(i)
+	class.New("Bench:Derived", i)
+end)
+
+bench.Time("Inherited method call", 2000000, function()
+	D:Get()
+end)
+
+bench.Time("Field read", 2000000, function()
+	local _ = D.y
+end)
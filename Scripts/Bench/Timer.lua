@@ -0,0 +1,30 @@
+-- See TacoShell Copyright Notice in main folder of distribution
+
+-- Standard library imports --
+local clock = os.clock
+local collectgarbage = collectgarbage
+local printf = printf
+
+-- Export bench namespace.
+module "bench"
+
+--- Times repeated calls to a function.
+-- @param name Name to report.
+-- @param count Call count.
+-- @param func Function to time, called as <i>func(i)</i> for each <i>i</i> in [1, <i>count</i>].
+-- @return Elapsed time, in seconds.
+function Time (name, count, func)
+	collectgarbage()
+
+	local t0 = clock()
+
+	for i = 1, count do
+		func(i)
+	end
+
+	local elapsed = clock() - t0
+
+	printf("%s: %.3f s (%d calls)", name, elapsed, count)
+
+	return elapsed
+end
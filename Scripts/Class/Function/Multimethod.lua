@@ -5,10 +5,12 @@ local assert = assert
 local insert = table.insert
 local ipairs = ipairs
 local remove = table.remove
+local select = select
 
 -- Imports --
 local ClearRange = varops.ClearRange
 local CollectArgsInto = varops.CollectArgsInto
+local Hidden = class.Hidden
 local IsCallable = varops.IsCallable
 local IsType = class.IsType
 local Linearization = class.Linearization
@@ -17,6 +19,7 @@ local Type = class.Type
 
 -- Unique member keys --
 local _args_cache = {}
+local _cache = {}
 local _funcs = {}
 local _key = {}
 local _last = {}
@@ -25,6 +28,63 @@ local _paramc = {}
 -- Cache of function list tables --
 local FuncsCache = {}
 
+-- Dispatch cache operations: the cache is a tree of tables, keyed by argument type at each
+-- level, with the resolved function at the leaves. All hidden classes share one type value,
+-- which says nothing about which function applies, so calls with hidden argument types are
+-- never cached. Native versions are used if registered.
+local Core = package.loaded.dispatch_core
+local Lookup, Store
+
+if Core then
+	Lookup, Store = Core.Lookup, Core.Store
+
+else
+	-- cache: Dispatch cache
+	-- paramc: Dispatch-relevant parameter count
+	-- ...: Call arguments
+	-- Returns: Cached function, or nil
+	----------------------------------------------
+	function Lookup (cache, paramc, ...)
+		local node = cache
+
+		for i = 1, paramc do
+			local atype = Type((select(i, ...)))
+
+			node = atype ~= Hidden and node[atype]
+
+			if not node then
+				return nil
+			end
+		end
+
+		return node
+	end
+
+	-- cache: Dispatch cache
+	-- paramc: Dispatch-relevant parameter count
+	-- func: Function resolved for arguments
+	-- ...: Call arguments
+	-----------------------------------------------
+	function Store (cache, paramc, func, ...)
+		for i = 1, paramc do
+			if Type((select(i, ...))) == Hidden then
+				return
+			end
+		end
+
+		local node = cache
+
+		for i = 1, paramc - 1 do
+			local atype = Type((select(i, ...)))
+			local child = node[atype] or {}
+
+			node[atype], node = child, child
+		end
+
+		node[Type((select(paramc, ...)))] = func
+	end
+end
+
 -- Multimethod class definition --
 class.Define("Multimethod", function(Multimethod)
 	-- Metamethod.<br><br>
@@ -33,10 +93,21 @@ class.Define("Multimethod", function(Multimethod)
 	-- fit the arguments, the ones that most completely match the first argument are chosen.
 	-- From those in turn, the ones that best match the second argument are chosen, and so
 	-- on until one function remains, which is then called.<br><br>
-	-- If no function matches the arguments, an error is thrown.
+	-- If no function matches the arguments, an error is thrown.<br><br>
+	-- The choice is cached by argument types, so later calls with the same types skip
+	-- straight to the function.
 	-- @param ... Call arguments.
 	-- return Call results.
 	function Multimethod:__call (...)
+		local cache = self[_cache]
+		local cached = Lookup(cache, self[_paramc], ...)
+
+		if cached then
+			self[_last] = cached
+
+			return cached(...)
+		end
+
 		local funcs = remove(FuncsCache) or {}
 		local source = self[_funcs]
 
@@ -146,7 +217,9 @@ class.Define("Multimethod", function(Multimethod)
 		args_cache[#args_cache + 1] = args
 		FuncsCache[#FuncsCache + 1] = funcs
 
-		-- Save and invoke the remaining function.
+		-- Cache, save, and invoke the remaining function.
+		Store(cache, self[_paramc], func, ...)
+
 		self[_last] = func
 
 		return func(...)
@@ -169,6 +242,9 @@ class.Define("Multimethod", function(Multimethod)
 
 		assert(count <= self[_paramc])
 
+		-- Invalidate any cached dispatch.
+		self[_cache] = {}
+
 		for _, entry in ipairs(self[_funcs]) do
 			local index = 0
 
@@ -222,6 +298,9 @@ function(M, paramc)
 	-- Argument table cache --
 	M[_args_cache] = {}
 
+	-- Dispatch cache --
+	M[_cache] = {}
+
 	-- Function definitions --
 	M[_funcs] = {}
 	
@@ -3,8 +3,8 @@ local _G = _G
 local GetScreenSize = game.GetScreenSize
 local GetTimeDifference = engine.GetTimeDifference
 local New = class.New
-local Rand = math_ex.Rand
-local RBy = math_ex.RBy
+local Rand = random.Rand
+local RBy = random.RBy
 
 -- Splat picture properties --
 local Color = New("Color", "white")
@@ -36,7 +36,7 @@ class.Define("SnowSplats", function(SnowSplats)
         local splats = self.splats
 		local diff = GetTimeDifference()
 
-        for i, splat in splats:IPairs() do
+        for i, splat in splats:Iter() do
             local age = splat.age
             local grow_until = splat.grow
             local stay_until = grow_until + splat.stay
@@ -57,7 +57,7 @@ class.Define("SnowSplats", function(SnowSplats)
                 splat.age = age + diff
 
 			else
-				splats:Remove(i)
+				splats:RemoveAt(i)
             end
         end
 
@@ -74,13 +74,13 @@ end,
 -- Constructor
 ---------------
 function(S)
-    S.splats = New("OrderlessArray")
+    S.splats = New("SlotMap")
 
 	-- Add an attachment widget to display the splats.
 	S.attach = _G.ui.Widget("render", function(A, x, y, w, h)
 	    local tw, th = Tex:GetWidth(), Tex:GetHeight()
 
-        for _, splat in S.splats:IPairs() do
+        for _, splat in S.splats:Iter() do
             local state = splat.state
 			local splat_y = splat.y
 			local t = splat.t or 0
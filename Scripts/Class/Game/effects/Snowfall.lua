@@ -2,7 +2,7 @@
 -- Imports
 -----------
 local ipairs = ipairs
-local ceil, min, random, sqrt = math.ceil, math.min, math.random, math.sqrt
+local ceil, min, sqrt = math.ceil, math.min, math.sqrt
 local remove = table.remove
 local EnterRender2D = gfx.EnterRender2D
 local _G = _G
@@ -11,8 +11,9 @@ local GetTimeDifference = engine.GetTimeDifference
 local LeaveRender2D = gfx.LeaveRender2D
 local New = class.New
 local NewArray = class.NewArray
-local Rand = math_ex.Rand
-local RBy = math_ex.RBy
+local Rand = random.Rand
+local RBy = random.RBy
+local Random = random.Random
 local RotateIndex = numericops.RotateIndex
 
 -----------------------------------
@@ -39,7 +40,7 @@ class.Define("Snowfall", function(MT)
 			path:DeleteAllPathNodes()
 
 		else
-			count = random(3, 8)
+			count = Random(3, 8)
 
 			path = New("Path", count)
 
@@ -93,12 +94,12 @@ class.Define("Snowfall", function(MT)
 				-- Replace a dead flake if desired.
 				elseif states[i] == nil and i <= count then
 					-- Assign a random alpha to the flake, and pick a horizontal slot.
-					Color.a, self.slot = random(32, 100), RotateIndex(self.slot, nslots)
+					Color.a, self.slot = Random(32, 100), RotateIndex(self.slot, nslots)
 
 					-- Choose a position above the screen at the current slot. Choose another
 					-- below the screen, displaced a bit horizontally from the first. Assign a
 					-- random square size to the flake.
-					local size, state, path, count = random(32, 110), GetState(self)
+					local size, state, path, count = Random(32, 110), GetState(self)
 					local x1, y1 = RBy(sw * (self.slot - .5), sw), -size * Rand(2, 6)
 					local x2, y2 = RBy(x1, size * 3), vh + size * 2
 
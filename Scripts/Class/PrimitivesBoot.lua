@@ -1,6 +1,16 @@
 -- See TacoShell Copyright Notice in main folder of distribution
 
 return {
+	-- Pool the value types that bindings hand out as temporaries (q.v. _getmemberT_arg), so that
+	-- ones given back to class.Recycle are reused.
+	function()
+		for _, ctype in ipairs{ "Color", "Vec3D" } do
+			if class.Exists(ctype) then
+				class.SetPool(ctype, 256)
+			end
+		end
+	end,
+
 	{ name = "Mixins", boot = "Boot" },
 	{ name = "Function", boot = "Boot" }
-}, ...
\ No newline at end of file
+}, ...
@@ -10,31 +10,67 @@ local RangeOverlap = numericops.RangeOverlap
 -- Export table --
 local Export = ...
 
+-- Native sequence index, if registered: interval bounds are then tracked as markers in the
+-- owner's index, rather than being updated one by one on each change --
+local Core = package.loaded.sequence_core
+
 -- Unique interval class name --
 local u_IntervalName = {}
 
 -- Unique member keys --
 local _count = {}
+local _end_marker = {}
 local _index = {}
 local _sequence = {}
 local _start = {}
+local _start_marker = {}
+
+-- Drops the interval's markers
+-- I: Interval handle
+local function DetachAll (I)
+	local sequence = I[_sequence]
+
+	if I[_start_marker] then
+		Export.Detach(sequence, I[_start_marker])
+	end
+
+	if I[_end_marker] then
+		Export.Detach(sequence, I[_end_marker])
+	end
+
+	I[_start_marker], I[_end_marker] = nil
+end
 
 -- Interval class definition --
 class.Define(u_IntervalName, function(Interval)
 	--- Clears the selection.
 	function Interval:Clear ()
+		if Core then
+			DetachAll(self)
+		end
+
 		self[_count] = 0
 	end
 
 	--- Gets the starting position of the interval.
 	-- @return Current start index, or <b>nil</b> if empty.
 	function Interval:GetStart ()
+		if self[_start_marker] then
+			return Export.Position(self[_sequence], self[_start_marker])
+		end
+
 		return self[_count] > 0 and self[_start] or nil
 	end
 
 	--- Metamethod.
 	-- @return Size of selected interval.
 	function Interval:__len ()
+		if self[_start_marker] then
+			local sequence = self[_sequence]
+
+			return Export.Position(sequence, self[_end_marker]) - Export.Position(sequence, self[_start_marker])
+		end
+
 		return self[_count]
 	end
 
@@ -44,6 +80,19 @@ class.Define(u_IntervalName, function(Interval)
 	function Interval:Set (start, count)
 		self[_start] = start
 		self[_count] = RangeOverlap(start, count, #self[_sequence])
+
+		-- Bound the interval with markers. Both stay put on inserts at their own positions, so
+		-- the interval grows on inserts at its start but not at its end.
+		if Core then
+			DetachAll(self)
+
+			if self[_count] > 0 then
+				local sequence = self[_sequence]
+
+				self[_start_marker] = Export.Attach(sequence, self, start, true)
+				self[_end_marker] = Export.Attach(sequence, self, start + self[_count], true)
+			end
+		end
 	end
 end,
 
@@ -96,5 +145,36 @@ function Export.IntervalRemove (I, index, count)
 	end
 end
 
+-- Detaches the interval from a marker dropped by a sequence remove
+-- I: Interval handle
+-- marker: Dropped marker
+function Export.IntervalLose (I, marker)
+	if I[_start_marker] == marker then
+		I[_start_marker] = false
+	elseif I[_end_marker] == marker then
+		I[_end_marker] = false
+	end
+end
+
+-- Puts an interval's bounds back after a sequence remove dropped their markers, as per
+-- IntervalRemove: bounds inside the range move to its start
+-- index: Index of first removed item
+function Export.IntervalSettle (I, index)
+	local sequence = I[_sequence]
+
+	if I[_start_marker] == false then
+		I[_start_marker] = Export.Attach(sequence, I, index, true)
+	end
+
+	if I[_end_marker] == false then
+		I[_end_marker] = Export.Attach(sequence, I, index, true)
+	end
+
+	-- Clear the interval if the range swallowed it.
+	if I[_start_marker] and #I == 0 then
+		I:Clear()
+	end
+end
+
 -- Export interval name.
 Export.IntervalName = u_IntervalName
\ No newline at end of file
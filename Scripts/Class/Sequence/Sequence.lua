@@ -2,17 +2,29 @@
 
 -- Standard library imports --
 local assert = assert
+local ipairs = ipairs
 local pairs = pairs
 
 -- Imports --
 local IntervalInsert = (...).IntervalInsert
+local IntervalLose = (...).IntervalLose
 local IntervalRemove = (...).IntervalRemove
+local IntervalSettle = (...).IntervalSettle
 local New = class.New
 local RangeOverlap = numericops.RangeOverlap
 local SpotInsert = (...).SpotInsert
+local SpotLose = (...).SpotLose
 local SpotRemove = (...).SpotRemove
+local SpotSettle = (...).SpotSettle
+local SpotWake = (...).SpotWake
 local Weak = table_ex.Weak
 
+-- Export table --
+local Export = ...
+
+-- Native sequence index, if registered --
+local Core = package.loaded.sequence_core
+
 -- Private class names --
 local IntervalName = (...).IntervalName
 local SpotName = (...).SpotName
@@ -20,9 +32,64 @@ local SpotName = (...).SpotName
 -- Unique member keys --
 local _insert = {}
 local _intervals = {}
+local _markers = {}
+local _owners = {}
+local _pending = {}
 local _remove = {}
 local _size = {}
 local _spots = {}
+local _sweep_at = {}
+
+-- Adds a marker to the sequence's index
+-- S: Sequence handle
+-- owner: Spot or interval owning the marker
+-- pos: Marker position
+-- strict: If true, the marker stays put on inserts at its own position
+-- Returns: Marker
+function Export.Attach (S, owner, pos, strict)
+	local markers = S[_markers]
+	local owners = S[_owners]
+
+	-- Markers of collected owners linger in the index; sweep them out whenever it has doubled.
+	if #markers >= S[_sweep_at] then
+		for _, marker in ipairs(markers:Ids()) do
+			if not owners[marker] then
+				markers:Remove(marker)
+			end
+		end
+
+		S[_sweep_at] = 2 * #markers + 16
+	end
+
+	local marker = markers:Add(pos, strict)
+
+	owners[marker] = owner
+
+	return marker
+end
+
+-- Removes a marker from the sequence's index
+-- S: Sequence handle
+-- marker: Marker to remove
+function Export.Detach (S, marker)
+	S[_markers]:Remove(marker)
+	S[_owners][marker] = nil
+end
+
+-- S: Sequence handle
+-- marker: Marker
+-- Returns: Marker position
+function Export.Position (S, marker)
+	return S[_markers]:Get(marker)
+end
+
+-- Marks a spot as waiting for an insert to make it valid
+-- S: Sequence handle
+-- spot: Spot handle
+-- is_pending: If true, the spot is pending
+function Export.SetPending (S, spot, is_pending)
+	S[_pending][spot] = is_pending or nil
+end
 
 -- Sequence class definition --
 class.Define("Sequence", function(Sequence)
@@ -59,16 +126,28 @@ class.Define("Sequence", function(Sequence)
 		assert(self:IsItemValid(index, true) and count > 0)
 
 		-- Update the intervals and spots to reflect the change.
-		for interval in pairs(self[_intervals]) do
-			IntervalInsert(interval, index, count)
-		end
+		if Core then
+			self[_markers]:Insert(index, count)
+
+		else
+			for interval in pairs(self[_intervals]) do
+				IntervalInsert(interval, index, count)
+			end
 
-		for spot in pairs(self[_spots]) do
-			SpotInsert(spot, index, count)
+			for spot in pairs(self[_spots]) do
+				SpotInsert(spot, index, count)
+			end
 		end
 
 		-- Perform the insertion.
 		self[_insert](index, count, ...)
+
+		-- Track any spots the insertion made valid.
+		if Core then
+			for spot in pairs(self[_pending]) do
+				SpotWake(spot)
+			end
+		end
 	end
 
 	-- index: Index of item in sequence
@@ -92,16 +171,54 @@ class.Define("Sequence", function(Sequence)
 	-- Returns: Count of items removed
 	-----------------------------------
 	function Sequence:Remove (index, count, ...)
-		count = RangeOverlap(index, count, self[_size]())
+		local size = self[_size]()
+
+		count = RangeOverlap(index, count, size)
 
 		-- Update the intervals and spots to reflect the change.
 		if count > 0 then
-			for interval in pairs(self[_intervals]) do
-				IntervalRemove(interval, index, count)
-			end
+			if Core then
+				-- Markers past the range shift back in the index. Those inside it are dropped:
+				-- detach their owners from them all first, since the index may reuse them, then
+				-- put the owners back.
+				local markers = self[_markers]:RemoveRange(index, count)
 
-			for spot in pairs(self[_spots]) do
-				SpotRemove(spot, index, count)
+				if markers then
+					local owners = self[_owners]
+					local spots = self[_spots]
+
+					for i, marker in ipairs(markers) do
+						local owner = owners[marker]
+
+						if owner then
+							if spots[owner] then
+								SpotLose(owner)
+							else
+								IntervalLose(owner, marker)
+							end
+						end
+
+						owners[marker] = nil
+						markers[i] = owner or false
+					end
+
+					for _, owner in ipairs(markers) do
+						if spots[owner] then
+							SpotSettle(owner, index, count, size)
+						elseif owner then
+							IntervalSettle(owner, index)
+						end
+					end
+				end
+
+			else
+				for interval in pairs(self[_intervals]) do
+					IntervalRemove(interval, index, count)
+				end
+
+				for spot in pairs(self[_spots]) do
+					SpotRemove(spot, index, count)
+				end
 			end
 
 			-- Perform the removal.
@@ -129,4 +246,12 @@ function(S, size, insert, remove)
 
 	-- Owned spots --
 	S[_spots] = Weak("k")
+
+	-- Index of spot and interval markers; owner of each marker; spots awaiting validity --
+	if Core then
+		S[_markers] = Core.New()
+		S[_owners] = Weak("v")
+		S[_pending] = Weak("k")
+		S[_sweep_at] = 16
+	end
 end)
\ No newline at end of file
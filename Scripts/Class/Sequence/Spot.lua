@@ -7,6 +7,10 @@ local max = math.max
 -- Export table --
 local Export = ...
 
+-- Native sequence index, if registered: spots are then tracked as markers in the owner's index,
+-- rather than being updated one by one on each change --
+local Core = package.loaded.sequence_core
+
 -- Unique spot class name --
 local u_SpotName = {}
 
@@ -14,6 +18,7 @@ local u_SpotName = {}
 local _can_migrate = {}
 local _index = {}
 local _is_add_spot = {}
+local _marker = {}
 local _sequence = {}
 
 -- S: Spot handle
@@ -22,17 +27,49 @@ local function IsValid (S)
 	return S[_sequence]:IsItemValid(S[_index], S[_is_add_spot])
 end
 
+-- Moves the spot, keeping its marker in step
+-- S: Spot handle
+-- index: Position index
+-- size: Sequence size to validate against; if absent, the current size
+local function Place (S, index, size)
+	local sequence = S[_sequence]
+
+	if S[_marker] then
+		Export.Detach(sequence, S[_marker])
+
+		S[_marker] = nil
+	end
+
+	S[_index] = index
+
+	-- Valid spots are tracked by the index. Invalid ones are left in place, as they would be
+	-- otherwise, but pend until an insert makes them valid.
+	if index > 0 and index <= (size or #sequence) + (S[_is_add_spot] and 1 or 0) then
+		S[_marker] = Export.Attach(sequence, S, index, false)
+	end
+
+	Export.SetPending(sequence, S, index > 0 and not S[_marker])
+end
+
 -- Spot class definition --
 class.Define(u_SpotName, function(Spot)
 	--- Invalidates the spot.
 	function Spot:Clear ()
-		self[_index] = 0
+		if Core then
+			Place(self, 0)
+		else
+			self[_index] = 0
+		end
 	end
 
 	--- Gets the position watched by the spot.
 	-- @return The current position index, or <b>nil</b> if the spot is invalid.
 	-- @see Spot:Set
 	function Spot:Get ()
+		if self[_marker] then
+			self[_index] = Export.Position(self[_sequence], self[_marker])
+		end
+
 		if IsValid(self) then
 			return self[_index]
 		end
@@ -44,7 +81,11 @@ class.Define(u_SpotName, function(Spot)
 	function Spot:Set (index)
 		assert(self[_sequence]:IsItemValid(index, self[_is_add_spot]), "Invalid index")
 
-		self[_index] = index
+		if Core then
+			Place(self, index)
+		else
+			self[_index] = index
+		end
 	end
 end,
 
@@ -66,6 +107,11 @@ function(S, sequence, is_add_spot, can_migrate)
 	-- Flags --
 	S[_is_add_spot] = not not is_add_spot
 	S[_can_migrate] = not not can_migrate
+
+	-- Index marker --
+	if Core then
+		Place(S, 1)
+	end
 end, { bHidden = true })
 
 -- Updates the spot in response to a sequence insert
@@ -114,5 +160,38 @@ function Export.SpotRemove (S, index, count)
 	end
 end
 
+-- Detaches the spot from a marker dropped by a sequence remove
+-- S: Spot handle
+function Export.SpotLose (S)
+	S[_marker] = nil
+end
+
+-- Puts a spot back after a sequence remove dropped its marker, as per SpotRemove
+-- index: Index of first removed item
+-- count: Count of removed items
+-- size: Sequence size before the remove
+function Export.SpotSettle (S, index, count, size)
+	if S[_can_migrate] then
+		-- Migrate past the range, backing up if the range was at the end and this is illegal.
+		if index + count == size + 1 and not S[_is_add_spot] then
+			index = max(index - 1, 1)
+		end
+
+		Place(S, index, size - count)
+
+	-- Clear non-migratory spots.
+	else
+		Place(S, 0)
+	end
+end
+
+-- Starts tracking a pending spot, once an insert has made it valid
+-- S: Spot handle
+function Export.SpotWake (S)
+	if IsValid(S) then
+		Place(S, S[_index])
+	end
+end
+
 -- Export spot name.
 Export.SpotName = u_SpotName
\ No newline at end of file
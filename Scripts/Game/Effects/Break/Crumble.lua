@@ -7,8 +7,8 @@ local unpack = unpack
 local AddParticleEffect = AddParticleEffect
 local LatticeUV = effect.LatticeUV
 local New = class.New
-local Rand = math_ex.Rand
-local RBy = math_ex.RBy
+local Rand = random.Rand
+local RBy = random.RBy
 local GetPlayer = objects.GetPlayer
 
 -- Cached effect state --
@@ -6,8 +6,8 @@ local pi = math.pi
 local AddParticleEffect = AddParticleEffect
 local LatticeUV = effect.LatticeUV
 local New = class.New
-local Rand = math_ex.Rand
-local RBy = math_ex.RBy
+local Rand = random.Rand
+local RBy = random.RBy
 local GetPlayer = objects.GetPlayer
 
 local ParticleNames = { Adrian = "scatter_adrian.xml", Ashley = "scatter_ashley.xml", Billy = "scatter_billy.xml", Bones = "scatter_bones.xml", Enrique = "scatter_enrique.xml", Hanna = "scatter_hannah.xml", JeanClaude = "scatter_jeanclaude.xml", SpaceMonkey = "scatter_spacemonkey.xml", White = "scatter_white.xml" }
@@ -19,6 +19,39 @@ local Separator = ...
 
 assert(type(Separator) == "string", "Invalid separator")
 
+-- Native compiler, if registered: scripts named up front are compiled on worker threads --
+local Core = package.loaded.compiler_core
+
+-- Gathers the names of the scripts an item is known to load, ahead of loading it
+-- names: Array of names
+---------------------------------------------------------------------------------
+local function Gather (item, prefix, ext, names)
+	local itype = type(item)
+
+	-- Strings name scripts outright.
+	if itype == "string" then
+		names[#names + 1] = prefix .. item .. "." .. ext
+
+	-- Tables name their boot and entries. What boot scripts and functions return is only
+	-- known once they run, and gets gathered when it comes back through Load.
+	elseif itype == "table" then
+		local name = item.name
+		local boot = item.boot
+
+		if type(name) == "string" and name ~= "" then
+			prefix = prefix .. name .. Separator
+		end
+
+		if type(boot) == "string" then
+			names[#names + 1] = prefix .. boot .. "." .. ext
+		end
+
+		for _, entry in ipairs(item) do
+			Gather(entry, prefix, ext, names)
+		end
+	end
+end
+
 -- Reinvokes the loader on a set of results
 --------------------------------------------
 local function LoadAgainOnItemResult (item, env, arg, ext, loader, prefix)
@@ -94,7 +127,19 @@ function Load (item, prefix, env, arg, ext, loader)
 	assert(ext == nil or type(ext) == "string", "Invalid extension")
 	assert(loader == nil or type(loader) == "function", "Invalid loader")
 
-	AuxLoad(item, prefix, env, arg, ext or "lua", loader or loadfile)
+	ext = ext or "lua"
+	loader = loader or loadfile
+
+	-- Have the scripts compiled ahead, if the loader supports it. They still run in order.
+	if Core then
+		local names = {}
+
+		Gather(item, prefix, ext, names)
+
+		Core.Prefetch(loader, names)
+	end
+
+	AuxLoad(item, prefix, env, arg, ext, loader)
 end
 
 -- Export the loader.
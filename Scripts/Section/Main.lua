@@ -267,8 +267,9 @@ section.Load("Main", function(state, data, ...)
 		CurrentMenu = 1
 		KeyLogic = ui.KeyLogic(.5)
 
-		-- Seed the Tausworthe generator.
+		-- Seed the generators.
 		math.randomseed(os.time())
+		random.Seed(os.time())
 
 	-- Open --
 	elseif state == "open" then
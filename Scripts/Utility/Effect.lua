@@ -3,7 +3,7 @@ local yield = coroutine.yield
 
 -- Imports --
 local Create = coroutine_ex.Create
-local RBy = math_ex.RBy
+local RBy = random.RBy
 
 -- Export the effect namespace.
 module "effect"
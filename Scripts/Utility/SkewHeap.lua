@@ -4,6 +4,10 @@
 
 -- Standard library imports --
 local assert = assert
+local type = type
+
+-- Imports --
+local IsType = class.IsType
 
 -- Heap keys --
 local _L = {}
@@ -34,10 +38,28 @@ local function SkewMerge (a, b, r, order)
 	r[_R] = b or a
 end
 
+-- Native heaps (q.v. the Heap class) are keyed by number rather than ordered by a function.
+-- With these, the order argument is instead a key function, or the key itself.
+-- H: Heap
+-- v: Value being inserted
+-- key: Key or key function; if nil, uses function in heap
+-- Returns: Key
+local function GetKey (H, v, key)
+	if type(key) == "number" then
+		return key
+	end
+
+	return (key or H.key)(v)
+end
+
 -- Empties the heap
 --------------------
 function Clear (H)
-	H[_R] = nil
+	if IsType(H, "Heap") then
+		H:Clear()
+	else
+		H[_R] = nil
+	end
 end
 
 -- Adds a value to the heap
@@ -45,12 +67,20 @@ end
 -- order: Heap order function; if nil, uses function in heap
 -------------------------------------------------------------
 function Insert (H, v, order)
-	SkewMerge(H[_R], v, H, order or H.order)
+	if IsType(H, "Heap") then
+		H:Push(GetKey(H, v, order), v)
+	else
+		SkewMerge(H[_R], v, H, order or H.order)
+	end
 end
 
 -- Returns: If true, heap is empty
 -----------------------------------
 function IsEmpty (H)
+	if IsType(H, "Heap") then
+		return #H == 0
+	end
+
 	return H[_R] == nil
 end
 
@@ -59,6 +89,12 @@ end
 -- Returns: Removed value
 -------------------------------------------------------------
 function Remove (H, order)
+	if IsType(H, "Heap") then
+		assert(#H > 0, "Remove called on empty queue")
+
+		return (H:Pop())
+	end
+
 	local r = H[_R]
 
 	assert(r ~= nil, "Remove called on empty queue")
@@ -74,5 +110,9 @@ end
 -- Returns: Root value, or nil
 -------------------------------
 function Root (H)
+	if IsType(H, "Heap") then
+		return (H:Peek())
+	end
+
 	return H[_R]
 end
\ No newline at end of file